@@ -0,0 +1,165 @@
+# -*- coding: utf-8 -*-
+# Generated by the protocol buffer compiler.  DO NOT EDIT!
+# source: rpc.proto
+"""Generated protocol buffer code."""
+from google.protobuf.internal import builder as _builder
+from google.protobuf import descriptor as _descriptor
+from google.protobuf import descriptor_pool as _descriptor_pool
+from google.protobuf import symbol_database as _symbol_database
+# @@protoc_insertion_point(imports)
+
+_sym_db = _symbol_database.Default()
+
+
+
+
+DESCRIPTOR = _descriptor_pool.Default().AddSerializedFile(b'\n\trpc.proto\x12\x03rpc\"\xe7\x11\n\x11TContainerRequest\x12,\n\x06\x63reate\x18\x01 \x01(\x0b\x32\x1c.rpc.TContainerCreateRequest\x12.\n\x07\x64\x65stroy\x18\x02 \x01(\x0b\x32\x1d.rpc.TContainerDestroyRequest\x12(\n\x04list\x18\x03 \x01(\x0b\x32\x1a.rpc.TContainerListRequest\x12\x36\n\x0bgetProperty\x18\x04 \x01(\x0b\x32!.rpc.TContainerGetPropertyRequest\x12\x36\n\x0bsetProperty\x18\x05 \x01(\x0b\x32!.rpc.TContainerSetPropertyRequest\x12.\n\x07getData\x18\x06 \x01(\x0b\x32\x1d.rpc.TContainerGetDataRequest\x12*\n\x05start\x18\x07 \x01(\x0b\x32\x1b.rpc.TContainerStartRequest\x12(\n\x04stop\x18\x08 \x01(\x0b\x32\x1a.rpc.TContainerStopRequest\x12*\n\x05pause\x18\t \x01(\x0b\x32\x1b.rpc.TContainerPauseRequest\x12,\n\x06resume\x18\n \x01(\x0b\x32\x1c.rpc.TContainerResumeRequest\x12\x38\n\x0cpropertyList\x18\x0b \x01(\x0b\x32\".rpc.TContainerPropertyListRequest\x12\x30\n\x08\x64\x61taList\x18\x0c \x01(\x0b\x32\x1e.rpc.TContainerDataListRequest\x12(\n\x04kill\x18\r \x01(\x0b\x32\x1a.rpc.TContainerKillRequest\x12%\n\x07version\x18\x0e \x01(\x0b\x32\x14.rpc.TVersionRequest\x12&\n\x03get\x18\x0f \x01(\x0b\x32\x19.rpc.TContainerGetRequest\x12(\n\x04wait\x18\x10 \x01(\x0b\x32\x1a.rpc.TContainerWaitRequest\x12\x30\n\ncreateWeak\x18\x11 \x01(\x0b\x32\x1c.rpc.TContainerCreateRequest\x12.\n\x07Respawn\x18\x12 \x01(\x0b\x32\x1d.rpc.TContainerRespawnRequest\x12-\n\tAsyncWait\x18\x13 \x01(\x0b\x32\x1a.rpc.TContainerWaitRequest\x12=\n\x14listVolumeProperties\x18g \x01(\x0b\x32\x1f.rpc.TVolumePropertyListRequest\x12/\n\x0c\x63reateVolume\x18h \x01(\x0b\x32\x19.rpc.TVolumeCreateRequest\x12+\n\nlinkVolume\x18i \x01(\x0b\x32\x17.rpc.TVolumeLinkRequest\x12\x31\n\x10LinkVolumeTarget\x18x \x01(\x0b\x32\x17.rpc.TVolumeLinkRequest\x12/\n\x0cunlinkVolume\x18j \x01(\x0b\x32\x19.rpc.TVolumeUnlinkRequest\x12\x35\n\x12UnlinkVolumeTarget\x18y \x01(\x0b\x32\x19.rpc.TVolumeUnlinkRequest\x12,\n\x0blistVolumes\x18k \x01(\x0b\x32\x17.rpc.TVolumeListRequest\x12+\n\ntuneVolume\x18l \x01(\x0b\x32\x17.rpc.TVolumeTuneRequest\x12-\n\x0bimportLayer\x18n \x01(\x0b\x32\x18.rpc.TLayerImportRequest\x12-\n\x0bremoveLayer\x18o \x01(\x0b\x32\x18.rpc.TLayerRemoveRequest\x12*\n\nlistLayers\x18p \x01(\x0b\x32\x16.rpc.TLayerListRequest\x12-\n\x0b\x65xportLayer\x18q \x01(\x0b\x32\x18.rpc.TLayerExportRequest\x12\x35\n\x0fgetlayerprivate\x18r \x01(\x0b\x32\x1c.rpc.TLayerGetPrivateRequest\x12\x35\n\x0fsetlayerprivate\x18s \x01(\x0b\x32\x1c.rpc.TLayerSetPrivateRequest\x12-\n\x0blistStorage\x18t \x01(\x0b\x32\x18.rpc.TStorageListRequest\x12\x31\n\rremoveStorage\x18u \x01(\x0b\x32\x1a.rpc.TStorageRemoveRequest\x12\x31\n\rimportStorage\x18v \x01(\x0b\x32\x1a.rpc.TStorageImportRequest\x12\x31\n\rexportStorage\x18w \x01(\x0b\x32\x1a.rpc.TStorageExportRequest\x12,\n\x11\x43reateMetaStorage\x18z \x01(\x0b\x32\x11.rpc.TMetaStorage\x12,\n\x11ResizeMetaStorage\x18{ \x01(\x0b\x32\x11.rpc.TMetaStorage\x12,\n\x11RemoveMetaStorage\x18| \x01(\x0b\x32\x11.rpc.TMetaStorage\x12+\n\nSetSymlink\x18} \x01(\x0b\x32\x17.rpc.TSetSymlinkRequest\x12.\n\x0b\x63onvertPath\x18\xc8\x01 \x01(\x0b\x32\x18.rpc.TConvertPathRequest\x12\x32\n\rattachProcess\x18\xc9\x01 \x01(\x0b\x32\x1a.rpc.TAttachProcessRequest\x12\x32\n\rlocateProcess\x18\xca\x01 \x01(\x0b\x32\x1a.rpc.TLocateProcessRequest\x12\x31\n\x0c\x41ttachThread\x18\xcb\x01 \x01(\x0b\x32\x1a.rpc.TAttachProcessRequest\x12*\n\tGetSystem\x18\xac\x02 \x01(\x0b\x32\x16.rpc.TGetSystemRequest\x12*\n\tSetSystem\x18\xad\x02 \x01(\x0b\x32\x16.rpc.TSetSystemRequest\"\xde\x07\n\x12TContainerResponse\x12%\n\x05\x65rror\x18\x01 \x01(\x0e\x32\x0b.rpc.EError:\tLostError\x12\x10\n\x08\x65rrorMsg\x18\x02 \x01(\t\x12)\n\x04list\x18\x03 \x01(\x0b\x32\x1b.rpc.TContainerListResponse\x12\x37\n\x0bgetProperty\x18\x04 \x01(\x0b\x32\".rpc.TContainerGetPropertyResponse\x12/\n\x07getData\x18\x05 \x01(\x0b\x32\x1e.rpc.TContainerGetDataResponse\x12\x39\n\x0cpropertyList\x18\x06 \x01(\x0b\x32#.rpc.TContainerPropertyListResponse\x12\x31\n\x08\x64\x61taList\x18\x07 \x01(\x0b\x32\x1f.rpc.TContainerDataListResponse\x12&\n\x07version\x18\x08 \x01(\x0b\x32\x15.rpc.TVersionResponse\x12,\n\nvolumeList\x18\t \x01(\x0b\x32\x18.rpc.TVolumeListResponse\x12\'\n\x03get\x18\n \x01(\x0b\x32\x1a.rpc.TContainerGetResponse\x12)\n\x04wait\x18\x0b \x01(\x0b\x32\x1b.rpc.TContainerWaitResponse\x12<\n\x12volumePropertyList\x18\x0c \x01(\x0b\x32 .rpc.TVolumePropertyListResponse\x12\'\n\x06volume\x18\r \x01(\x0b\x32\x17.rpc.TVolumeDescription\x12\'\n\x06layers\x18\x0e \x01(\x0b\x32\x17.rpc.TLayerListResponse\x12.\n\x0b\x63onvertPath\x18\x0f \x01(\x0b\x32\x19.rpc.TConvertPathResponse\x12\x34\n\rlayer_private\x18\x10 \x01(\x0b\x32\x1d.rpc.TLayerGetPrivateResponse\x12.\n\x0bstorageList\x18\x11 \x01(\x0b\x32\x19.rpc.TStorageListResponse\x12\x32\n\rlocateProcess\x18\x12 \x01(\x0b\x32\x1b.rpc.TLocateProcessResponse\x12.\n\tAsyncWait\x18\x13 \x01(\x0b\x32\x1b.rpc.TContainerWaitResponse\x12+\n\tGetSystem\x18\xac\x02 \x01(\x0b\x32\x17.rpc.TGetSystemResponse\x12+\n\tSetSystem\x18\xad\x02 \x01(\x0b\x32\x17.rpc.TSetSystemResponse\"\x13\n\x11TGetSystemRequest\"\x9a\x0b\n\x12TGetSystemResponse\x12\x15\n\rporto_version\x18\x01 \x02(\t\x12\x16\n\x0eporto_revision\x18\x02 \x02(\t\x12\x16\n\x0ekernel_version\x18\x03 \x02(\t\x12\x0e\n\x06\x65rrors\x18\x04 \x02(\x06\x12\x10\n\x08warnings\x18\x05 \x02(\x06\x12\x14\n\x0cporto_starts\x18\x06 \x02(\x06\x12\x14\n\x0cporto_uptime\x18\x07 \x02(\x06\x12\x15\n\rmaster_uptime\x18\x08 \x02(\x06\x12\x0e\n\x06taints\x18\t \x01(\x06\x12\x0f\n\x07verbose\x18\x64 \x02(\x08\x12\r\n\x05\x64\x65\x62ug\x18\x65 \x02(\x08\x12\x11\n\tlog_lines\x18\x66 \x02(\x06\x12\x11\n\tlog_bytes\x18g \x02(\x06\x12\x1b\n\x13stream_rotate_bytes\x18h \x02(\x06\x12\x1c\n\x14stream_rotate_errors\x18i \x02(\x06\x12\x16\n\x0elog_lines_lost\x18j \x02(\x06\x12\x16\n\x0elog_bytes_lost\x18k \x02(\x06\x12\x19\n\x11log_lines_dropped\x18l \x01(\x06\x12\x18\n\x0f\x63ontainer_count\x18\xc8\x01 \x02(\x06\x12\x18\n\x0f\x63ontainer_limit\x18\xc9\x01 \x02(\x06\x12\x1a\n\x11\x63ontainer_running\x18\xca\x01 \x02(\x06\x12\x1a\n\x11\x63ontainer_created\x18\xcb\x01 \x02(\x06\x12\x1a\n\x11\x63ontainer_started\x18\xcc\x01 \x02(\x06\x12\x1f\n\x16\x63ontainer_start_failed\x18\xcd\x01 \x02(\x06\x12\x16\n\rcontainer_oom\x18\xce\x01 \x02(\x06\x12\x19\n\x10\x63ontainer_buried\x18\xcf\x01 \x02(\x06\x12\x17\n\x0e\x63ontainer_lost\x18\xd0\x01 \x02(\x06\x12\x1a\n\x11\x63ontainer_tainted\x18\xd1\x01 \x01(\x06\x12\x15\n\x0cvolume_count\x18\xac\x02 \x02(\x06\x12\x15\n\x0cvolume_limit\x18\xad\x02 \x02(\x06\x12\x17\n\x0evolume_created\x18\xaf\x02 \x02(\x06\x12\x16\n\rvolume_failed\x18\xb0\x02 \x02(\x06\x12\x15\n\x0cvolume_links\x18\xb1\x02 \x02(\x06\x12\x1d\n\x14volume_links_mounted\x18\xb2\x02 \x02(\x06\x12\x14\n\x0bvolume_lost\x18\xb3\x02 \x02(\x06\x12\x15\n\x0cvolume_trash\x18\xb4\x02 \x01(\x06\x12\x1f\n\x16volume_trash_reclaimed\x18\xb5\x02 \x01(\x06\x12\x1d\n\x14volume_trash_entries\x18\xb6\x02 \x01(\x06\x12\x1a\n\x11volume_trash_rate\x18\xb7\x02 \x01(\x06\x12\x15\n\x0clayer_import\x18\x86\x03 \x02(\x06\x12\x15\n\x0clayer_export\x18\x87\x03 \x02(\x06\x12\x15\n\x0clayer_remove\x18\x88\x03 \x02(\x06\x12\x15\n\x0c\x63lient_count\x18\x90\x03 \x02(\x06\x12\x13\n\nclient_max\x18\x91\x03 \x02(\x06\x12\x19\n\x10\x63lient_connected\x18\x92\x03 \x02(\x06\x12\x17\n\x0erequest_queued\x18\xf4\x03 \x02(\x06\x12\x1a\n\x11request_completed\x18\xf5\x03 \x02(\x06\x12\x17\n\x0erequest_failed\x18\xf6\x03 \x02(\x06\x12\x18\n\x0frequest_threads\x18\xf7\x03 \x02(\x06\x12\x1a\n\x11request_longer_1s\x18\xf8\x03 \x02(\x06\x12\x1a\n\x11request_longer_3s\x18\xf9\x03 \x02(\x06\x12\x1b\n\x12request_longer_30s\x18\xfa\x03 \x02(\x06\x12\x1a\n\x11request_longer_5m\x18\xfb\x03 \x02(\x06\x12\x14\n\x0b\x66\x61il_system\x18\xd8\x04 \x02(\x06\x12\x1b\n\x12\x66\x61il_invalid_value\x18\xd9\x04 \x02(\x06\x12\x1d\n\x14\x66\x61il_invalid_command\x18\xda\x04 \x02(\x06\x12\x16\n\rnetwork_count\x18\xbc\x05 \x01(\x06\"3\n\x11TSetSystemRequest\x12\x0f\n\x07verbose\x18\x64 \x01(\x08\x12\r\n\x05\x64\x65\x62ug\x18\x65 \x01(\x08\"\x14\n\x12TSetSystemResponse\"\'\n\x17TContainerCreateRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\"(\n\x18TContainerDestroyRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\"%\n\x15TContainerListRequest\x12\x0c\n\x04mask\x18\x01 \x01(\t\"Z\n\x1cTContainerGetPropertyRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x10\n\x08property\x18\x02 \x02(\t\x12\x0c\n\x04sync\x18\x03 \x01(\x08\x12\x0c\n\x04real\x18\x04 \x01(\x08\"M\n\x1cTContainerSetPropertyRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x10\n\x08property\x18\x02 \x02(\t\x12\r\n\x05value\x18\x03 \x02(\t\"R\n\x18TContainerGetDataRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x0c\n\x04\x64\x61ta\x18\x02 \x02(\t\x12\x0c\n\x04sync\x18\x03 \x01(\x08\x12\x0c\n\x04real\x18\x04 \x01(\x08\"&\n\x16TContainerStartRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\"(\n\x18TContainerRespawnRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\"9\n\x15TContainerStopRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x12\n\ntimeout_ms\x18\x02 \x01(\r\"&\n\x16TContainerPauseRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\"\'\n\x17TContainerResumeRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\"\x1f\n\x1dTContainerPropertyListRequest\"\x1b\n\x19TContainerDataListRequest\"2\n\x15TContainerKillRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x0b\n\x03sig\x18\x02 \x02(\x05\"\x11\n\x0fTVersionRequest\"H\n\x13TConvertPathRequest\x12\x0c\n\x04path\x18\x01 \x02(\t\x12\x0e\n\x06source\x18\x02 \x02(\t\x12\x13\n\x0b\x64\x65stination\x18\x03 \x02(\t\"d\n\x14TContainerGetRequest\x12\x0c\n\x04name\x18\x01 \x03(\t\x12\x10\n\x08variable\x18\x02 \x03(\t\x12\x10\n\x08nonblock\x18\x03 \x01(\x08\x12\x0c\n\x04sync\x18\x04 \x01(\x08\x12\x0c\n\x04real\x18\x05 \x01(\x08\"9\n\x15TContainerWaitRequest\x12\x0c\n\x04name\x18\x01 \x03(\t\x12\x12\n\ntimeout_ms\x18\x02 \x01(\r\"@\n\x15TAttachProcessRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x0b\n\x03pid\x18\x02 \x02(\r\x12\x0c\n\x04\x63omm\x18\x03 \x02(\t\"2\n\x15TLocateProcessRequest\x12\x0b\n\x03pid\x18\x01 \x02(\r\x12\x0c\n\x04\x63omm\x18\x02 \x02(\t\"&\n\x16TContainerListResponse\x12\x0c\n\x04name\x18\x01 \x03(\t\".\n\x1dTContainerGetPropertyResponse\x12\r\n\x05value\x18\x01 \x02(\t\"*\n\x19TContainerGetDataResponse\x12\r\n\x05value\x18\x01 \x02(\t\"\xce\x01\n\x1eTContainerPropertyListResponse\x12M\n\x04list\x18\x01 \x03(\x0b\x32?.rpc.TContainerPropertyListResponse.TContainerPropertyListEntry\x1a]\n\x1bTContainerPropertyListEntry\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x0c\n\x04\x64\x65sc\x18\x02 \x02(\t\x12\x11\n\tread_only\x18\x03 \x01(\x08\x12\x0f\n\x07\x64ynamic\x18\x04 \x01(\x08\"\x9a\x01\n\x1aTContainerDataListResponse\x12\x45\n\x04list\x18\x01 \x03(\x0b\x32\x37.rpc.TContainerDataListResponse.TContainerDataListEntry\x1a\x35\n\x17TContainerDataListEntry\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x0c\n\x04\x64\x65sc\x18\x02 \x02(\t\"1\n\x10TVersionResponse\x12\x0b\n\x03tag\x18\x01 \x02(\t\x12\x10\n\x08revision\x18\x02 \x02(\t\"\xba\x02\n\x15TContainerGetResponse\x12\x42\n\x04list\x18\x01 \x03(\x0b\x32\x34.rpc.TContainerGetResponse.TContainerGetListResponse\x1ak\n\x1aTContainerGetValueResponse\x12\x10\n\x08variable\x18\x01 \x02(\t\x12\x1a\n\x05\x65rror\x18\x02 \x01(\x0e\x32\x0b.rpc.EError\x12\x10\n\x08\x65rrorMsg\x18\x03 \x01(\t\x12\r\n\x05value\x18\x04 \x01(\t\x1ap\n\x19TContainerGetListResponse\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x45\n\x06keyval\x18\x02 \x03(\x0b\x32\x35.rpc.TContainerGetResponse.TContainerGetValueResponse\"C\n\x16TContainerWaitResponse\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\r\n\x05state\x18\x02 \x01(\t\x12\x0c\n\x04when\x18\x03 \x01(\x04\"$\n\x14TConvertPathResponse\x12\x0c\n\x04path\x18\x01 \x02(\t\"&\n\x16TLocateProcessResponse\x12\x0c\n\x04name\x18\x01 \x02(\t\".\n\x0fTVolumeProperty\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\r\n\x05value\x18\x02 \x02(\t\"8\n\x1aTVolumePropertyDescription\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x0c\n\x04\x64\x65sc\x18\x02 \x02(\t\"U\n\x0bTVolumeLink\x12\x11\n\tcontainer\x18\x01 \x02(\t\x12\x0e\n\x06target\x18\x02 \x01(\t\x12\x10\n\x08required\x18\x03 \x01(\x08\x12\x11\n\tread_only\x18\x04 \x01(\x08\"\x81\x01\n\x12TVolumeDescription\x12\x0c\n\x04path\x18\x01 \x02(\t\x12(\n\nproperties\x18\x02 \x03(\x0b\x32\x14.rpc.TVolumeProperty\x12\x12\n\ncontainers\x18\x03 \x03(\t\x12\x1f\n\x05links\x18\x04 \x03(\x0b\x32\x10.rpc.TVolumeLink\"\x1c\n\x1aTVolumePropertyListRequest\"R\n\x1bTVolumePropertyListResponse\x12\x33\n\nproperties\x18\x01 \x03(\x0b\x32\x1f.rpc.TVolumePropertyDescription\"N\n\x14TVolumeCreateRequest\x12\x0c\n\x04path\x18\x01 \x01(\t\x12(\n\nproperties\x18\x02 \x03(\x0b\x32\x14.rpc.TVolumeProperty\"j\n\x12TVolumeLinkRequest\x12\x0c\n\x04path\x18\x01 \x02(\t\x12\x11\n\tcontainer\x18\x02 \x01(\t\x12\x0e\n\x06target\x18\x03 \x01(\t\x12\x10\n\x08required\x18\x04 \x01(\x08\x12\x11\n\tread_only\x18\x05 \x01(\x08\"W\n\x14TVolumeUnlinkRequest\x12\x0c\n\x04path\x18\x01 \x02(\t\x12\x11\n\tcontainer\x18\x02 \x01(\t\x12\x0e\n\x06strict\x18\x03 \x01(\x08\x12\x0e\n\x06target\x18\x04 \x01(\t\"5\n\x12TVolumeListRequest\x12\x0c\n\x04path\x18\x01 \x01(\t\x12\x11\n\tcontainer\x18\x02 \x01(\t\"L\n\x12TVolumeTuneRequest\x12\x0c\n\x04path\x18\x01 \x02(\t\x12(\n\nproperties\x18\x02 \x03(\x0b\x32\x14.rpc.TVolumeProperty\"?\n\x13TVolumeListResponse\x12(\n\x07volumes\x18\x01 \x03(\x0b\x32\x17.rpc.TVolumeDescription\"|\n\x13TLayerImportRequest\x12\r\n\x05layer\x18\x01 \x02(\t\x12\x0f\n\x07tarball\x18\x02 \x02(\t\x12\r\n\x05merge\x18\x03 \x02(\x08\x12\r\n\x05place\x18\x04 \x01(\t\x12\x15\n\rprivate_value\x18\x05 \x01(\t\x12\x10\n\x08\x63ompress\x18\x06 \x01(\t\"f\n\x13TLayerExportRequest\x12\x0e\n\x06volume\x18\x01 \x02(\t\x12\x0f\n\x07tarball\x18\x02 \x02(\t\x12\r\n\x05layer\x18\x03 \x01(\t\x12\r\n\x05place\x18\x04 \x01(\t\x12\x10\n\x08\x63ompress\x18\x05 \x01(\t\"3\n\x13TLayerRemoveRequest\x12\r\n\x05layer\x18\x01 \x02(\t\x12\r\n\x05place\x18\x02 \x01(\t\"0\n\x11TLayerListRequest\x12\r\n\x05place\x18\x01 \x01(\t\x12\x0c\n\x04mask\x18\x02 \x01(\t\"7\n\x17TLayerGetPrivateRequest\x12\r\n\x05layer\x18\x01 \x02(\t\x12\r\n\x05place\x18\x02 \x01(\t\"N\n\x17TLayerSetPrivateRequest\x12\r\n\x05layer\x18\x01 \x02(\t\x12\r\n\x05place\x18\x02 \x01(\t\x12\x15\n\rprivate_value\x18\x03 \x02(\t\"u\n\x11TLayerDescription\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x12\n\nowner_user\x18\x02 \x02(\t\x12\x13\n\x0bowner_group\x18\x03 \x02(\t\x12\x12\n\nlast_usage\x18\x04 \x02(\x04\x12\x15\n\rprivate_value\x18\x05 \x02(\t\"K\n\x12TLayerListResponse\x12\r\n\x05layer\x18\x01 \x03(\t\x12&\n\x06layers\x18\x02 \x03(\x0b\x32\x16.rpc.TLayerDescription\"1\n\x18TLayerGetPrivateResponse\x12\x15\n\rprivate_value\x18\x01 \x01(\t\"w\n\x13TStorageDescription\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x12\n\nowner_user\x18\x02 \x02(\t\x12\x13\n\x0bowner_group\x18\x03 \x02(\t\x12\x12\n\nlast_usage\x18\x04 \x02(\x04\x12\x15\n\rprivate_value\x18\x05 \x02(\t\"2\n\x13TStorageListRequest\x12\r\n\x05place\x18\x01 \x01(\t\x12\x0c\n\x04mask\x18\x02 \x01(\t\"\x83\x01\n\x14TStorageListResponse\x12*\n\x08storages\x18\x01 \x03(\x0b\x32\x18.rpc.TStorageDescription\x12(\n\rmeta_storages\x18\x02 \x03(\x0b\x32\x11.rpc.TMetaStorage\x12\x15\n\rtrash_backlog\x18\x03 \x01(\x04\"4\n\x15TStorageRemoveRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\r\n\x05place\x18\x02 \x01(\t\"n\n\x15TStorageImportRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x0f\n\x07tarball\x18\x02 \x02(\t\x12\r\n\x05place\x18\x03 \x01(\t\x12\x15\n\rprivate_value\x18\x05 \x01(\t\x12\x10\n\x08\x63ompress\x18\x06 \x01(\t\"W\n\x15TStorageExportRequest\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\x0f\n\x07tarball\x18\x02 \x02(\t\x12\r\n\x05place\x18\x03 \x01(\t\x12\x10\n\x08\x63ompress\x18\x04 \x01(\t\"\x83\x02\n\x0cTMetaStorage\x12\x0c\n\x04name\x18\x01 \x02(\t\x12\r\n\x05place\x18\x02 \x01(\t\x12\x15\n\rprivate_value\x18\x03 \x01(\t\x12\x13\n\x0bspace_limit\x18\x04 \x01(\x04\x12\x13\n\x0binode_limit\x18\x05 \x01(\x04\x12\x12\n\nspace_used\x18\x06 \x01(\x04\x12\x17\n\x0fspace_available\x18\x07 \x01(\x04\x12\x12\n\ninode_used\x18\x08 \x01(\x04\x12\x17\n\x0finode_available\x18\t \x01(\x04\x12\x12\n\nowner_user\x18\n \x01(\t\x12\x13\n\x0bowner_group\x18\x0b \x01(\t\x12\x12\n\nlast_usage\x18\x0c \x01(\x04\"H\n\x12TSetSymlinkRequest\x12\x11\n\tcontainer\x18\x01 \x02(\t\x12\x0f\n\x07symlink\x18\x02 \x02(\t\x12\x0e\n\x06target\x18\x03 \x01(\t\"\xea\x01\n\x0eTRequestRecord\x12\'\n\x07request\x18\x01 \x02(\x0b\x32\x16.rpc.TContainerRequest\x12\x0e\n\x06\x63lient\x18\x02 \x01(\t\x12\x0b\n\x03pid\x18\x03 \x01(\r\x12\x0b\n\x03uid\x18\x04 \x01(\r\x12\x0b\n\x03gid\x18\x05 \x01(\r\x12\x0c\n\x04\x63omm\x18\x06 \x01(\t\x12\x11\n\tcontainer\x18\x07 \x01(\t\x12\x12\n\nqueue_time\x18\x08 \x01(\x04\x12\x12\n\nstart_time\x18\t \x01(\x04\x12\x13\n\x0b\x66inish_time\x18\n \x01(\x04\x12\x1a\n\x05\x65rror\x18\x0b \x01(\x0e\x32\x0b.rpc.EError*\x85\x04\n\x06\x45\x45rror\x12\x0b\n\x07Success\x10\x00\x12\x0b\n\x07Unknown\x10\x01\x12\x11\n\rInvalidMethod\x10\x02\x12\x1a\n\x16\x43ontainerAlreadyExists\x10\x03\x12\x19\n\x15\x43ontainerDoesNotExist\x10\x04\x12\x13\n\x0fInvalidProperty\x10\x05\x12\x0f\n\x0bInvalidData\x10\x06\x12\x10\n\x0cInvalidValue\x10\x07\x12\x10\n\x0cInvalidState\x10\x08\x12\x10\n\x0cNotSupported\x10\t\x12\x18\n\x14ResourceNotAvailable\x10\n\x12\x0e\n\nPermission\x10\x0b\x12\x17\n\x13VolumeAlreadyExists\x10\x0c\x12\x12\n\x0eVolumeNotFound\x10\r\x12\x0b\n\x07NoSpace\x10\x0e\x12\x08\n\x04\x42usy\x10\x0f\x12\x17\n\x13VolumeAlreadyLinked\x10\x10\x12\x13\n\x0fVolumeNotLinked\x10\x11\x12\x16\n\x12LayerAlreadyExists\x10\x12\x12\x11\n\rLayerNotFound\x10\x13\x12\x0b\n\x07NoValue\x10\x14\x12\x12\n\x0eVolumeNotReady\x10\x15\x12\x12\n\x0eInvalidCommand\x10\x16\x12\r\n\tLostError\x10\x17\x12\x12\n\x0e\x44\x65viceNotFound\x10\x18\x12\x0f\n\x0bInvalidPath\x10\x19\x12\x0b\n\x06Queued\x10\xe8\x07')
+
+_builder.BuildMessageAndEnumDescriptors(DESCRIPTOR, globals())
+_builder.BuildTopDescriptorsAndMessages(DESCRIPTOR, 'rpc_pb2', globals())
+if _descriptor._USE_C_DESCRIPTORS == False:
+
+  DESCRIPTOR._options = None
+  _EERROR._serialized_start=9691
+  _EERROR._serialized_end=10208
+  _TCONTAINERREQUEST._serialized_start=19
+  _TCONTAINERREQUEST._serialized_end=2298
+  _TCONTAINERRESPONSE._serialized_start=2301
+  _TCONTAINERRESPONSE._serialized_end=3291
+  _TGETSYSTEMREQUEST._serialized_start=3293
+  _TGETSYSTEMREQUEST._serialized_end=3312
+  _TGETSYSTEMRESPONSE._serialized_start=3315
+  _TGETSYSTEMRESPONSE._serialized_end=4749
+  _TSETSYSTEMREQUEST._serialized_start=4751
+  _TSETSYSTEMREQUEST._serialized_end=4802
+  _TSETSYSTEMRESPONSE._serialized_start=4804
+  _TSETSYSTEMRESPONSE._serialized_end=4824
+  _TCONTAINERCREATEREQUEST._serialized_start=4826
+  _TCONTAINERCREATEREQUEST._serialized_end=4865
+  _TCONTAINERDESTROYREQUEST._serialized_start=4867
+  _TCONTAINERDESTROYREQUEST._serialized_end=4907
+  _TCONTAINERLISTREQUEST._serialized_start=4909
+  _TCONTAINERLISTREQUEST._serialized_end=4946
+  _TCONTAINERGETPROPERTYREQUEST._serialized_start=4948
+  _TCONTAINERGETPROPERTYREQUEST._serialized_end=5038
+  _TCONTAINERSETPROPERTYREQUEST._serialized_start=5040
+  _TCONTAINERSETPROPERTYREQUEST._serialized_end=5117
+  _TCONTAINERGETDATAREQUEST._serialized_start=5119
+  _TCONTAINERGETDATAREQUEST._serialized_end=5201
+  _TCONTAINERSTARTREQUEST._serialized_start=5203
+  _TCONTAINERSTARTREQUEST._serialized_end=5241
+  _TCONTAINERRESPAWNREQUEST._serialized_start=5243
+  _TCONTAINERRESPAWNREQUEST._serialized_end=5283
+  _TCONTAINERSTOPREQUEST._serialized_start=5285
+  _TCONTAINERSTOPREQUEST._serialized_end=5342
+  _TCONTAINERPAUSEREQUEST._serialized_start=5344
+  _TCONTAINERPAUSEREQUEST._serialized_end=5382
+  _TCONTAINERRESUMEREQUEST._serialized_start=5384
+  _TCONTAINERRESUMEREQUEST._serialized_end=5423
+  _TCONTAINERPROPERTYLISTREQUEST._serialized_start=5425
+  _TCONTAINERPROPERTYLISTREQUEST._serialized_end=5456
+  _TCONTAINERDATALISTREQUEST._serialized_start=5458
+  _TCONTAINERDATALISTREQUEST._serialized_end=5485
+  _TCONTAINERKILLREQUEST._serialized_start=5487
+  _TCONTAINERKILLREQUEST._serialized_end=5537
+  _TVERSIONREQUEST._serialized_start=5539
+  _TVERSIONREQUEST._serialized_end=5556
+  _TCONVERTPATHREQUEST._serialized_start=5558
+  _TCONVERTPATHREQUEST._serialized_end=5630
+  _TCONTAINERGETREQUEST._serialized_start=5632
+  _TCONTAINERGETREQUEST._serialized_end=5732
+  _TCONTAINERWAITREQUEST._serialized_start=5734
+  _TCONTAINERWAITREQUEST._serialized_end=5791
+  _TATTACHPROCESSREQUEST._serialized_start=5793
+  _TATTACHPROCESSREQUEST._serialized_end=5857
+  _TLOCATEPROCESSREQUEST._serialized_start=5859
+  _TLOCATEPROCESSREQUEST._serialized_end=5909
+  _TCONTAINERLISTRESPONSE._serialized_start=5911
+  _TCONTAINERLISTRESPONSE._serialized_end=5949
+  _TCONTAINERGETPROPERTYRESPONSE._serialized_start=5951
+  _TCONTAINERGETPROPERTYRESPONSE._serialized_end=5997
+  _TCONTAINERGETDATARESPONSE._serialized_start=5999
+  _TCONTAINERGETDATARESPONSE._serialized_end=6041
+  _TCONTAINERPROPERTYLISTRESPONSE._serialized_start=6044
+  _TCONTAINERPROPERTYLISTRESPONSE._serialized_end=6250
+  _TCONTAINERPROPERTYLISTRESPONSE_TCONTAINERPROPERTYLISTENTRY._serialized_start=6157
+  _TCONTAINERPROPERTYLISTRESPONSE_TCONTAINERPROPERTYLISTENTRY._serialized_end=6250
+  _TCONTAINERDATALISTRESPONSE._serialized_start=6253
+  _TCONTAINERDATALISTRESPONSE._serialized_end=6407
+  _TCONTAINERDATALISTRESPONSE_TCONTAINERDATALISTENTRY._serialized_start=6354
+  _TCONTAINERDATALISTRESPONSE_TCONTAINERDATALISTENTRY._serialized_end=6407
+  _TVERSIONRESPONSE._serialized_start=6409
+  _TVERSIONRESPONSE._serialized_end=6458
+  _TCONTAINERGETRESPONSE._serialized_start=6461
+  _TCONTAINERGETRESPONSE._serialized_end=6775
+  _TCONTAINERGETRESPONSE_TCONTAINERGETVALUERESPONSE._serialized_start=6554
+  _TCONTAINERGETRESPONSE_TCONTAINERGETVALUERESPONSE._serialized_end=6661
+  _TCONTAINERGETRESPONSE_TCONTAINERGETLISTRESPONSE._serialized_start=6663
+  _TCONTAINERGETRESPONSE_TCONTAINERGETLISTRESPONSE._serialized_end=6775
+  _TCONTAINERWAITRESPONSE._serialized_start=6777
+  _TCONTAINERWAITRESPONSE._serialized_end=6844
+  _TCONVERTPATHRESPONSE._serialized_start=6846
+  _TCONVERTPATHRESPONSE._serialized_end=6882
+  _TLOCATEPROCESSRESPONSE._serialized_start=6884
+  _TLOCATEPROCESSRESPONSE._serialized_end=6922
+  _TVOLUMEPROPERTY._serialized_start=6924
+  _TVOLUMEPROPERTY._serialized_end=6970
+  _TVOLUMEPROPERTYDESCRIPTION._serialized_start=6972
+  _TVOLUMEPROPERTYDESCRIPTION._serialized_end=7028
+  _TVOLUMELINK._serialized_start=7030
+  _TVOLUMELINK._serialized_end=7115
+  _TVOLUMEDESCRIPTION._serialized_start=7118
+  _TVOLUMEDESCRIPTION._serialized_end=7247
+  _TVOLUMEPROPERTYLISTREQUEST._serialized_start=7249
+  _TVOLUMEPROPERTYLISTREQUEST._serialized_end=7277
+  _TVOLUMEPROPERTYLISTRESPONSE._serialized_start=7279
+  _TVOLUMEPROPERTYLISTRESPONSE._serialized_end=7361
+  _TVOLUMECREATEREQUEST._serialized_start=7363
+  _TVOLUMECREATEREQUEST._serialized_end=7441
+  _TVOLUMELINKREQUEST._serialized_start=7443
+  _TVOLUMELINKREQUEST._serialized_end=7549
+  _TVOLUMEUNLINKREQUEST._serialized_start=7551
+  _TVOLUMEUNLINKREQUEST._serialized_end=7638
+  _TVOLUMELISTREQUEST._serialized_start=7640
+  _TVOLUMELISTREQUEST._serialized_end=7693
+  _TVOLUMETUNEREQUEST._serialized_start=7695
+  _TVOLUMETUNEREQUEST._serialized_end=7771
+  _TVOLUMELISTRESPONSE._serialized_start=7773
+  _TVOLUMELISTRESPONSE._serialized_end=7836
+  _TLAYERIMPORTREQUEST._serialized_start=7838
+  _TLAYERIMPORTREQUEST._serialized_end=7962
+  _TLAYEREXPORTREQUEST._serialized_start=7964
+  _TLAYEREXPORTREQUEST._serialized_end=8066
+  _TLAYERREMOVEREQUEST._serialized_start=8068
+  _TLAYERREMOVEREQUEST._serialized_end=8119
+  _TLAYERLISTREQUEST._serialized_start=8121
+  _TLAYERLISTREQUEST._serialized_end=8169
+  _TLAYERGETPRIVATEREQUEST._serialized_start=8171
+  _TLAYERGETPRIVATEREQUEST._serialized_end=8226
+  _TLAYERSETPRIVATEREQUEST._serialized_start=8228
+  _TLAYERSETPRIVATEREQUEST._serialized_end=8306
+  _TLAYERDESCRIPTION._serialized_start=8308
+  _TLAYERDESCRIPTION._serialized_end=8425
+  _TLAYERLISTRESPONSE._serialized_start=8427
+  _TLAYERLISTRESPONSE._serialized_end=8502
+  _TLAYERGETPRIVATERESPONSE._serialized_start=8504
+  _TLAYERGETPRIVATERESPONSE._serialized_end=8553
+  _TSTORAGEDESCRIPTION._serialized_start=8555
+  _TSTORAGEDESCRIPTION._serialized_end=8674
+  _TSTORAGELISTREQUEST._serialized_start=8676
+  _TSTORAGELISTREQUEST._serialized_end=8726
+  _TSTORAGELISTRESPONSE._serialized_start=8729
+  _TSTORAGELISTRESPONSE._serialized_end=8860
+  _TSTORAGEREMOVEREQUEST._serialized_start=8862
+  _TSTORAGEREMOVEREQUEST._serialized_end=8914
+  _TSTORAGEIMPORTREQUEST._serialized_start=8916
+  _TSTORAGEIMPORTREQUEST._serialized_end=9026
+  _TSTORAGEEXPORTREQUEST._serialized_start=9028
+  _TSTORAGEEXPORTREQUEST._serialized_end=9115
+  _TMETASTORAGE._serialized_start=9118
+  _TMETASTORAGE._serialized_end=9377
+  _TSETSYMLINKREQUEST._serialized_start=9379
+  _TSETSYMLINKREQUEST._serialized_end=9451
+  _TREQUESTRECORD._serialized_start=9454
+  _TREQUESTRECORD._serialized_end=9688
+# @@protoc_insertion_point(module_scope)
@@ -488,6 +488,40 @@ TError TMemorySubsystem::GetAnonUsage(TCgroup &cg, uint64_t &usage) const {
     return error;
 }
 
+/* Bytes per numa node, "N<node>=<pages>" in line total or hierarchical_total */
+TError TMemorySubsystem::GetNumaUsage(TCgroup &cg, TUintMap &usage) const {
+    std::vector<std::string> lines;
+    std::string total;
+    TError error;
+
+    error = cg.Knob(NUMA_STAT).ReadLines(lines);
+    if (error)
+        return error;
+
+    for (auto &line: lines) {
+        if (StringStartsWith(line, "hierarchical_total=") ||
+                (total.empty() && StringStartsWith(line, "total=")))
+            total = line;
+    }
+
+    if (total.empty())
+        return TError(EError::NotSupported, "No total in {}", NUMA_STAT);
+
+    uint64_t page = sysconf(_SC_PAGESIZE);
+
+    for (auto &word: SplitString(total, ' ')) {
+        auto sep = word.find('=');
+        uint64_t pages;
+
+        if (word.empty() || word[0] != 'N' || sep == std::string::npos ||
+                StringToUint64(word.substr(sep + 1), pages))
+            continue;
+        usage[word.substr(1, sep - 1)] = pages * page;
+    }
+
+    return OK;
+}
+
 bool TMemorySubsystem::SupportAnonLimit() const {
     return Cgroup(PORTO_DAEMON_CGROUP).Has(ANON_LIMIT);
 }
@@ -559,6 +593,26 @@ uint64_t TMemorySubsystem::GetOomEvents(TCgroup &cg) {
     return 0;
 }
 
+/* Counters max, oom, oom_kill from memory.events or legacy knobs */
+TError TMemorySubsystem::GetEvents(TCgroup &cg, TUintMap &events) {
+    uint64_t val;
+
+    if (cg.Has(EVENTS))
+        return cg.GetUintMap(EVENTS, events);
+
+    if (!cg.GetUint64(FAILCNT, val))
+        events["max"] = val;
+
+    if (!GetOomKills(cg, val))
+        events["oom_kill"] = val;
+
+    TUintMap stat;
+    if (!Statistics(cg, stat) && stat.count("oom_events"))
+        events["oom"] = stat["oom_events"];
+
+    return OK;
+}
+
 TError TMemorySubsystem::GetReclaimed(TCgroup &cg, uint64_t &count) const {
     TUintMap stat;
     Statistics(cg, stat);
@@ -799,6 +853,53 @@ TError TCpuacctSubsystem::SystemUsage(TCgroup &cg, uint64_t &value) const {
     return OK;
 }
 
+/* Root has system-wide stats, cgroups expose them next to cpuacct */
+TPath TCpuacctSubsystem::PressurePath(const TCgroup &cg, const std::string &resource) const {
+    if (cg.IsRoot())
+        return TPath("/proc/pressure") / resource;
+    return cg.Knob(resource + ".pressure");
+}
+
+TError TCpuacctSubsystem::GetPressure(const TCgroup &cg, const std::string &resource, std::string &value) const {
+    std::vector<std::string> lines;
+    TError error;
+
+    error = PressurePath(cg, resource).ReadLines(lines);
+    if (error)
+        return error;
+
+    value = "";
+    for (auto &line: lines) {
+        if (value.size())
+            value += "; ";
+        value += StringTrim(line);
+    }
+
+    return OK;
+}
+
+/* Trigger is "some|full <stall us> <window us>", file polls with POLLPRI */
+TError TCpuacctSubsystem::SetupPressureTrigger(const TCgroup &cg, const std::string &resource,
+                                               const std::string &trigger, TFile &file) const {
+    TError error;
+
+    error = file.Open(PressurePath(cg, resource), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (error)
+        return error;
+
+    /* Kernel takes trigger as nul-terminated string */
+    std::string text = trigger;
+    text.push_back('\0');
+
+    error = file.WriteAll(text);
+    if (error) {
+        file.Close();
+        return TError(error, "Cannot set pressure trigger {} {}", resource, trigger);
+    }
+
+    return OK;
+}
+
 // Cpuset
 TError TCpusetSubsystem::SetCpus(TCgroup &cg, const std::string &cpus) const {
     std::string val;
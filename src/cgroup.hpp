@@ -155,6 +155,10 @@ public:
     const std::string ANON_USAGE = "memory.anon.usage";
     const std::string ANON_MAX_USAGE = "memory.anon.max_usage";
     const std::string ANON_LIMIT = "memory.anon.limit";
+    const std::string NUMA_STAT = "memory.numa_stat";
+    const std::string EVENTS = "memory.events";
+    const std::string FAILCNT = "memory.failcnt";
+    const std::string RECLAIM = "memory.reclaim";
 
     TMemorySubsystem() : TSubsystem(CGROUP_MEMORY, "memory") {}
 
@@ -192,6 +196,18 @@ public:
         return RootCgroup().Has(DIRTY_LIMIT);
     }
 
+    bool SupportReclaim() const {
+        return RootCgroup().Has(RECLAIM);
+    }
+
+    /* Kernel returns EAGAIN if reclaimed less than requested */
+    TError Reclaim(TCgroup &cg, uint64_t bytes) const {
+        TError error = cg.Set(RECLAIM, std::to_string(bytes));
+        if (error.Errno == EAGAIN)
+            return OK;
+        return error;
+    }
+
     bool SupportSwap() const {
         return RootCgroup().Has(MEM_SWAP_LIMIT);
     }
@@ -208,6 +224,7 @@ public:
 
     TError GetCacheUsage(TCgroup &cg, uint64_t &usage) const;
     TError GetAnonUsage(TCgroup &cg, uint64_t &usage) const;
+    TError GetNumaUsage(TCgroup &cg, TUintMap &usage) const;
 
     TError GetAnonMaxUsage(TCgroup &cg, uint64_t &usage) const {
         return cg.GetUint64(ANON_MAX_USAGE, usage);
@@ -226,6 +243,7 @@ public:
     TError SetupOOMEvent(TCgroup &cg, TFile &event);
     uint64_t GetOomEvents(TCgroup &cg);
     TError GetOomKills(TCgroup &cg, uint64_t &count);
+    TError GetEvents(TCgroup &cg, TUintMap &events);
     TError GetReclaimed(TCgroup &cg, uint64_t &count) const;
 };
 
@@ -265,6 +283,12 @@ public:
     TCpuacctSubsystem() : TSubsystem(CGROUP_CPUACCT, "cpuacct") {}
     TError Usage(TCgroup &cg, uint64_t &value) const;
     TError SystemUsage(TCgroup &cg, uint64_t &value) const;
+
+    /* Pressure stall information: resource is cpu, memory or io */
+    TPath PressurePath(const TCgroup &cg, const std::string &resource) const;
+    TError GetPressure(const TCgroup &cg, const std::string &resource, std::string &value) const;
+    TError SetupPressureTrigger(const TCgroup &cg, const std::string &resource,
+                                const std::string &trigger, TFile &file) const;
 };
 
 class TCpusetSubsystem : public TSubsystem {
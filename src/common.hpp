@@ -99,6 +99,10 @@ constexpr const char *PORTO_PLACE = "/place";
 constexpr const char *PORTO_VOLUMES = "porto_volumes";
 constexpr const char *PORTO_LAYERS = "porto_layers";
 constexpr const char *PORTO_STORAGE = "porto_storage";
+constexpr const char *PORTO_BLOBS = "porto_blobs";
+constexpr const char *PORTO_TRASH = "porto_trash";
+constexpr const char *PORTO_LOOP_POOL = "porto_loop_pool";
+constexpr const char *PORTO_LOWER = "porto_lower";
 
 constexpr const char *PORTO_CHROOT_VOLUMES = "porto";
 
@@ -49,6 +49,8 @@ static void DefaultConfig() {
 
     config().mutable_log()->set_verbose(false);
     config().mutable_log()->set_debug(false);
+    config().mutable_log()->set_buffer_size(64 << 10);
+    config().mutable_log()->set_flush_ms(100);
 
     config().set_keyvalue_limit(1 << 20);
     config().set_keyvalue_size(32 << 20);
@@ -56,6 +58,8 @@ static void DefaultConfig() {
     config().mutable_daemon()->set_rw_threads(20);
     config().mutable_daemon()->set_ro_threads(10);
     config().mutable_daemon()->set_io_threads(5);
+    config().mutable_daemon()->set_helpers_timeout_s(0);
+    config().mutable_daemon()->set_request_journal_size(64 << 20);
 
     config().mutable_daemon()->set_max_clients(1000);
     config().mutable_daemon()->set_max_clients_in_container(500);
@@ -110,6 +114,10 @@ static void DefaultConfig() {
     config().mutable_container()->set_enable_systemd(true);
     config().mutable_container()->set_detect_systemd(true);
 
+    config().mutable_container()->set_task_spawner(false);
+    config().mutable_container()->set_oom_history_size(16);
+    config().mutable_container()->set_memory_reclaim_ms(0);
+
     config().mutable_volumes()->set_enable_quota(true);
 
     if (CompareVersions(config().linux_version(), "4.4") >= 0)
@@ -118,6 +126,15 @@ static void DefaultConfig() {
     config().mutable_volumes()->set_max_total(3000);
     config().mutable_volumes()->set_place_load_limit("default: 2; /ssd: 4");
     config().mutable_volumes()->set_squashfs_compression("gzip");
+    config().mutable_volumes()->set_archive_threads(4);
+    config().mutable_volumes()->set_zstd_compression_level(3);
+    config().mutable_volumes()->set_layer_dedup(false);
+    config().mutable_volumes()->set_tree_threads(4);
+    config().mutable_volumes()->set_async_destroy(false);
+    config().mutable_volumes()->set_trash_rate(0);
+    config().mutable_volumes()->set_loop_dev_pool(8);
+    config().mutable_volumes()->set_loop_block_size(0);
+    config().mutable_volumes()->set_stat_cache_ms(0);
 
     config().mutable_volumes()->set_owner_container_migration_hack(true); /* FIXME kill it */
 
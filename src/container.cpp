@@ -5,6 +5,8 @@
 #include <cstdlib>
 #include <algorithm>
 #include <condition_variable>
+#include <thread>
+#include <climits>
 
 #include "portod.hpp"
 #include "container.hpp"
@@ -37,6 +39,7 @@ extern "C" {
 #include <sys/fsuid.h>
 #include <sys/stat.h>
 #include <sys/wait.h>
+#include <linux/mempolicy.h>
 #include <sys/vfs.h>
 #include <linux/magic.h>
 }
@@ -48,11 +51,18 @@ std::map<std::string, std::shared_ptr<TContainer>> Containers;
 TPath ContainersKV;
 TIdMap ContainerIdMap(1, CONTAINER_ID_MAX);
 
+/* Registered containers by id, under ContainersMutex */
+
 std::mutex CpuAffinityMutex;
 static std::vector<TBitMap> CoreThreads;
+static std::vector<TBitMap> CacheThreads;   /* sharing last level cache */
+static std::vector<TBitMap> CacheDomains;
+static std::vector<unsigned> CpuNode;
 
 static TBitMap NumaNodes;
 static std::vector<TBitMap> NodeThreads;
+static TBitMap TopologyCpus;
+static std::vector<std::vector<unsigned>> NodeDistance;
 
 TError TContainer::ValidName(const std::string &name, bool superuser) {
 
@@ -646,7 +656,7 @@ TError TContainer::Restore(const TKeyValue &kv, std::shared_ptr<TContainer> &ct)
         if (error)
             goto err;
 
-        ct->PropagateCpuLimit();
+        ct->UpdateCpuAggregates();
 
         error = ct->SyncCgroups();
         if (error)
@@ -812,7 +822,7 @@ TError TContainer::UpdateSoftLimit() {
         if (!(ct->Controllers & CGROUP_MEMORY))
             continue;
 
-        int64_t lim = -1;
+        int64_t lim = ct->ReclaimSoftLimit;
 
         /* Set memory soft limit for dead or hollow meta containers */
         if (ct->PressurizeOnDeath &&
@@ -833,6 +843,134 @@ TError TContainer::UpdateSoftLimit() {
     return OK;
 }
 
+/* Active lists and unevictable memory, inactive lists are cold candidates */
+static uint64_t WorkingSetSample(TUintMap &stat) {
+    return stat["total_active_anon"] + stat["total_active_file"] +
+           stat["total_unevictable"];
+}
+
+TError TContainer::GetWorkingSet(uint64_t &ws) {
+    ws = WorkingSet;
+    if (ws)
+        return OK;
+
+    auto cg = GetCgroup(MemorySubsystem);
+    TUintMap stat;
+    TError error = MemorySubsystem.Statistics(cg, stat);
+    if (!error)
+        ws = WorkingSetSample(stat);
+    return error;
+}
+
+/*
+ * Working set estimation follows growth at once and decays slowly:
+ * memory recently moved into inactive lists could be used again soon.
+ * Cold memory above working set is reclaimed by memory.reclaim if kernel
+ * supports it, otherwise soft limit makes it first victim of reclaim.
+ */
+TError TContainer::ReclaimMemory() {
+    auto cg = GetCgroup(MemorySubsystem);
+    uint64_t usage, ws, sample;
+    TUintMap stat;
+    TError error;
+
+    error = MemorySubsystem.Statistics(cg, stat);
+    if (!error)
+        error = MemorySubsystem.Usage(cg, usage);
+    if (error)
+        return error;
+
+    sample = WorkingSetSample(stat);
+    ws = WorkingSet;
+    if (sample >= ws)
+        ws = sample;
+    else
+        ws -= (ws - sample) / 4;
+    WorkingSet = ws;
+
+    uint64_t percent = ProactiveReclaim;
+    if (!percent && ReclaimSoftLimit < 0)
+        return OK;
+
+    uint64_t cold = usage > ws ? usage - ws : 0;
+    uint64_t bytes = cold / 100 * std::min(percent, (uint64_t)100);
+
+    if (MemorySubsystem.SupportReclaim()) {
+        if (bytes < (1 << 20))
+            return OK;
+        L_ACT("Reclaim {} of {} cold memory in CT{}:{}",
+              StringFormatSize(bytes), StringFormatSize(cold), Id, Name);
+        return MemorySubsystem.Reclaim(cg, bytes);
+    }
+
+    auto lock = LockContainers();
+    /* Could be stopped meanwhile, FreeRuntimeResources resets limit */
+    if (State != EContainerState::Running && State != EContainerState::Meta)
+        return OK;
+    ReclaimSoftLimit = bytes ? (int64_t)(usage - bytes) : -1;
+    lock.unlock();
+
+    return UpdateSoftLimit();
+}
+
+static std::mutex MemoryReclaimerMutex;
+static std::condition_variable MemoryReclaimerCv;
+static std::thread MemoryReclaimerThread;
+static bool MemoryReclaimerStop;
+
+static void MemoryReclaimerWorker() {
+    SetProcessName("portod-reclaim");
+
+    auto lock = std::unique_lock<std::mutex>(MemoryReclaimerMutex);
+    while (!MemoryReclaimerStop) {
+        std::vector<std::shared_ptr<TContainer>> containers;
+
+        lock.unlock();
+
+        auto ct_lock = LockContainers();
+        for (auto &it: Containers) {
+            auto &ct = it.second;
+            if (!ct->IsRoot() && (ct->Controllers & CGROUP_MEMORY) &&
+                    (ct->State == EContainerState::Running ||
+                     ct->State == EContainerState::Meta))
+                containers.push_back(ct);
+        }
+        ct_lock.unlock();
+
+        for (auto &ct: containers) {
+            TError error = ct->ReclaimMemory();
+            if (error)
+                L_VERBOSE("Cannot reclaim memory in CT{}:{}: {}", ct->Id, ct->Name, error);
+        }
+
+        containers.clear();
+
+        lock.lock();
+        MemoryReclaimerCv.wait_for(lock, std::chrono::milliseconds(config().container().memory_reclaim_ms()),
+                                   [&]{ return MemoryReclaimerStop; });
+    }
+}
+
+void TContainer::StartMemoryReclaimer() {
+    if (!config().container().memory_reclaim_ms() || MemoryReclaimerThread.joinable())
+        return;
+
+    MemoryReclaimerStop = false;
+    MemoryReclaimerThread = std::thread(MemoryReclaimerWorker);
+}
+
+void TContainer::StopMemoryReclaimer() {
+    if (!MemoryReclaimerThread.joinable())
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(MemoryReclaimerMutex);
+    MemoryReclaimerStop = true;
+    MemoryReclaimerCv.notify_all();
+    lock.unlock();
+
+    MemoryReclaimerThread.join();
+}
+
 void TContainer::SetState(EContainerState next) {
     if (State == next)
         return;
@@ -854,6 +992,11 @@ void TContainer::SetState(EContainerState next) {
             p->RunningChildren += next == EContainerState::Running ? 1 : -1;
     }
 
+    if (prev == EContainerState::Stopped || next == EContainerState::Stopped)
+        UpdateAggregates();
+
+    UpdateCpuAggregates();
+
     if (next == EContainerState::Dead && AutoRespawn)
         ScheduleRespawn();
 
@@ -883,15 +1026,18 @@ TError TContainer::Destroy() {
 
     std::list<std::shared_ptr<TVolume>> unlinked;
 
-    if (!Children.empty()) {
-        for (auto &ct: Subtree()) {
-            if (ct.get() != this) {
-                TVolume::UnlinkAllVolumes(ct, unlinked);
-                error = ct->Destroy();
-                if (error)
-                    return error;
-            }
-        }
+    /* Child destroys own subtree and unregisters itself */
+    while (true) {
+        auto lock = LockContainers();
+        if (Children.empty())
+            break;
+        auto ct = Children.back();
+        lock.unlock();
+
+        TVolume::UnlinkAllVolumes(ct, unlinked);
+        error = ct->Destroy();
+        if (error)
+            return error;
     }
 
     TVolume::UnlinkAllVolumes(shared_from_this(), unlinked);
@@ -1022,54 +1168,84 @@ TError TContainer::CheckMemGuarantee() const {
     return OK;
 }
 
-uint64_t TContainer::GetTotalMemGuarantee(bool containers_locked) const {
-    uint64_t sum = 0lu;
+static std::mutex AggregatesMutex;
 
-    /* Stopped container doesn't have memory guarantees */
-    if (State == EContainerState::Stopped)
-        return 0;
+/* Limit of subtree without ancestors, zero - unlimited */
+static uint64_t SubtreeMemLimit(const TContainer &ct) {
+    uint64_t lim = 0;
 
-    if (!containers_locked)
-        ContainersMutex.lock();
+    /* Container without load limited with total limit of childrens,
+     * sum which does not fit into 64 bits means unlimited */
+    if (ct.IsMeta() && !ct.OsMode && !ct.MemLimitUnlimited &&
+            !ct.MemLimitOverflow)
+        lim = ct.MemLimitSum;
 
-    for (auto &child : Children)
-        sum += child->GetTotalMemGuarantee(true);
+    if (ct.MemLimit && (ct.MemLimit < lim || !lim))
+        lim = ct.MemLimit;
 
-    sum = std::max(NewMemGuarantee, sum);
+    return lim;
+}
 
-    if (!containers_locked)
-        ContainersMutex.unlock();
+void TContainer::UpdateAggregates() {
+    std::lock_guard<std::mutex> lock(AggregatesMutex);
 
-    return sum;
-}
-uint64_t TContainer::GetTotalMemLimit(const TContainer *base) const {
-    uint64_t lim = 0;
+    for (auto ct = this; ct->Parent; ct = ct->Parent.get()) {
+        /* Stopped container doesn't have memory guarantees */
+        bool active = ct->State != EContainerState::Stopped;
+        uint64_t guarantee = active ? std::max(ct->NewMemGuarantee, ct->MemGuaranteeSum) : 0;
+        uint64_t limit = active ? SubtreeMemLimit(*ct) : 0;
 
-    if (!base)
-        ContainersMutex.lock();
+        if (active == ct->AggregateActive &&
+                guarantee == ct->MemGuaranteeTotal &&
+                limit == ct->MemLimitTotal)
+            break;
 
-    /* Container without load limited with total limit of childrens */
-    if (IsMeta() && !OsMode) {
-        for (auto &child : Children) {
-            if (child->State == EContainerState::Stopped)
-                continue;
-            auto child_lim = child->GetTotalMemLimit(this);
-            if (!child_lim || child_lim > UINT64_MAX - lim) {
-                lim = 0;
-                break;
-            }
-            lim += child_lim;
+        auto parent = ct->Parent.get();
+
+        parent->MemGuaranteeSum += guarantee - ct->MemGuaranteeTotal;
+
+        if (ct->AggregateActive) {
+            if (ct->MemLimitTotal) {
+                if (parent->MemLimitSum < ct->MemLimitTotal)
+                    parent->MemLimitOverflow--;
+                parent->MemLimitSum -= ct->MemLimitTotal;
+            } else
+                parent->MemLimitUnlimited--;
+        }
+
+        if (active) {
+            if (limit) {
+                if (parent->MemLimitSum > UINT64_MAX - limit)
+                    parent->MemLimitOverflow++;
+                parent->MemLimitSum += limit;
+            } else
+                parent->MemLimitUnlimited++;
         }
+
+        ct->AggregateActive = active;
+        ct->MemGuaranteeTotal = guarantee;
+        ct->MemLimitTotal = limit;
     }
+}
+
+uint64_t TContainer::GetTotalMemGuarantee() const {
+    std::lock_guard<std::mutex> lock(AggregatesMutex);
+
+    if (State == EContainerState::Stopped)
+        return 0;
+
+    return std::max(NewMemGuarantee, MemGuaranteeSum);
+}
 
-    for (auto p = this; p && p != base; p = p->Parent.get()) {
+uint64_t TContainer::GetTotalMemLimit() const {
+    std::lock_guard<std::mutex> lock(AggregatesMutex);
+    uint64_t lim = SubtreeMemLimit(*this);
+
+    for (auto p = Parent.get(); p; p = p->Parent.get()) {
         if (p->MemLimit && (p->MemLimit < lim || !lim))
             lim = p->MemLimit;
     }
 
-    if (!base)
-        ContainersMutex.unlock();
-
     return lim;
 }
 
@@ -1216,15 +1392,258 @@ TError TContainer::ApplyResolvConf() const {
     return error;
 }
 
+static unsigned FirstCpu(const TBitMap &set) {
+    for (unsigned cpu = 0; cpu < set.Size(); cpu++)
+        if (set.Get(cpu))
+            return cpu;
+    return UINT_MAX;
+}
+
+/* Last level cache of cpu, falls back to its node if sysfs has no caches */
+static TBitMap ReadCacheThreads(unsigned cpu) {
+    unsigned best_level = 0;
+    TBitMap best;
+
+    for (unsigned index = 0; ; index++) {
+        TPath dir(StringFormat("/sys/devices/system/cpu/cpu%u/cache/index%u", cpu, index));
+        std::string type, level;
+        TBitMap shared;
+        int lvl;
+
+        if (!dir.Exists())
+            break;
+
+        if ((dir / "type").ReadAll(type) || StringTrim(type) == "Instruction")
+            continue;
+
+        if ((dir / "level").ReadAll(level) || StringToInt(StringTrim(level), lvl) ||
+                (unsigned)lvl <= best_level)
+            continue;
+
+        if (shared.Read(dir / "shared_cpu_list"))
+            continue;
+
+        best_level = lvl;
+        best.Clear();
+        best.Set(shared);
+    }
+
+    if (!best.Weight() && cpu < CpuNode.size() && CpuNode[cpu] < NodeThreads.size())
+        best.Set(NodeThreads[CpuNode[cpu]]);
+
+    if (!best.Weight())
+        best.Set(cpu);
+
+    return best;
+}
+
+static TError ReadCpuTopology(const TBitMap &online) {
+    TError error;
+
+    CoreThreads.clear();
+    CoreThreads.resize(online.Size());
+
+    for (unsigned cpu = 0; cpu < online.Size(); cpu++) {
+        if (!online.Get(cpu))
+            continue;
+        error = CoreThreads[cpu].Read(StringFormat("/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu));
+        if (error)
+            return error;
+    }
+
+    error = NumaNodes.Read("/sys/devices/system/node/online");
+    if (error)
+        return error;
+
+    NodeThreads.clear();
+    NodeThreads.resize(NumaNodes.Size());
+    NodeDistance.clear();
+    NodeDistance.resize(NumaNodes.Size());
+    CpuNode.assign(online.Size(), 0);
+
+    for (unsigned node = 0; node < NumaNodes.Size(); node++) {
+        if (!NumaNodes.Get(node))
+            continue;
+        error = NodeThreads[node].Read(StringFormat("/sys/devices/system/node/node%u/cpulist", node));
+        if (error)
+            return error;
+
+        for (unsigned cpu = 0; cpu < NodeThreads[node].Size() && cpu < CpuNode.size(); cpu++)
+            if (NodeThreads[node].Get(cpu))
+                CpuNode[cpu] = node;
+
+        /* One entry per online node in order of ids, which may be sparse */
+        std::string text;
+        if (!TPath(StringFormat("/sys/devices/system/node/node%u/distance", node)).ReadAll(text)) {
+            auto words = SplitString(StringTrim(text), ' ');
+            unsigned index = 0;
+
+            NodeDistance[node].assign(NumaNodes.Size(), 0);
+            for (unsigned peer = 0; peer < NumaNodes.Size() && index < words.size(); peer++) {
+                int dist;
+                if (!NumaNodes.Get(peer))
+                    continue;
+                if (!StringToInt(words[index++], dist) && dist > 0)
+                    NodeDistance[node][peer] = dist;
+            }
+        }
+    }
+
+    CacheThreads.clear();
+    CacheThreads.resize(online.Size());
+    CacheDomains.clear();
+
+    for (unsigned cpu = 0; cpu < online.Size(); cpu++) {
+        if (!online.Get(cpu))
+            continue;
+        CacheThreads[cpu] = ReadCacheThreads(cpu);
+        if (FirstCpu(CacheThreads[cpu]) == cpu)
+            CacheDomains.push_back(CacheThreads[cpu]);
+    }
+
+    return OK;
+}
+
+static unsigned NumaDistance(unsigned a, unsigned b) {
+    if (a < NodeDistance.size() && b < NodeDistance[a].size() && NodeDistance[a][b])
+        return NodeDistance[a][b];
+    return a == b ? 10 : 20;
+}
+
+/*
+ * Order of vacant cpus for reservation. Request is placed into the smallest
+ * last level cache domain which could hold it, or into the smallest NUMA node,
+ * then spills over to domains nearest by NUMA distance. Best fit keeps large
+ * domains free for large requests.
+ */
+static std::vector<unsigned> PlacementOrder(const TBitMap &vacant,
+                                            unsigned nr_threads, unsigned nr_cores,
+                                            TBitMap &domain) {
+    std::vector<unsigned> order;
+
+    domain.Clear();
+
+    auto capacity = [&](const TBitMap &set, unsigned &threads, unsigned &cores) {
+        threads = cores = 0;
+        for (unsigned cpu = 0; cpu < set.Size(); cpu++) {
+            if (!set.Get(cpu) || !vacant.Get(cpu))
+                continue;
+            threads++;
+            /* count each core once, at its first thread */
+            if (cpu < CoreThreads.size() && FirstCpu(CoreThreads[cpu]) == cpu &&
+                    CoreThreads[cpu].IsSubsetOf(vacant) &&
+                    CoreThreads[cpu].IsSubsetOf(set))
+                cores++;
+        }
+    };
+
+    auto best_fit = [&](const std::vector<TBitMap> &domains) {
+        unsigned best = UINT_MAX;
+        for (auto &set: domains) {
+            unsigned threads, cores;
+            capacity(set, threads, cores);
+            if ((nr_cores ? cores >= nr_cores : threads >= nr_threads) && threads < best) {
+                best = threads;
+                domain.Clear();
+                domain.Set(set);
+            }
+        }
+        return best != UINT_MAX;
+    };
+
+    if (!best_fit(CacheDomains))
+        best_fit(NodeThreads);
+
+    /* Spill over around node of chosen domain or node with most vacant cpus */
+    unsigned home = 0, most = 0;
+    if (domain.Weight()) {
+        unsigned first = FirstCpu(domain);
+        if (first < CpuNode.size())
+            home = CpuNode[first];
+    } else {
+        for (unsigned node = 0; node < NodeThreads.size(); node++) {
+            unsigned threads, cores;
+            capacity(NodeThreads[node], threads, cores);
+            if (threads > most) {
+                home = node;
+                most = threads;
+            }
+        }
+    }
+
+    for (unsigned cpu = 0; cpu < vacant.Size(); cpu++)
+        if (vacant.Get(cpu))
+            order.push_back(cpu);
+
+    auto cache_id = [](unsigned cpu) -> unsigned {
+        return cpu < CacheThreads.size() ? FirstCpu(CacheThreads[cpu]) : cpu;
+    };
+
+    std::stable_sort(order.begin(), order.end(), [&](unsigned a, unsigned b) {
+        bool in_a = domain.Get(a), in_b = domain.Get(b);
+        if (in_a != in_b)
+            return in_a;
+        unsigned dist_a = NumaDistance(home, a < CpuNode.size() ? CpuNode[a] : 0);
+        unsigned dist_b = NumaDistance(home, b < CpuNode.size() ? CpuNode[b] : 0);
+        if (dist_a != dist_b)
+            return dist_a < dist_b;
+        return cache_id(a) < cache_id(b);
+    });
+
+    return order;
+}
+
+std::string TContainer::GetCpuLayout() const {
+    std::string layout;
+
+    for (auto &domain: CacheDomains) {
+        TBitMap cpus;
+
+        for (unsigned cpu = 0; cpu < domain.Size(); cpu++)
+            if (domain.Get(cpu) && CpuAffinity.Get(cpu))
+                cpus.Set(cpu);
+        if (!cpus.Weight())
+            continue;
+
+        unsigned first = FirstCpu(domain);
+        if (layout.size())
+            layout += "; ";
+        layout += fmt::format("node {} cache {}: {}",
+                              first < CpuNode.size() ? CpuNode[first] : 0,
+                              domain.Format(), cpus.Format());
+    }
+
+    return layout;
+}
+
+/* Nodes for task memory policy: memory_nodes or nodes of assigned cpus */
+TBitMap TContainer::GetMemPolicyNodes() const {
+    TBitMap nodes;
+
+    if (MemNodes.Weight()) {
+        nodes.Set(MemNodes);
+        return nodes;
+    }
+
+    for (unsigned cpu = 0; cpu < CpuAffinity.Size() && cpu < CpuNode.size(); cpu++)
+        if (CpuAffinity.Get(cpu))
+            nodes.Set(CpuNode[cpu]);
+
+    return nodes;
+}
+
 TError TContainer::ReserveCpus(unsigned nr_threads, unsigned nr_cores,
                                TBitMap &threads, TBitMap &cores) {
-    bool try_thread = true;
+    bool try_thread = true, spill = false;
+    TBitMap domain;
 
     threads.Clear();
     cores.Clear();
 
+    auto order = PlacementOrder(CpuVacant, nr_threads, nr_cores, domain);
+
 again:
-    for (unsigned cpu = 0; cpu < CpuVacant.Size(); cpu++) {
+    for (auto cpu: order) {
         if (!CpuVacant.Get(cpu))
             continue;
 
@@ -1240,7 +1659,8 @@ again:
                 CpuVacant.Set(cpu, false);
                 try_thread = true;
             }
-        } else if (nr_threads) {
+        } else if (nr_threads && (spill || !domain.Weight() || domain.Get(cpu))) {
+            /* First pass fills half-free cores only in chosen domain */
             nr_threads--;
             threads.Set(cpu);
             CpuVacant.Set(cpu, false);
@@ -1252,6 +1672,7 @@ again:
 
     if (try_thread && nr_threads) {
         try_thread = false;
+        spill = true;
         goto again;
     }
 
@@ -1274,30 +1695,32 @@ TError TContainer::DistributeCpus() {
         if (error)
             return error;
 
-        CoreThreads.clear();
-        CoreThreads.resize(CpuAffinity.Size());
+        /* Topology is static while the same cpus are online */
+        if (!TopologyCpus.IsEqual(CpuAffinity)) {
+            TopologyCpus.Clear();
 
-        for (unsigned cpu = 0; cpu < CpuAffinity.Size(); cpu++) {
-            if (!CpuAffinity.Get(cpu))
-                continue;
-            error = CoreThreads[cpu].Read(StringFormat("/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu));
+            error = ReadCpuTopology(CpuAffinity);
             if (error)
                 return error;
-        }
 
-        error = NumaNodes.Read("/sys/devices/system/node/online");
-        if (error)
-            return error;
+            TopologyCpus.Set(CpuAffinity);
+        }
 
-        NodeThreads.clear();
-        NodeThreads.resize(NumaNodes.Size());
+        /*
+         * Without memory_nodes cpuset.mems stays as cgroups inherit it,
+         * thus nodes of root cgroup, nodes with memory if it is unknown.
+         */
+        TBitMap mems;
+        auto cg = GetCgroup(CpusetSubsystem);
+        if (mems.Read(cg.Knob("cpuset.mems")) || !mems.Weight()) {
+            mems.Clear();
+            if (mems.Read("/sys/devices/system/node/has_memory"))
+                mems.Set(NumaNodes);
+        }
 
-        for (unsigned node = 0; node < NumaNodes.Size(); node++) {
-            if (!NumaNodes.Get(node))
-                continue;
-            error = NodeThreads[node].Read(StringFormat("/sys/devices/system/node/node%u/cpulist", node));
-            if (error)
-                return error;
+        if (!MemAffinity.IsEqual(mems)) {
+            MemAffinity.Clear();
+            MemAffinity.Set(mems);
         }
     }
 
@@ -1313,24 +1736,14 @@ TError TContainer::DistributeCpus() {
         ECpuSetType::Inherit,
     };
 
-    auto subtree = Subtree();
-    subtree.reverse();
-
-    for (auto &parent: subtree) {
-        if (parent->State == EContainerState::Stopped ||
-                parent->State == EContainerState::Dead)
-            continue;
-
-        auto childs = parent->Childs();
-        if (childs.empty())
-            continue;
-
-        L_VERBOSE("Distribute CPUs {} in CT{}:{}", parent->CpuVacant.Format(), parent->Id, parent->Name);
+    /* Children take cpus from vacant set of parent */
+    auto distribute = [&](TContainer &parent) -> TError {
+        L_VERBOSE("Distribute CPUs {} in CT{}:{}", parent.CpuVacant.Format(), parent.Id, parent.Name);
 
         uint64_t vacantGuarantee = 0;
 
         for (auto type: order) {
-            for (auto &ct: childs) {
+            for (auto &ct: parent.Children) {
                 if (ct->CpuSetType != type ||
                         ct->State == EContainerState::Stopped ||
                         ct->State == EContainerState::Dead)
@@ -1343,7 +1756,7 @@ TError TContainer::DistributeCpus() {
 
                 switch (type) {
                 case ECpuSetType::Inherit:
-                    affinity.Set(parent->CpuVacant);
+                    affinity.Set(parent.CpuVacant);
                     break;
                 case ECpuSetType::Absolute:
                     affinity.Set(ct->CpuAffinity);
@@ -1354,28 +1767,28 @@ TError TContainer::DistributeCpus() {
                     affinity.Set(NodeThreads[ct->CpuSetArg]);
                     break;
                 case ECpuSetType::Cores:
-                    error = parent->ReserveCpus(0, ct->CpuSetArg,
+                    error = parent.ReserveCpus(0, ct->CpuSetArg,
                                                 ct->CpuReserve, affinity);
                     if (error)
                         return error;
                     break;
                 case ECpuSetType::Threads:
-                    error = parent->ReserveCpus(ct->CpuSetArg, 0,
+                    error = parent.ReserveCpus(ct->CpuSetArg, 0,
                                                 ct->CpuReserve, affinity);
                     if (error)
                         return error;
                     affinity.Set(ct->CpuReserve);
                     break;
                 case ECpuSetType::Reserve:
-                    error = parent->ReserveCpus(ct->CpuSetArg, 0,
+                    error = parent.ReserveCpus(ct->CpuSetArg, 0,
                                                 ct->CpuReserve, affinity);
                     if (error)
                         return error;
-                    affinity.Set(parent->CpuAffinity);
+                    affinity.Set(parent.CpuAffinity);
                     break;
                 }
 
-                if (!affinity.Weight() || !affinity.IsSubsetOf(parent->CpuAffinity))
+                if (!affinity.Weight() || !affinity.IsSubsetOf(parent.CpuAffinity))
                     return TError(EError::ResourceNotAvailable, "Not enough cpus for CT{}:{}", ct->Id, ct->Name);
 
                 if (!ct->CpuAffinity.IsEqual(affinity)) {
@@ -1384,10 +1797,29 @@ TError TContainer::DistributeCpus() {
                     ct->SetProp(EProperty::CPU_SET_AFFINITY);
                 }
 
+                /* Policies bind and default confine memory in cpuset */
+                TBitMap mems;
+
+                if (ct->MemNodes.Weight() && !ct->MemNodes.IsSubsetOf(parent.MemAffinity))
+                    return TError(EError::ResourceNotAvailable, "Numa nodes {} not available for CT{}:{}", ct->MemNodes.Format(), ct->Id, ct->Name);
+
+                if (ct->MemNodes.Weight() &&
+                        (ct->NumaPolicy == ENumaPolicy::Default ||
+                         ct->NumaPolicy == ENumaPolicy::Bind))
+                    mems.Set(ct->MemNodes);
+                else
+                    mems.Set(parent.MemAffinity);
+
+                if (!ct->MemAffinity.IsEqual(mems)) {
+                    ct->MemAffinity.Clear();
+                    ct->MemAffinity.Set(mems);
+                    ct->SetProp(EProperty::CPU_SET_AFFINITY);
+                }
+
                 if (ct->CpuReserve.Weight())
                     L_ACT("Reserve CPUs {} for CT{}:{}", ct->CpuReserve.Format(), ct->Id, ct->Name);
                 else
-                    vacantGuarantee += std::max(ct->CpuGuarantee, ct->CpuGuaranteeSum);
+                    vacantGuarantee += ct->GetCpuGuarantee();
 
                 L_VERBOSE("Assign CPUs {} for CT{}:{}", ct->CpuAffinity.Format(), ct->Id, ct->Name);
 
@@ -1395,59 +1827,131 @@ TError TContainer::DistributeCpus() {
             }
         }
 
-        if (vacantGuarantee > parent->CpuVacant.Weight() * CPU_POWER_PER_SEC) {
-            if (!parent->CpuVacant.IsEqual(parent->CpuAffinity))
-                return TError(EError::ResourceNotAvailable, "Not enough cpus for cpu_guarantee in CT{}:{}", parent->Id, Parent->Name);
-            L("CPU guarantee overcommit in CT{}:{}", parent->Id, parent->Name);
+        if (vacantGuarantee > parent.CpuVacant.Weight() * CPU_POWER_PER_SEC) {
+            if (!parent.CpuVacant.IsEqual(parent.CpuAffinity))
+                return TError(EError::ResourceNotAvailable, "Not enough cpus for cpu_guarantee in CT{}:{}", parent.Id, parent.Name);
+            L("CPU guarantee overcommit in CT{}:{}", parent.Id, parent.Name);
         }
-    }
 
-    for (auto &ct: subtree) {
-        if (ct.get() == this || !(ct->Controllers & CGROUP_CPUSET) ||
-                !ct->TestPropDirty(EProperty::CPU_SET_AFFINITY) ||
-                ct->State == EContainerState::Stopped ||
-                ct->State == EContainerState::Dead)
-            continue;
+        return OK;
+    };
 
-        auto cg = ct->GetCgroup(CpusetSubsystem);
+    auto ct_lock = LockContainers();
 
-        if (!cg.Exists())
-            continue;
+    /* Pre-order: parents first */
+    WalkLocked([&](TContainer &parent) {
+        if (!error && !parent.Children.empty() &&
+                parent.State != EContainerState::Stopped &&
+                parent.State != EContainerState::Dead)
+            error = distribute(parent);
+        return !error;
+    });
 
-        error = CpusetSubsystem.SetCpus(cg, CpuAffinity.Format());
-        if (error) {
-            L("Cannot set cpu affinity: {}", error);
-            return error;
-        }
-    }
+    if (error)
+        return error;
 
-    subtree.reverse();
+    /* Only changed cgroups, parents first */
+    std::vector<std::shared_ptr<TContainer>> dirty;
 
-    for (auto &ct: subtree) {
-        if (ct.get() == this || !(ct->Controllers & CGROUP_CPUSET) ||
-                !ct->TestClearPropDirty(EProperty::CPU_SET_AFFINITY) ||
-                ct->State == EContainerState::Stopped ||
-                ct->State == EContainerState::Dead)
-            continue;
+    WalkLocked([&](TContainer &ct) {
+        if (&ct != this && (ct.Controllers & CGROUP_CPUSET) &&
+                ct.State != EContainerState::Stopped &&
+                ct.State != EContainerState::Dead &&
+                ct.TestPropDirty(EProperty::CPU_SET_AFFINITY))
+            dirty.push_back(ct.shared_from_this());
+        return true;
+    });
+
+    ct_lock.unlock();
 
+    std::vector<std::pair<TContainer *, TCgroup>> changed;
+
+    for (auto &ct: dirty) {
         auto cg = ct->GetCgroup(CpusetSubsystem);
 
         if (!cg.Exists())
             continue;
 
-        error = CpusetSubsystem.SetCpus(cg, ct->CpuAffinity.Format());
-        if (error) {
-            L("Cannot set cpu affinity: {}", error);
-            return error;
+        /* Unknown after restore or creation, cgroup has parent's sets */
+        if (!ct->CpusetCpus.Weight() &&
+                ct->CpusetCpus.Read(cg.Knob("cpuset.cpus")))
+            ct->CpusetCpus.Clear();
+        if (!ct->CpusetMems.Weight() &&
+                ct->CpusetMems.Read(cg.Knob("cpuset.mems")))
+            ct->CpusetMems.Clear();
+
+        changed.emplace_back(ct.get(), cg);
+    }
+
+    /*
+     * Cpuset must be subset of parent's: widen to union top-down,
+     * then narrow to target bottom-up. Write only knobs which change.
+     */
+    for (auto &it: changed) {
+        auto ct = it.first;
+        TBitMap cpus, mems;
+
+        cpus.Set(ct->CpusetCpus);
+        cpus.Set(ct->CpuAffinity);
+        if (!cpus.IsEqual(ct->CpusetCpus)) {
+            error = ct->SetCpusetCpus(it.second, cpus);
+            if (error)
+                return error;
         }
 
-        error = CpusetSubsystem.SetMems(cg, "");
-        if (error) {
-            L("Cannot set mem affinity: {}", error);
-            return error;
+        mems.Set(ct->CpusetMems);
+        mems.Set(ct->MemAffinity);
+        if (!mems.IsEqual(ct->CpusetMems)) {
+            error = ct->SetCpusetMems(it.second, mems);
+            if (error)
+                return error;
         }
     }
 
+    for (auto it = changed.rbegin(); it != changed.rend(); ++it) {
+        auto ct = it->first;
+
+        if (!ct->CpuAffinity.IsEqual(ct->CpusetCpus)) {
+            error = ct->SetCpusetCpus(it->second, ct->CpuAffinity);
+            if (error)
+                return error;
+        }
+
+        if (ct->MemAffinity.Weight() &&
+                !ct->MemAffinity.IsEqual(ct->CpusetMems)) {
+            error = ct->SetCpusetMems(it->second, ct->MemAffinity);
+            if (error)
+                return error;
+        }
+
+        /* Applied, otherwise retried in next distribution */
+        ct->TestClearPropDirty(EProperty::CPU_SET_AFFINITY);
+    }
+
+    return OK;
+}
+
+TError TContainer::SetCpusetCpus(TCgroup &cg, const TBitMap &cpus) {
+    TError error = CpusetSubsystem.SetCpus(cg, cpus.Format());
+    if (error) {
+        L("Cannot set cpu affinity: {}", error);
+        CpusetCpus.Clear();
+        return error;
+    }
+    CpusetCpus.Clear();
+    CpusetCpus.Set(cpus);
+    return OK;
+}
+
+TError TContainer::SetCpusetMems(TCgroup &cg, const TBitMap &mems) {
+    TError error = CpusetSubsystem.SetMems(cg, mems.Format());
+    if (error) {
+        L("Cannot set mem affinity: {}", error);
+        CpusetMems.Clear();
+        return error;
+    }
+    CpusetMems.Clear();
+    CpusetMems.Set(mems);
     return OK;
 }
 
@@ -1455,20 +1959,7 @@ TError TContainer::ApplyCpuGuarantee() {
     auto cpu_lock = LockCpuAffinity();
     TError error;
 
-    if (config().container().propagate_cpu_guarantee()) {
-        auto ct_lock = LockContainers();
-        CpuGuaranteeSum = 0;
-        for (auto child: Children) {
-            if (child->State == EContainerState::Running ||
-                    child->State == EContainerState::Meta ||
-                    child->State == EContainerState::Starting ||
-                    child->State == EContainerState::Stopping)
-                CpuGuaranteeSum += std::max(child->CpuGuarantee, child->CpuGuaranteeSum);
-        }
-        ct_lock.unlock();
-    }
-
-    auto cur = std::max(CpuGuarantee, CpuGuaranteeSum);
+    auto cur = GetCpuGuarantee();
     if (!IsRoot() && (Controllers & CGROUP_CPU) && cur != CpuGuaranteeCur) {
         L_ACT("Set cpu guarantee CT{}:{} {} -> {}", Id, Name,
                 CpuPowerToString(CpuGuaranteeCur), CpuPowerToString(cur));
@@ -1484,35 +1975,63 @@ TError TContainer::ApplyCpuGuarantee() {
     return OK;
 }
 
-void TContainer::PropagateCpuLimit() {
-    uint64_t max = RootContainer->CpuLimit;
-    auto ct_lock = LockContainers();
+/*
+ * Pushes changes of cpu guarantee and limit contributions up to the root,
+ * stops at the first level where nothing changed. Sums of children are kept
+ * as is, so this costs O(depth) instead of walking all siblings.
+ */
+void TContainer::UpdateCpuAggregates() {
+    std::lock_guard<std::mutex> lock(AggregatesMutex);
+    bool propagate = config().container().propagate_cpu_guarantee();
+    uint64_t max = RootContainer ? RootContainer->CpuLimit : 0;
 
     for (auto ct = this; ct; ct = ct->Parent.get()) {
-        uint64_t sum = 0;
-
-        if (ct->State == EContainerState::Running ||
-                (ct->State == EContainerState::Starting && !ct->IsMeta()))
-            sum += ct->CpuLimit ?: max;
-
-        for (auto &child: ct->Children) {
-            if (child->State == EContainerState::Running ||
-                    (child->State == EContainerState::Starting && !child->IsMeta()))
-                sum += child->CpuLimit ?: max;
-            else if (child->State == EContainerState::Meta)
-                sum += std::min(child->CpuLimit ?: max, child->CpuLimitSum);
-        }
-
-        if (sum == ct->CpuLimitSum)
+        bool running = ct->State == EContainerState::Running ||
+                       (ct->State == EContainerState::Starting && !ct->IsMeta());
+        bool active = ct->State == EContainerState::Running ||
+                      ct->State == EContainerState::Meta ||
+                      ct->State == EContainerState::Starting ||
+                      ct->State == EContainerState::Stopping;
+
+        uint64_t sum = ct->CpuLimitChildren + (running ? ct->CpuLimit ?: max : 0);
+        uint64_t limit = 0;
+        if (running)
+            limit = ct->CpuLimit ?: max;
+        else if (ct->State == EContainerState::Meta)
+            limit = std::min(ct->CpuLimit ?: max, sum);
+
+        uint64_t guarantee = 0;
+        if (propagate && active)
+            guarantee = std::max(ct->CpuGuarantee, ct->CpuGuaranteeSum);
+
+        if (sum == ct->CpuLimitSum && limit == ct->CpuLimitTotal &&
+                guarantee == ct->CpuGuaranteeTotal)
             break;
 
-        L_DBG("Propagate total cpu limit CT{}:{} {} -> {}", ct->Id, ct->Name,
-                CpuPowerToString(ct->CpuLimitSum), CpuPowerToString(sum));
+        if (sum != ct->CpuLimitSum)
+            L_DBG("Propagate total cpu limit CT{}:{} {} -> {}", ct->Id, ct->Name,
+                  CpuPowerToString(ct->CpuLimitSum), CpuPowerToString(sum));
 
         ct->CpuLimitSum = sum;
+
+        if (ct->Parent) {
+            ct->Parent->CpuLimitChildren += limit - ct->CpuLimitTotal;
+            ct->Parent->CpuGuaranteeSum += guarantee - ct->CpuGuaranteeTotal;
+        }
+
+        ct->CpuLimitTotal = limit;
+        ct->CpuGuaranteeTotal = guarantee;
     }
+}
 
-    ct_lock.unlock();
+uint64_t TContainer::GetCpuGuarantee() const {
+    std::lock_guard<std::mutex> lock(AggregatesMutex);
+    return std::max(CpuGuarantee, CpuGuaranteeSum);
+}
+
+uint64_t TContainer::GetCpuLimitSum() const {
+    std::lock_guard<std::mutex> lock(AggregatesMutex);
+    return CpuLimitSum;
 }
 
 TError TContainer::SetCpuLimit(uint64_t limit) {
@@ -1708,6 +2227,7 @@ TError TContainer::ApplyDynamicProperties() {
     if ((Controllers & CGROUP_CPU) &&
             (TestPropDirty(EProperty::CPU_PERIOD) |
              TestClearPropDirty(EProperty::CPU_GUARANTEE))) {
+        UpdateCpuAggregates();
         for (auto ct = this; ct; ct = ct->Parent.get()) {
             error = ct->ApplyCpuGuarantee();
             if (error)
@@ -1718,7 +2238,7 @@ TError TContainer::ApplyDynamicProperties() {
     }
 
     if (TestPropDirty(EProperty::CPU_LIMIT))
-        PropagateCpuLimit();
+        UpdateCpuAggregates();
 
     if ((Controllers & CGROUP_CPU) &&
             (TestPropDirty(EProperty::CPU_POLICY) |
@@ -1739,7 +2259,8 @@ TError TContainer::ApplyDynamicProperties() {
         }
     }
 
-    if (TestClearPropDirty(EProperty::CPU_SET) && Parent) {
+    if ((TestClearPropDirty(EProperty::CPU_SET) |
+         TestClearPropDirty(EProperty::MEM_NODES)) && Parent) {
         error = Parent->DistributeCpus();
         if (error)
             return error;
@@ -1766,6 +2287,14 @@ TError TContainer::ApplyDynamicProperties() {
         }
     }
 
+    if (TestClearPropDirty(EProperty::PRESSURE_TRIGGER)) {
+        error = PreparePressureMonitor();
+        if (error) {
+            L_ERR("Cannot set pressure trigger: {}", error);
+            return error;
+        }
+    }
+
     if (TestClearPropDirty(EProperty::ULIMIT)) {
         for (auto &ct: Subtree()) {
             if (ct->State == EContainerState::Stopped ||
@@ -1836,6 +2365,47 @@ TError TContainer::PrepareOomMonitor() {
     return error;
 }
 
+void TContainer::ShutdownPressure() {
+    for (auto &source: PressureSources)
+        EpollLoop->RemoveSource(source->Fd);
+    PressureSources.clear();
+}
+
+TError TContainer::PreparePressureMonitor() {
+    auto cg = GetCgroup(CpuacctSubsystem);
+    TError error;
+
+    ShutdownPressure();
+
+    for (auto &trigger: PressureTriggers) {
+        auto source = std::make_shared<TPressureSource>(shared_from_this(),
+                                                        trigger.Resource + "_pressure");
+
+        error = CpuacctSubsystem.SetupPressureTrigger(cg, trigger.Resource,
+                fmt::format("{} {} {}", trigger.Type, trigger.Stall, trigger.Window),
+                source->File);
+        if (error)
+            break;
+
+        source->Fd = source->File.Fd;
+        error = EpollLoop->AddSource(source);
+        if (error)
+            break;
+
+        PressureSources.push_back(source);
+    }
+
+    if (error)
+        ShutdownPressure();
+
+    return error;
+}
+
+void TContainer::ReportPressure(const std::string &event) {
+    L_EVT("{} in CT{}:{}", event, Id, Name);
+    TContainerWaiter::ReportEvent(*this, event);
+}
+
 TError TContainer::ApplyDeviceConf() const {
     TError error;
 
@@ -1904,12 +2474,17 @@ TError TContainer::PrepareCgroups() {
             CpuAffinity.Set(Parent->CpuAffinity);
             CpuVacant.Clear();
             CpuVacant.Set(Parent->CpuAffinity);
+            MemAffinity.Clear();
+            MemAffinity.Set(Parent->MemAffinity);
         }
     }
 
     if (Controllers & CGROUP_CPUSET) {
+        auto lock = LockCpuAffinity();
         SetProp(EProperty::CPU_SET);
         SetProp(EProperty::CPU_SET_AFFINITY);
+        CpusetCpus.Clear();
+        CpusetMems.Clear();
     }
 
     if (OsMode && config().container().detect_systemd() &&
@@ -2017,6 +2592,56 @@ TError TContainer::PrepareTask(TTaskEnv &TaskEnv) {
     TaskEnv.CT = shared_from_this();
     TaskEnv.Client = CL;
 
+    TaskEnv.Id = Id;
+    TaskEnv.Name = Name;
+    TaskEnv.Command = Command;
+    TaskEnv.Meta = IsMeta();
+    TaskEnv.Isolate = Isolate;
+    TaskEnv.Hostname = Hostname;
+
+    if (HasProp(EProperty::RESOLV_CONF) ? ResolvConf.size() : Root != "/") {
+        TaskEnv.SetResolvConf = true;
+        TaskEnv.ResolvConf = MergeEscapeStrings(ResolvConf.size() ? ResolvConf :
+                                                RootContainer->ResolvConf, '\n');
+    }
+
+    /* Validated and applied in child */
+    TaskEnv.NetIsolate = NetIsolate;
+    for (const auto &it: Sysctl)
+        TaskEnv.Sysctl.emplace_back(it.first, it.second);
+
+    TaskEnv.Ulimit = GetUlimit();
+
+    if (!TPath(Root).IsRoot()) {
+        TaskEnv.Devices = Devices;
+        for (auto p = Parent; p; p = p->Parent)
+            TaskEnv.Devices.Merge(p->Devices);
+    }
+
+    TaskEnv.OomScoreAdj = OomScoreAdj;
+    TaskEnv.SchedNice = SchedNice;
+    TaskEnv.SchedPolicy = SchedPolicy;
+    TaskEnv.SchedPrio = SchedPrio;
+    TaskEnv.IoPrio = IoPrio;
+
+    if (NumaPolicy != ENumaPolicy::Default) {
+        auto lock = LockCpuAffinity();
+        TaskEnv.MemPolicyNodes = GetMemPolicyNodes();
+        if (NumaPolicy == ENumaPolicy::Bind)
+            TaskEnv.MemPolicy = MPOL_BIND;
+        else if (NumaPolicy == ENumaPolicy::Preferred)
+            TaskEnv.MemPolicy = MPOL_PREFERRED;
+        else
+            TaskEnv.MemPolicy = MPOL_INTERLEAVE;
+    }
+    TaskEnv.CapAmbient = CapAmbient;
+    TaskEnv.CapBound = CapBound;
+    TaskEnv.Umask = Umask;
+    TaskEnv.Stdin = Stdin;
+    TaskEnv.Stdout = Stdout;
+    TaskEnv.Stderr = Stderr;
+    TaskEnv.AutoconfTimeout = config().network().autoconf_timeout_s();
+
     for (auto hy: Hierarchies)
         TaskEnv.Cgroups.push_back(GetCgroup(*hy));
 
@@ -2533,7 +3158,7 @@ TError TContainer::PrepareRuntimeResources() {
         return error;
     }
 
-    PropagateCpuLimit();
+    UpdateCpuAggregates();
 
     return OK;
 }
@@ -2542,6 +3167,12 @@ void TContainer::FreeRuntimeResources() {
     TError error;
 
     ShutdownOom();
+    ShutdownPressure();
+
+    auto ct_lock = LockContainers();
+    ReclaimSoftLimit = -1;
+    ct_lock.unlock();
+    WorkingSet = 0;
 
     error = UpdateSoftLimit();
     if (error)
@@ -2554,7 +3185,7 @@ void TContainer::FreeRuntimeResources() {
             L_ERR("Cannot redistribute CPUs: {}", error);
     }
 
-    PropagateCpuLimit();
+    UpdateCpuAggregates();
 
     if (CpuGuarantee && config().container().propagate_cpu_guarantee()) {
         for (auto p = Parent; p; p = p->Parent)
@@ -2843,7 +3474,6 @@ TError TContainer::Pause() {
         if (ct->State == EContainerState::Running ||
                 ct->State == EContainerState::Meta) {
             ct->SetState(EContainerState::Paused);
-            ct->PropagateCpuLimit();
             error = ct->Save();
             if (error)
                 L_ERR("Cannot save state after pause: {}", error);
@@ -2874,7 +3504,6 @@ TError TContainer::Resume() {
             FreezerSubsystem.Thaw(cg, false);
         if (ct->State == EContainerState::Paused) {
             ct->SetState(IsMeta() ? EContainerState::Meta : EContainerState::Running);
-            ct->PropagateCpuLimit();
         }
         error = ct->Save();
         if (error)
@@ -3015,15 +3644,16 @@ void TContainer::SyncPropertiesAll() {
     TNetwork::SyncAllStat();
 }
 
-/* return true if index specified for property */
-static bool ParsePropertyName(std::string &name, std::string &idx) {
-    if (name.size() && name.back() == ']') {
-        auto lb = name.find('[');
+/* return true if index specified for property, name is property[0..len) */
+static bool ParsePropertyName(const std::string &property, size_t &len, std::string &idx) {
+    len = property.size();
+
+    if (len && property.back() == ']') {
+        auto lb = property.find('[');
 
         if (lb != std::string::npos) {
-            idx = name.substr(lb + 1);
-            idx.pop_back();
-            name = name.substr(0, lb);
+            idx.assign(property, lb + 1, len - lb - 2);
+            len = lb;
 
             return true;
         }
@@ -3033,11 +3663,12 @@ static bool ParsePropertyName(std::string &name, std::string &idx) {
 }
 
 TError TContainer::HasProperty(const std::string &property) const {
-    std::string name = property, index;
+    std::string index;
+    size_t len;
     TError error;
 
-    if (!ParsePropertyName(name, index)) {
-        auto dot = name.find('.');
+    if (!ParsePropertyName(property, len, index)) {
+        auto dot = property.find('.');
         if (dot != std::string::npos) {
             if (State == EContainerState::Stopped)
                 return TError(EError::InvalidState, "Not available in stopped state");
@@ -3053,12 +3684,10 @@ TError TContainer::HasProperty(const std::string &property) const {
         }
     }
 
-    auto it = ContainerProperties.find(name);
-    if (it == ContainerProperties.end())
+    auto prop = FindContainerProperty(property.data(), len);
+    if (!prop)
         return TError(EError::InvalidProperty, "Unknown property");
 
-    auto prop = it->second;
-
     if (!prop->IsSupported)
         return TError(EError::NotSupported, "Not supported");
 
@@ -3079,12 +3708,12 @@ TError TContainer::HasProperty(const std::string &property) const {
     return error;
 }
 
-TError TContainer::GetProperty(const std::string &origProperty, std::string &value) const {
+TError TContainer::GetProperty(const std::string &property, std::string &value) const {
     TError error;
-    std::string property = origProperty;
     std::string idx;
+    size_t len;
 
-    if (!ParsePropertyName(property, idx)) {
+    if (!ParsePropertyName(property, len, idx)) {
         auto dot = property.find('.');
 
         if (dot != std::string::npos) {
@@ -3107,11 +3736,10 @@ TError TContainer::GetProperty(const std::string &origProperty, std::string &val
         return TError(EError::InvalidProperty, "Empty property index");
     }
 
-    auto it = ContainerProperties.find(property);
-    if (it == ContainerProperties.end())
+    auto prop = FindContainerProperty(property.data(), len);
+    if (!prop)
         return TError(EError::InvalidProperty,
-                              "Unknown container property: " + property);
-    auto prop = it->second;
+                              "Unknown container property: " + property.substr(0, len));
 
     CT = const_cast<TContainer *>(this);
     error = prop->CanGet();
@@ -3126,24 +3754,23 @@ TError TContainer::GetProperty(const std::string &origProperty, std::string &val
     return error;
 }
 
-TError TContainer::SetProperty(const std::string &origProperty,
+TError TContainer::SetProperty(const std::string &property,
                                const std::string &origValue) {
     if (IsRoot())
         return TError(EError::Permission, "System containers are read only");
 
-    std::string property = origProperty;
     std::string idx;
+    size_t len;
 
-    if (ParsePropertyName(property, idx) && !idx.length())
+    if (ParsePropertyName(property, len, idx) && !idx.length())
         return TError(EError::InvalidProperty, "Empty property index");
 
     std::string value = StringTrim(origValue);
     TError error;
 
-    auto it = ContainerProperties.find(property);
-    if (it == ContainerProperties.end())
-        return TError(EError::InvalidProperty, "Invalid property " + property);
-    auto prop = it->second;
+    auto prop = FindContainerProperty(property.data(), len);
+    if (!prop)
+        return TError(EError::InvalidProperty, "Invalid property " + property.substr(0, len));
 
     CT = this;
 
@@ -3189,23 +3816,28 @@ TError TContainer::Save(void) {
 
     CT = this;
 
-    for (auto knob : ContainerProperties) {
+    for (int i = 0; i < (int)EProperty::NR_PROPERTIES; i++) {
+        EProperty prop = (EProperty)i;
         std::string value;
 
         /* Skip knobs without a value */
-        if (knob.second->Prop == EProperty::NONE || !HasProp(knob.second->Prop))
+        if (!HasProp(prop))
+            continue;
+
+        auto knob = FindContainerProperty(prop);
+        if (!knob)
             continue;
 
-        error = knob.second->Get(value);
+        error = knob->Get(value);
         if (error)
             break;
 
         /* Temporary hack for backward migration */
-        if (knob.second->Prop == EProperty::STATE &&
+        if (prop == EProperty::STATE &&
                 State == EContainerState::Respawning)
             value = "dead";
 
-        node.Set(knob.first, value);
+        node.Set(knob->Name, value);
     }
 
     CT = nullptr;
@@ -3242,12 +3874,11 @@ TError TContainer::Load(const TKeyValue &node) {
         if (key == P_RAW_ID || key == P_RAW_NAME)
             continue;
 
-        auto it = ContainerProperties.find(key);
-        if (it == ContainerProperties.end()) {
+        auto prop = FindContainerProperty(key);
+        if (!prop) {
             L_WRN("Unknown property: {}, skipped", key);
             continue;
         }
-        auto prop = it->second;
 
         controllers |= prop->RequireControllers;
 
@@ -3499,6 +4130,13 @@ bool TContainer::RecvOomEvents() {
         OomEvents += val;
         Statistics->ContainersOOM += val;
         L_EVT("OOM in CT{}:{}", Id, Name);
+
+        TOomRecord record;
+        auto cg = GetCgroup(MemorySubsystem);
+        record.Time = GetCurrentTimeMs();
+        (void)MemorySubsystem.Usage(cg, record.Usage);
+        (void)cg.GetUint64(MemorySubsystem.LIMIT, record.Limit);
+        OomHistory.Add(record);
         return true;
     }
 
@@ -3525,6 +4163,12 @@ void TContainer::Event(const TEvent &event) {
         }
         break;
     }
+    case EEventType::OOMKill:
+    {
+        lock.unlock();
+        TOomMonitor::ReportVictim(event);
+        break;
+    }
     case EEventType::Respawn:
     {
         lock.unlock();
@@ -3537,10 +4181,10 @@ void TContainer::Event(const TEvent &event) {
     {
         bool delivered = false;
         for (auto &it: Containers) {
-            auto ct = it.second;
-            if (ct->WaitTask.Pid != event.Exit.Pid &&
-                    ct->SeizeTask.Pid != event.Exit.Pid)
+            if (it.second->WaitTask.Pid != event.Exit.Pid &&
+                    it.second->SeizeTask.Pid != event.Exit.Pid)
                 continue;
+            auto ct = it.second;
             error = ct->LockAction(lock);
             lock.unlock();
             if (!error) {
@@ -3598,21 +4242,34 @@ void TContainer::Event(const TEvent &event) {
         break;
 
     case EEventType::RotateLogs:
+    {
+        /* Only containers with work are referenced */
+        std::vector<std::shared_ptr<TContainer>> aged, running;
+        uint64_t now = GetCurrentTimeMs();
+
+        RootContainer->WalkLocked([&](TContainer &ct) {
+            if (ct.State == EContainerState::Dead &&
+                    now >= ct.DeathTime + ct.AgingTime)
+                aged.push_back(ct.shared_from_this());
+            if (ct.State == EContainerState::Running)
+                running.push_back(ct.shared_from_this());
+            return true;
+        });
         lock.unlock();
-        for (auto &ct: RootContainer->Subtree()) {
-            if (ct->State == EContainerState::Dead &&
-                    GetCurrentTimeMs() >= ct->DeathTime + ct->AgingTime) {
-                TEvent ev(EEventType::DestroyAgedContainer, ct);
-                EventQueue->Add(0, ev);
-            }
-            if (ct->State == EContainerState::Running) {
-                ct->Stdout.Rotate(*ct);
-                ct->Stderr.Rotate(*ct);
-            }
+
+        for (auto &ct: aged) {
+            TEvent ev(EEventType::DestroyAgedContainer, ct);
+            EventQueue->Add(0, ev);
+        }
+        for (auto &ct: running) {
+            ct->Stdout.Rotate(*ct);
+            ct->Stderr.Rotate(*ct);
         }
+
         EventQueue->Add(config().daemon().log_rotate_ms(), event);
         break;
     }
+    }
 }
 
 std::string TContainer::GetPortoNamespace(bool write) const {
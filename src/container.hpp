@@ -15,6 +15,7 @@
 #include "property.hpp"
 #include "network.hpp"
 #include "device.hpp"
+#include "oom.hpp"
 
 class TEpollSource;
 class TCgroup;
@@ -49,7 +50,22 @@ enum class ECpuSetType {
     Absolute,
 };
 
+enum class ENumaPolicy {
+    Default,
+    Bind,
+    Preferred,
+    Interleave,
+};
+
 class TProperty;
+class TPressureSource;
+
+struct TPressureTrigger {
+    std::string Resource;   /* cpu, memory, io */
+    std::string Type;       /* some, full */
+    uint64_t Stall;         /* usec */
+    uint64_t Window;        /* usec */
+};
 
 class TContainer : public std::enable_shared_from_this<TContainer>,
                    public TNonCopyable {
@@ -77,6 +93,10 @@ class TContainer : public std::enable_shared_from_this<TContainer>,
     TError ApplyDynamicProperties();
     TError PrepareOomMonitor();
     void ShutdownOom();
+
+    std::vector<std::shared_ptr<TPressureSource>> PressureSources;
+    TError PreparePressureMonitor();
+    void ShutdownPressure();
     TError PrepareCgroups();
     TError PrepareTask(TTaskEnv &TaskEnv);
 
@@ -92,10 +112,11 @@ class TContainer : public std::enable_shared_from_this<TContainer>,
     TError ReserveCpus(unsigned nr_threads, unsigned nr_cores,
                        TBitMap &threads, TBitMap &cores);
     TError DistributeCpus();
+    TError SetCpusetCpus(TCgroup &cg, const TBitMap &cpus);
+    TError SetCpusetMems(TCgroup &cg, const TBitMap &mems);
     TError SetCpuLimit(uint64_t limit);
     TError ApplyCpuLimit();
     TError ApplyCpuGuarantee();
-    void PropagateCpuLimit();
 
 public:
     const std::shared_ptr<TContainer> Parent;
@@ -168,11 +189,29 @@ public:
     uint64_t MemGuarantee = 0;
     uint64_t NewMemGuarantee = 0;
     int64_t MemSoftLimit = 0;
+    int64_t ReclaimSoftLimit = -1;      /* under ContainersMutex */
+    std::atomic<uint64_t> ProactiveReclaim{0}; /* percent of cold memory per period */
+    std::atomic<uint64_t> WorkingSet{0}; /* estimated by memory reclaimer */
     uint64_t AnonMemLimit = 0;
     uint64_t DirtyMemLimit = 0;
     int64_t HugetlbLimit = -1;
     uint64_t ThreadLimit = 0;
 
+    /* Under AggregatesMutex, subtree sums maintained by UpdateAggregates
+     * and UpdateCpuAggregates */
+    uint64_t MemGuaranteeSum = 0;       /* of active children */
+    uint64_t MemGuaranteeTotal = 0;     /* own contribution into parent */
+    uint64_t MemLimitSum = 0;           /* of active limited children, mod 2^64 */
+    int MemLimitOverflow = 0;           /* carries out of MemLimitSum */
+    uint64_t MemLimitTotal = 0;         /* own contribution into parent */
+    int MemLimitUnlimited = 0;          /* active children without limit */
+    bool AggregateActive = false;       /* contributes into parent */
+    uint64_t CpuGuaranteeSum = 0;       /* of active children */
+    uint64_t CpuGuaranteeTotal = 0;     /* own contribution into parent */
+    uint64_t CpuLimitSum = 0;           /* own limit if running and children */
+    uint64_t CpuLimitChildren = 0;      /* of running and meta children */
+    uint64_t CpuLimitTotal = 0;         /* own contribution into parent */
+
     bool RechargeOnPgfault = false;
     bool PressurizeOnDeath = false;
 
@@ -201,10 +240,19 @@ public:
     TBitMap CpuVacant;
     TBitMap CpuReserve;
 
+    std::vector<TPressureTrigger> PressureTriggers;
+
+    /* Under CpuAffinityMutex, empty MemNodes means inherit */
+    ENumaPolicy NumaPolicy = ENumaPolicy::Default;
+    TBitMap MemNodes;
+    TBitMap MemAffinity;
+
+    /* Under CpuAffinityMutex, last written into cgroup, empty if unknown */
+    TBitMap CpusetCpus;
+    TBitMap CpusetMems;
+
     /* Under CpuAffinityMutex */
-    uint64_t CpuGuaranteeSum = 0;
     uint64_t CpuGuaranteeCur = 0;
-    uint64_t CpuLimitSum = 0;
     uint64_t CpuLimitCur = 0;
 
     bool AutoRespawn = false;
@@ -226,6 +274,7 @@ public:
     int OomScoreAdj = 0;
     std::atomic<uint64_t> OomEvents;
     bool OomKilled = false;
+    TOomHistory OomHistory;
     int ExitStatus = 0;
 
     struct {
@@ -235,6 +284,7 @@ public:
     } TaintFlags;
 
     bool RecvOomEvents();
+    void ReportPressure(const std::string &event);
 
     TPath RootPath; /* path in host namespace, set at start */
     std::vector<std::string> Place;
@@ -315,6 +365,11 @@ public:
 
     static void DumpLocks();
 
+    TError GetWorkingSet(uint64_t &ws);
+    TError ReclaimMemory();
+    static void StartMemoryReclaimer();
+    static void StopMemoryReclaimer();
+
     TTuple Taint();
 
 
@@ -322,8 +377,21 @@ public:
     void SanitizeCapabilities();
 
     TError CheckMemGuarantee() const;
-    uint64_t GetTotalMemGuarantee(bool containers_locked = false) const;
-    uint64_t GetTotalMemLimit(const TContainer *base = nullptr) const;
+    uint64_t GetTotalMemGuarantee() const;
+    uint64_t GetTotalMemLimit() const;
+    uint64_t GetCpuGuarantee() const;
+    uint64_t GetCpuLimitSum() const;
+
+    /* Affinity by NUMA nodes and last level caches, under CpuAffinityMutex */
+    std::string GetCpuLayout() const;
+    TBitMap GetMemPolicyNodes() const;
+
+    /* Refresh subtree sums up to root after change of state, command,
+     * virt_mode, memory_limit or memory_guarantee, O(depth) */
+    void UpdateAggregates();
+
+    /* Same for cpu guarantee and limit after change of state or cpu limits */
+    void UpdateCpuAggregates();
 
     bool IsRoot() const { return !Level; }
     bool IsChildOf(const TContainer &ct) const;
@@ -331,6 +399,27 @@ public:
     std::list<std::shared_ptr<TContainer>> Subtree();
     std::list<std::shared_ptr<TContainer>> Childs();
 
+    /*
+     * Walks subtree with containers lock held, without allocations and
+     * reference counting. Pre-order visitor returns false to skip children
+     * and post-order visit. Levels limits depth below this, -1 - unlimited.
+     */
+    template <typename Pre, typename Post>
+    void WalkLocked(Pre &&pre, Post &&post, int levels = -1) {
+        if (!pre(*this))
+            return;
+        if (levels) {
+            for (auto &child: Children)
+                child->WalkLocked(pre, post, levels - 1);
+        }
+        post(*this);
+    }
+
+    template <typename Pre>
+    void WalkLocked(Pre &&pre, int levels = -1) {
+        WalkLocked(pre, [](TContainer &) {}, levels);
+    }
+
     std::shared_ptr<TContainer> GetParent() const;
 
     bool HasPidFor(const TContainer &ct) const;
@@ -75,6 +75,8 @@ TError TEpollLoop::AddSource(std::shared_ptr<TEpollSource> source) {
 
     struct epoll_event ev;
     ev.events = EPOLLIN | EPOLLHUP;
+    if (source->Flags & EPOLL_EVENT_PSI)
+        ev.events = EPOLLPRI;
     ev.data.fd = fd;
     if (epoll_ctl(EpollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
         return TError::System("epoll_add {}", fd);
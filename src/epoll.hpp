@@ -5,8 +5,11 @@
 
 #include "common.hpp"
 #include "util/locks.hpp"
+#include "util/path.hpp"
 
 constexpr int EPOLL_EVENT_OOM = 1;
+constexpr int EPOLL_EVENT_PSI = 2;
+constexpr int EPOLL_EVENT_KMSG = 4;
 
 class TContainer;
 class TEpollLoop;
@@ -23,6 +26,16 @@ public:
     TEpollSource() : Fd(-1), Flags(0), Container() {}
 };
 
+/* Pressure stall trigger, reported as event to async waiters */
+class TPressureSource : public TEpollSource {
+public:
+    TFile File;
+    std::string Event;
+
+    TPressureSource(std::weak_ptr<TContainer> container, const std::string &event) :
+        TEpollSource(-1, EPOLL_EVENT_PSI, container), Event(event) {}
+};
+
 class TEpollLoop : public TLockable, public TNonCopyable {
     int EpollFd = -1;
 
@@ -60,6 +60,9 @@ std::string TEvent::GetMsg() const {
             return "respawn";
         case EEventType::OOM:
             return "OOM";
+        case EEventType::OOMKill:
+            return "OOM kill of pid " + std::to_string(OomKill.Pid)
+                + " in memcg " + OomKill.Memcg;
         case EEventType::WaitTimeout:
             return "wait timeout";
         case EEventType::DestroyAgedContainer:
@@ -14,6 +14,7 @@ enum class EEventType {
     RotateLogs,
     Respawn,
     OOM,
+    OOMKill,
     WaitTimeout,
     DestroyAgedContainer,
     DestroyWeakContainer,
@@ -35,6 +36,13 @@ public:
         std::weak_ptr<TContainerWaiter> Waiter;
     } WaitTimeout;
 
+    struct {
+        std::string Memcg;
+        int Pid = 0;
+        std::string Comm;
+        uint64_t Time = 0;
+    } OomKill;
+
     uint64_t DueMs = 0;
 
     TEvent(EEventType type, std::shared_ptr<TContainer> container = nullptr) :
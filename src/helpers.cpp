@@ -1,55 +1,28 @@
 #include "helpers.hpp"
 #include "common.hpp"
+#include "config.hpp"
+#include "spawner.hpp"
 #include "util/path.hpp"
+#include "util/tree.hpp"
 #include "util/log.hpp"
 #include "util/unix.hpp"
 
 extern "C" {
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <linux/loop.h>
 }
 
-TError RunCommand(const std::vector<std::string> &command,
-                  const TFile &dir, const TFile &in, const TFile &out,
-                  const TCapabilities &caps) {
+/* Runs in forked child, never returns */
+void ExecHelper(const std::vector<std::string> &command, const TFile &dir,
+                const TFile &in, const TFile &out, const TFile &err,
+                const TCapabilities &caps) {
     TCgroup memcg = MemorySubsystem.Cgroup(PORTO_HELPERS_CGROUP);
-    TError error;
-    TFile err;
-    TTask task;
     TPath path = dir.RealPath();
-
-    if (!command.size())
-        return TError("External command is empty");
-
-    error = err.CreateUnnamed("/tmp", O_APPEND);
-    if (error)
-        return error;
-
-    std::string cmdline;
-
-    for (auto &arg : command)
-        cmdline += arg + " ";
-
-    L_ACT("Call helper: {} in {}", cmdline, path);
-
-    error = task.Fork();
-    if (error)
-        return error;
-
-    if (task.Pid) {
-        error = task.Wait();
-        if (error) {
-            std::string text;
-            TError error2 = err.ReadEnds(text, TError::MAX - 1024);
-            if (error2)
-                text = "Cannot read stderr: " + error2.ToString();
-            error = TError(error, "helper: {} stderr: {}", cmdline, text);
-        }
-        return error;
-    }
+    TError error;
 
     error = memcg.Attach(GetPid());
     if (error)
@@ -57,6 +30,9 @@ TError RunCommand(const std::vector<std::string> &command,
 
     SetDieOnParentExit(SIGKILL);
 
+    /* Own process group allows to kill helper together with its children */
+    (void)setsid();
+
     LogFile.Close();
     TFile::CloseAll({dir.Fd, in.Fd, out.Fd, err.Fd});
 
@@ -99,17 +75,129 @@ TError RunCommand(const std::vector<std::string> &command,
     _exit(2);
 }
 
+/* Collects stderr of helper until it closes pipe or deadline */
+static bool ReadHelperOutput(const TFile &pipe, uint64_t deadline, std::string &text) {
+    size_t max = TError::MAX - 1024;
+    uint64_t total = 0;
+    char buf[4096];
+
+    while (true) {
+        struct pollfd pfd = { pipe.Fd, POLLIN, 0 };
+        int timeout = -1;
+
+        if (deadline) {
+            uint64_t now = GetCurrentTimeMs();
+            timeout = deadline > now ? deadline - now : 0;
+        }
+
+        int ret = poll(&pfd, 1, timeout);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (!ret)
+            return false;
+
+        ssize_t len = read(pipe.Fd, buf, sizeof(buf));
+        if (len < 0 && (errno == EINTR || errno == EAGAIN))
+            continue;
+        if (len <= 0)
+            break;
+
+        /* keep head and tail */
+        text.append(buf, len);
+        total += len;
+        if (text.size() > max)
+            text.erase(max / 2, text.size() - max);
+    }
+
+    if (total > text.size())
+        text.insert(max / 2, fmt::format("\n--cut {}--\n", StringFormatSize(total)));
+
+    return true;
+}
+
+TError RunCommand(const std::vector<std::string> &command,
+                  const TFile &dir, const TFile &in, const TFile &out,
+                  const TCapabilities &caps) {
+    uint64_t timeout = config().daemon().helpers_timeout_s() * 1000;
+    uint64_t deadline = timeout ? GetCurrentTimeMs() + timeout : 0;
+    TUnixSocket status;
+    TFile err, output;
+    bool timedOut = false;
+    TError error;
+    TTask task;
+    int pfd[2];
+
+    if (!command.size())
+        return TError("External command is empty");
+
+    if (pipe2(pfd, O_CLOEXEC))
+        return TError::System("pipe2");
+
+    output.SetFd = pfd[0];
+    err.SetFd = pfd[1];
+
+    std::string cmdline;
+
+    for (auto &arg : command)
+        cmdline += arg + " ";
+
+    L_ACT("Call helper: {} in {}", cmdline, dir.RealPath());
+
+    if (TSpawner::Running()) {
+        error = TSpawner::SpawnHelper(command, dir, in, out, err, caps,
+                                      task.Pid, status);
+        if (error)
+            return error;
+    } else {
+        error = task.Fork();
+        if (error)
+            return error;
+
+        if (!task.Pid)
+            ExecHelper(command, dir, in, out, err, caps);
+    }
+
+    err.Close();
+
+    std::string text;
+    if (!ReadHelperOutput(output, deadline, text)) {
+        L_WRN("Kill helper {} after {} s: {}", task.Pid, timeout / 1000, cmdline);
+        (void)kill(-task.Pid, SIGKILL);
+        (void)task.Kill(SIGKILL);
+        timedOut = true;
+    }
+
+    if (status.GetFd() >= 0)
+        error = TSpawner::WaitTask(status);
+    else
+        error = task.Wait();
+
+    if (timedOut)
+        error = TError(EError::Unknown, ETIMEDOUT, "timeout {} s", timeout / 1000);
+
+    if (error)
+        error = TError(error, "helper: {} stderr: {}", cmdline, text);
+
+    return error;
+}
+
 TError CopyRecursive(const TPath &src, const TPath &dst) {
+    TFile srcDir, dstDir;
     TError error;
-    TFile dir;
 
-    error = dir.OpenDir(dst);
+    error = srcDir.OpenDirStrict(src);
     if (error)
         return error;
 
-    return RunCommand({ "cp", "--archive", "--force",
-                        "--one-file-system", "--no-target-directory",
-                        src.ToString(), "." }, dir);
+    error = dstDir.OpenDir(dst);
+    if (error)
+        return error;
+
+    error = CopyTree(srcDir, dstDir, config().volumes().tree_threads());
+    if (error)
+        return TError(error, "Cannot copy {} to {}", src, dst);
+
+    return OK;
 }
 
 TError ClearRecursive(const TPath &path) {
@@ -120,16 +208,25 @@ TError ClearRecursive(const TPath &path) {
     if (error)
         return error;
 
-    return RunCommand({ "find", ".", "-xdev", "-mindepth", "1", "-delete"}, dir);
+    error = ClearTree(dir, config().volumes().tree_threads());
+    if (error)
+        return TError(error, "Cannot clear {}", path);
+
+    return OK;
 }
 
 TError RemoveRecursive(const TPath &path) {
+    TPath normal = path.NormalPath();
     TError error;
     TFile dir;
 
-    error = dir.OpenDir(path.NormalPath().DirName());
+    error = dir.OpenDir(normal.DirName());
     if (error)
         return error;
 
-    return RunCommand({"rm", "-rf", "--one-file-system", "--", path.ToString()}, dir);
+    error = RemoveTree(dir, normal.BaseName(), config().volumes().tree_threads());
+    if (error && error.Errno != ENOENT)
+        return TError(error, "Cannot remove {}", path);
+
+    return OK;
 }
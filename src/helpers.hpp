@@ -8,6 +8,9 @@ TError RunCommand(const std::vector<std::string> &command,
                   const TFile &input = TFile(),
                   const TFile &output = TFile(),
                   const TCapabilities &caps = HelperCapabilities);
+void ExecHelper(const std::vector<std::string> &command, const TFile &dir,
+                const TFile &in, const TFile &out, const TFile &err,
+                const TCapabilities &caps);
 TError CopyRecursive(const TPath &src, const TPath &dst);
 TError ClearRecursive(const TPath &path);
 TError RemoveRecursive(const TPath &path);
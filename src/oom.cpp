@@ -0,0 +1,237 @@
+#include "oom.hpp"
+#include "portod.hpp"
+#include "container.hpp"
+#include "cgroup.hpp"
+#include "config.hpp"
+#include "epoll.hpp"
+#include "event.hpp"
+#include "util/log.hpp"
+#include "util/string.hpp"
+#include "util/unix.hpp"
+
+extern "C" {
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+}
+
+/* Eventfd notification and kernel log message of the same OOM */
+#define OOM_MATCH_DELAY_MS  10000
+
+static TFile Kmsg;
+static std::shared_ptr<TEpollSource> KmsgSource;
+
+/* Kernels before 4.19 report memcg and victim in separate lines */
+static std::string PendingMemcg;
+
+static void TrimHistory(std::deque<TOomRecord> &records) {
+    while (records.size() > config().container().oom_history_size())
+        records.pop_front();
+}
+
+void TOomHistory::Add(const TOomRecord &record) {
+    auto lock = std::unique_lock<std::mutex>(Mutex);
+
+    /* Victim could be reported earlier than eventfd is read */
+    for (auto it = Records.rbegin(); it != Records.rend(); ++it) {
+        if (it->Time + OOM_MATCH_DELAY_MS < record.Time)
+            break;
+        if (it->Pid && !it->Usage) {
+            it->Usage = record.Usage;
+            it->Limit = record.Limit;
+            return;
+        }
+    }
+
+    Records.push_back(record);
+    TrimHistory(Records);
+}
+
+void TOomHistory::AddVictim(const TOomRecord &record) {
+    auto lock = std::unique_lock<std::mutex>(Mutex);
+
+    for (auto it = Records.rbegin(); it != Records.rend(); ++it) {
+        if (it->Time + OOM_MATCH_DELAY_MS < record.Time)
+            break;
+        if (!it->Pid) {
+            it->Pid = record.Pid;
+            it->Comm = record.Comm;
+            return;
+        }
+    }
+
+    Records.push_back(record);
+    TrimHistory(Records);
+}
+
+std::string TOomHistory::Format() const {
+    auto lock = std::unique_lock<std::mutex>(Mutex);
+    std::string result;
+
+    for (auto &rec: Records) {
+        if (result.size())
+            result += "; ";
+        result += fmt::format("{}.{:03} pid={} comm={} usage={} limit={}",
+                              FormatTime(rec.Time / 1000), rec.Time % 1000,
+                              rec.Pid, rec.Comm, rec.Usage, rec.Limit);
+    }
+
+    return result;
+}
+
+static std::shared_ptr<TContainer> FindMemoryCgroup(const std::string &name) {
+    auto lock = LockContainers();
+
+    for (auto &it: Containers) {
+        auto &ct = it.second;
+        if ((ct->IsRoot() || (ct->Controllers & CGROUP_MEMORY)) &&
+                ct->GetCgroup(MemorySubsystem).Name == name)
+            return ct;
+    }
+
+    return nullptr;
+}
+
+void TOomMonitor::ReportVictim(const TEvent &event) {
+    auto &kill = event.OomKill;
+
+    auto ct = FindMemoryCgroup(kill.Memcg);
+    if (!ct) {
+        L_VERBOSE("OOM killed {} {} in unknown memcg {}", kill.Pid, kill.Comm, kill.Memcg);
+        return;
+    }
+
+    L_EVT("OOM killed {} {} in CT{}:{}", kill.Pid, kill.Comm, ct->Id, ct->Name);
+
+    TOomRecord record;
+    record.Time = kill.Time;
+    record.Pid = kill.Pid;
+    record.Comm = kill.Comm;
+    ct->OomHistory.AddVictim(record);
+}
+
+/* Epoll loop must not scan containers, resolve memcg in event worker */
+static void QueueVictim(const std::string &memcg, pid_t pid, const std::string &comm) {
+    TEvent event(EEventType::OOMKill);
+    event.OomKill.Memcg = memcg;
+    event.OomKill.Pid = pid;
+    event.OomKill.Comm = comm;
+    event.OomKill.Time = GetCurrentTimeMs();
+    EventQueue->Add(0, event);
+}
+
+/*
+ * 4.19+: "oom-kill:constraint=..,oom_memcg=<cg>,task_memcg=<cg>,task=<comm>,pid=<pid>,uid=<uid>"
+ * older: "Task in <cg> killed as a result of limit of <cg>"
+ *        "... Killed process <pid> (<comm>) ..."
+ */
+static void ParseMessage(const std::string &msg) {
+    if (StringStartsWith(msg, "oom-kill:")) {
+        std::string memcg, comm;
+        int pid = 0;
+
+        for (auto &kv: SplitString(msg.substr(9), ',')) {
+            auto sep = kv.find('=');
+            if (sep == std::string::npos)
+                continue;
+            auto key = kv.substr(0, sep);
+            auto val = kv.substr(sep + 1);
+            if (key == "oom_memcg")
+                memcg = val;
+            else if (key == "task")
+                comm = val;
+            else if (key == "pid")
+                (void)StringToInt(val, pid);
+        }
+
+        PendingMemcg.clear();
+        if (pid && memcg.size())
+            QueueVictim(memcg, pid, comm);
+        return;
+    }
+
+    const std::string limit_of = " killed as a result of limit of ";
+    auto pos = msg.find(limit_of);
+    if (StringStartsWith(msg, "Task in ") && pos != std::string::npos) {
+        PendingMemcg = msg.substr(pos + limit_of.size());
+        return;
+    }
+
+    const std::string killed = "Killed process ";
+    pos = msg.find(killed);
+    if (pos != std::string::npos && PendingMemcg.size()) {
+        auto words = SplitString(msg.substr(pos + killed.size()), ' ');
+        int pid = 0;
+
+        if (words.size() > 1 && !StringToInt(words[0], pid)) {
+            std::string comm = words[1];
+            if (comm.size() > 2 && comm.front() == '(' && comm.back() == ')')
+                comm = comm.substr(1, comm.size() - 2);
+            QueueVictim(PendingMemcg, pid, comm);
+        }
+
+        PendingMemcg.clear();
+    }
+}
+
+TError TOomMonitor::Start() {
+    TError error;
+
+    error = Kmsg.Open("/dev/kmsg", O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (error)
+        return error;
+
+    /* Skip messages before start */
+    if (lseek(Kmsg.Fd, 0, SEEK_END) < 0) {
+        error = TError::System("lseek /dev/kmsg");
+        Kmsg.Close();
+        return error;
+    }
+
+    KmsgSource = std::make_shared<TEpollSource>(Kmsg.Fd, EPOLL_EVENT_KMSG,
+                                                std::weak_ptr<TContainer>());
+    error = EpollLoop->AddSource(KmsgSource);
+    if (error) {
+        KmsgSource = nullptr;
+        Kmsg.Close();
+    }
+
+    return error;
+}
+
+void TOomMonitor::Stop() {
+    if (KmsgSource)
+        EpollLoop->RemoveSource(KmsgSource->Fd);
+    KmsgSource = nullptr;
+    Kmsg.Close();
+}
+
+/* Each read returns one record: "<prio>,<seq>,<usec>,<flags>;<message>\n" */
+void TOomMonitor::Recv(int fd) {
+    char buf[8192];
+
+    while (true) {
+        ssize_t len = read(fd, buf, sizeof(buf) - 1);
+        if (len < 0) {
+            /* Record was overwritten in ring buffer */
+            if (errno == EPIPE || errno == EINTR)
+                continue;
+            break;
+        }
+        if (!len)
+            break;
+
+        buf[len] = 0;
+
+        char *msg = strchr(buf, ';');
+        if (!msg)
+            continue;
+        msg++;
+
+        char *end = strchr(msg, '\n');
+        if (end)
+            *end = 0;
+
+        ParseMessage(msg);
+    }
+}
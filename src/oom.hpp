@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <mutex>
+
+#include "util/error.hpp"
+
+class TEvent;
+
+/* OOM in container memory cgroup */
+struct TOomRecord {
+    uint64_t Time = 0;      /* ms since epoch */
+    pid_t Pid = 0;          /* victim, zero if unknown or nothing killed */
+    std::string Comm;
+    uint64_t Usage = 0;     /* memory usage at event */
+    uint64_t Limit = 0;
+};
+
+/* Bounded history of recent OOMs, size is container.oom_history_size */
+class TOomHistory {
+    mutable std::mutex Mutex;
+    std::deque<TOomRecord> Records;
+
+public:
+    void Add(const TOomRecord &record);
+
+    /* Attaches victim to recent record without one or adds new record */
+    void AddVictim(const TOomRecord &record);
+
+    std::string Format() const;
+};
+
+/*
+ * OOM killer reports victims only into kernel log:
+ * read /dev/kmsg in the epoll loop and queue OOMKill events,
+ * event worker finds container by memory cgroup and attaches victim.
+ */
+class TOomMonitor {
+public:
+    static TError Start();
+    static void Stop();
+    static void Recv(int fd);
+
+    /* Attaches victim from kernel log to container, in event worker */
+    static void ReportVictim(const TEvent &event);
+};
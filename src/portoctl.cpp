@@ -4,8 +4,12 @@
 #include <algorithm>
 #include <csignal>
 #include <cmath>
+#include <chrono>
+#include <mutex>
+#include <thread>
 
 #include "libporto.hpp"
+#include "rpc.pb.h"
 #include "cli.hpp"
 #include "volume.hpp"
 #include "util/string.hpp"
@@ -13,6 +17,8 @@
 #include "util/unix.hpp"
 #include "util/cred.hpp"
 
+#include <google/protobuf/io/coded_stream.h>
+
 extern "C" {
 #include <unistd.h>
 #include <sys/types.h>
@@ -2742,6 +2748,168 @@ public:
     }
 };
 
+class TReplayCmd final : public ICmd {
+    struct TClientTrace {
+        std::vector<const rpc::TRequestRecord *> Records;
+    };
+
+    std::vector<rpc::TRequestRecord> Records;
+    std::mutex Mutex;
+    std::vector<uint64_t> Latency;      /* us */
+    uint64_t Failed = 0;
+    uint64_t Differ = 0;
+
+    TError ReadJournal(const std::string &path) {
+        std::string data;
+
+        TError error = TPath(path).ReadAll(data, 1ull << 32);
+        if (error)
+            return error;
+
+        const uint8_t *buf = (const uint8_t *)data.data();
+        size_t off = 0;
+
+        while (off < data.size()) {
+            google::protobuf::io::CodedInputStream input(buf + off, data.size() - off);
+            uint32_t len;
+
+            if (!input.ReadVarint32(&len))
+                return TError("Truncated record at {} in {}", off, path);
+            off += google::protobuf::io::CodedOutputStream::VarintSize32(len);
+            if (len > data.size() - off)
+                return TError("Truncated record at {} in {}", off, path);
+
+            rpc::TRequestRecord record;
+            if (!record.ParseFromArray(buf + off, len))
+                return TError("Cannot parse record at {} in {}", off, path);
+            off += len;
+
+            Records.push_back(record);
+        }
+
+        return OK;
+    }
+
+    void Replay(const TClientTrace &trace, uint64_t origin, double speed,
+                std::chrono::steady_clock::time_point start) {
+        Porto::Connection api;
+
+        for (auto rec: trace.Records) {
+            if (speed > 0) {
+                auto delay = std::chrono::microseconds(
+                        (uint64_t)((rec->queue_time() - origin) * 1000 / speed));
+                std::this_thread::sleep_until(start + delay);
+            }
+
+            rpc::TContainerResponse rsp;
+            auto begin = std::chrono::steady_clock::now();
+            int ret = api.Rpc(rec->request(), rsp);
+            auto end = std::chrono::steady_clock::now();
+
+            auto lock = std::unique_lock<std::mutex>(Mutex);
+            Latency.push_back(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
+            if (ret)
+                Failed++;
+            /* queued waits are journaled before result is known */
+            if (ret != rec->error() && rec->error() != rpc::EError::Queued)
+                Differ++;
+        }
+    }
+
+    static void PrintLatency(const char *title, std::vector<uint64_t> &lat) {
+        if (lat.empty())
+            return;
+
+        std::sort(lat.begin(), lat.end());
+
+        uint64_t sum = 0;
+        for (auto val: lat)
+            sum += val;
+
+        auto pct = [&](int p) { return lat[(lat.size() - 1) * p / 100] / 1000.; };
+
+        fmt::print("{:<8} avg {:.3f} p50 {:.3f} p90 {:.3f} p99 {:.3f} max {:.3f} ms\n",
+                   title, sum / lat.size() / 1000., pct(50), pct(90), pct(99),
+                   lat.back() / 1000.);
+    }
+
+public:
+    TReplayCmd(Porto::Connection *api) : ICmd(api, "replay", 1,
+            "[-s <speed>] <journal> [journal...]",
+            "replay requests from portod request journal",
+            "    -s <speed>    speed factor: 1 - original, 0 - without delays, default: 1\n"
+            "\n"
+            "Journal is written by portod if daemon.request_journal is set in portod.conf,\n"
+            "pass <journal>.old first to replay both files. Requests from each client are\n"
+            "replayed sequentially in own connection, async waits are skipped.\n"
+            ) {}
+
+    int Execute(TCommandEnviroment *env) final override {
+        double speed = 1;
+        const auto &args = env->GetOpts({
+            { 's', true, [&](const char *arg) { speed = std::stod(arg); } },
+        });
+
+        if (args.empty() || speed < 0) {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+
+        for (auto &path: args) {
+            TError error = ReadJournal(path);
+            if (error) {
+                PrintError(error, "Cannot read journal");
+                return EXIT_FAILURE;
+            }
+        }
+
+        if (Records.empty())
+            return 0;
+
+        std::map<std::string, TClientTrace> clients;
+        std::vector<uint64_t> journal;
+        uint64_t skipped = 0;
+
+        std::stable_sort(Records.begin(), Records.end(),
+                [](const rpc::TRequestRecord &a, const rpc::TRequestRecord &b) {
+                    return a.queue_time() < b.queue_time();
+                });
+
+        for (auto &rec: Records) {
+            /* response would come later into the same connection */
+            if (rec.request().has_asyncwait()) {
+                skipped++;
+                continue;
+            }
+            clients[rec.client()].Records.push_back(&rec);
+            journal.push_back((rec.finish_time() - rec.queue_time()) * 1000);
+        }
+
+        uint64_t origin = Records.front().queue_time();
+        uint64_t duration = Records.back().finish_time() - origin;
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+        for (auto &it: clients)
+            threads.emplace_back(&TReplayCmd::Replay, this, std::cref(it.second),
+                                 origin, speed, start);
+        for (auto &thread: threads)
+            thread.join();
+
+        auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+
+        fmt::print("requests {} clients {} skipped {} failed {} differ {}\n",
+                   Latency.size(), clients.size(), skipped, Failed, Differ);
+        fmt::print("time     {} ms journal {} ms\n", time, duration);
+        PrintLatency("replay", Latency);
+        PrintLatency("journal", journal);
+        fflush(stdout);
+
+        return 0;
+    }
+};
+
 int main(int argc, char *argv[]) {
     Porto::Connection api;
     TCommandHandler handler(api);
@@ -2781,6 +2949,7 @@ int main(int argc, char *argv[]) {
 
     handler.RegisterCommand<TConvertPathCmd>();
     handler.RegisterCommand<TAttachCmd>();
+    handler.RegisterCommand<TReplayCmd>();
 
     int ret = handler.HandleCommand(argc, argv);
     if (ret < 0) {
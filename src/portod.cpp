@@ -18,6 +18,8 @@
 #include "storage.hpp"
 #include "helpers.hpp"
 #include "core.hpp"
+#include "spawner.hpp"
+#include "oom.hpp"
 #include "util/log.hpp"
 #include "util/signal.hpp"
 #include "util/unix.hpp"
@@ -69,6 +71,7 @@ static uint64_t ShutdownDeadline = 0;
 
 static void FatalError(const std::string &text, TError &error) {
     L_ERR("{}: {}", text, error);
+    FlushLog();
     _exit(EXIT_FAILURE);
 }
 
@@ -359,6 +362,10 @@ static void PortodServer() {
         return;
     }
 
+    error = TOomMonitor::Start();
+    if (error)
+        L_WRN("Cannot watch kernel log for OOM victims: {}", error);
+
     StartRpcQueue();
     EventQueue->Start();
 
@@ -448,6 +455,18 @@ static void PortodServer() {
                     EventQueue->Add(0, e);
                 }
 
+            } else if (source->Flags & EPOLL_EVENT_KMSG) {
+                TOomMonitor::Recv(source->Fd);
+
+            } else if (source->Flags & EPOLL_EVENT_PSI) {
+                auto container = source->Container.lock();
+
+                if (!container) {
+                    L_WRN("Container not found for pressure fd {}", source->Fd);
+                    EpollLoop->StopInput(source->Fd);
+                } else
+                    container->ReportPressure(std::static_pointer_cast<TPressureSource>(source)->Event);
+
             } else if (Clients.find(source->Fd) != Clients.end()) {
                 auto client = Clients[source->Fd];
                 error = client->Event(ev.events);
@@ -479,6 +498,8 @@ exit:
         c.second->CloseConnection();
     Clients.clear();
 
+    TOomMonitor::Stop();
+
     L_SYS("Stop threads...");
     EventQueue->Stop();
     StopRpcQueue();
@@ -804,6 +825,14 @@ static int Portod() {
             L_SYS("Cannot mount tracefs: {}", error);
     }
 
+    /* Fork spawner while we are still small and single-threaded */
+    error = TSpawner::Start();
+    if (error)
+        L_ERR("Cannot start spawner: {}", error);
+
+    /* Log writer is the first thread, spawner must not inherit its locks */
+    StartLogWriter(config().log().buffer_size(), config().log().flush_ms());
+
     EpollLoop = std::unique_ptr<TEpollLoop>(new TEpollLoop());
     EventQueue = std::unique_ptr<TEventQueue>(new TEventQueue());
 
@@ -836,6 +865,11 @@ static int Portod() {
     L_SYS("Restore volumes...");
     TVolume::RestoreAll();
 
+    TStorage::StartReclaimer();
+    TVolume::StartLoopPool();
+    TVolume::StartStatCollector();
+    TContainer::StartMemoryReclaimer();
+
     DestroyContainers(true);
 
     if (DiscardState) {
@@ -898,6 +932,11 @@ static int Portod() {
             L_ERR("Can't destroy volume key-value storage: {}", error);
     }
 
+    TStorage::StopReclaimer();
+    TContainer::StopMemoryReclaimer();
+    TVolume::StopStatCollector();
+    TVolume::StopLoopPool();
+
     PortodPidFile.Remove();
 
     L_SYS("Shutdown complete. time={} ms", GetCurrentTimeMs() - ShutdownStart);
@@ -1046,7 +1085,9 @@ static void SpawnPortod(std::shared_ptr<TEpollLoop> loop) {
         close(ackfd[1]);
         close(sigFd);
 
-        _exit(Portod());
+        int ret = Portod();
+        StopLogWriter();
+        _exit(ret);
     }
 
     close(evtfd[0]);
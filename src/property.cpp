@@ -5,6 +5,7 @@
 #include "client.hpp"
 #include "container.hpp"
 #include "volume.hpp"
+#include "storage.hpp"
 #include "network.hpp"
 #include "util/log.hpp"
 #include "util/string.hpp"
@@ -504,11 +505,13 @@ public:
             return error;
 
         CT->NewMemGuarantee = new_val;
+        CT->UpdateAggregates();
 
         if (CT->State != EContainerState::Stopped) {
             error = CT->CheckMemGuarantee();
             if (error) {
                 CT->NewMemGuarantee = CT->MemGuarantee;
+                CT->UpdateAggregates();
                 return error;
             }
         }
@@ -549,11 +552,14 @@ public:
     TError Set(const std::string &command) {
         CT->Command = command;
         CT->SetProp(EProperty::COMMAND);
+        CT->UpdateAggregates();
         return OK;
     }
     TError Start(void) {
-        if (CT->OsMode && !CT->HasProp(EProperty::COMMAND))
+        if (CT->OsMode && !CT->HasProp(EProperty::COMMAND)) {
             CT->Command = "/sbin/init";
+            CT->UpdateAggregates();
+        }
         return OK;
     }
 } static Command;
@@ -600,6 +606,7 @@ public:
         } else
             return TError(EError::InvalidValue, "Unknown: {}", value);
         CT->SetProp(EProperty::VIRT_MODE);
+        CT->UpdateAggregates();
         return OK;
     }
 } static VirtMode;
@@ -1523,6 +1530,7 @@ public:
         if (CT->MemLimit != new_size) {
             CT->MemLimit = new_size;
             CT->SetProp(EProperty::MEM_LIMIT);
+            CT->UpdateAggregates();
         }
         return OK;
     }
@@ -1708,8 +1716,9 @@ public:
         IsReadOnly = true;
     }
     TError Get(std::string &value) {
-        if (CT->CpuLimitSum)
-            value = CpuPowerToString(CT->CpuLimitSum);
+        uint64_t sum = CT->GetCpuLimitSum();
+        if (sum)
+            value = CpuPowerToString(sum);
         return OK;
     }
 } static CpuLimitTotal;
@@ -1747,8 +1756,9 @@ public:
         IsReadOnly = true;
     }
     TError Get(std::string &value) {
-        if (CT->CpuGuarantee || CT->CpuGuaranteeSum)
-            value = CpuPowerToString(std::max(CT->CpuGuarantee, CT->CpuGuaranteeSum));
+        uint64_t guarantee = CT->GetCpuGuarantee();
+        if (guarantee)
+            value = CpuPowerToString(guarantee);
         return OK;
     }
 } static CpuGuaranteeTotal;
@@ -1910,6 +1920,133 @@ public:
     }
 } static CpuSetAffinity;
 
+class TCpuSetLayout : public TProperty {
+public:
+    TCpuSetLayout() : TProperty(P_CPU_SET_LAYOUT, EProperty::NONE,
+            "Resulting CPU affinity by NUMA nodes and caches: node N cache [N,N-M,]...: [N,N-M,]...;...") {
+        IsReadOnly = true;
+    }
+    TError Get(std::string &value) {
+        auto lock = LockCpuAffinity();
+        value = CT->GetCpuLayout();
+        return OK;
+    }
+} static CpuSetLayout;
+
+class TMemNodes : public TProperty {
+public:
+    TMemNodes() : TProperty(P_MEM_NODES, EProperty::MEM_NODES,
+            "NUMA memory nodes: [N|N-M,]... | node N")
+    {
+        IsDynamic = true;
+        RequireControllers = CGROUP_CPUSET;
+    }
+    TError Get(std::string &value) {
+        auto lock = LockCpuAffinity();
+        value = CT->MemNodes.Format();
+        return OK;
+    }
+    TError Set(const std::string &value) {
+        auto cfg = SplitEscapedString(value, ' ');
+        TBitMap map;
+        TError error;
+
+        if (cfg.size() == 2 && cfg[0] == "node")
+            error = map.Parse(cfg[1]);
+        else if (cfg.size() == 1 && cfg[0] != "all")
+            error = map.Parse(cfg[0]);
+        else if (cfg.size() > 1)
+            return TError(EError::InvalidValue, "wrong format");
+        if (error)
+            return error;
+
+        auto lock = LockCpuAffinity();
+        if (!CT->MemNodes.IsEqual(map)) {
+            CT->MemNodes.Clear();
+            CT->MemNodes.Set(map);
+            CT->SetProp(EProperty::MEM_NODES);
+        }
+        return OK;
+    }
+} static MemNodes;
+
+class TNumaPolicy : public TProperty {
+public:
+    TNumaPolicy() : TProperty(P_NUMA_POLICY, EProperty::NUMA_POLICY,
+            "NUMA memory policy: default|bind|preferred|interleave")
+    {
+    }
+    TError Get(std::string &value) {
+        switch (CT->NumaPolicy) {
+        case ENumaPolicy::Default:
+            value = "default";
+            break;
+        case ENumaPolicy::Bind:
+            value = "bind";
+            break;
+        case ENumaPolicy::Preferred:
+            value = "preferred";
+            break;
+        case ENumaPolicy::Interleave:
+            value = "interleave";
+            break;
+        }
+        return OK;
+    }
+    TError Set(const std::string &value) {
+        ENumaPolicy policy;
+
+        if (value == "" || value == "default")
+            policy = ENumaPolicy::Default;
+        else if (value == "bind")
+            policy = ENumaPolicy::Bind;
+        else if (value == "preferred")
+            policy = ENumaPolicy::Preferred;
+        else if (value == "interleave")
+            policy = ENumaPolicy::Interleave;
+        else
+            return TError(EError::InvalidValue, "unknown numa policy: {}", value);
+
+        auto lock = LockCpuAffinity();
+        CT->NumaPolicy = policy;
+        CT->SetProp(EProperty::NUMA_POLICY);
+        return OK;
+    }
+} static NumaPolicy;
+
+class TNumaUsage : public TProperty {
+public:
+    TNumaUsage() : TProperty(P_NUMA_USAGE, EProperty::NONE,
+            "Memory usage by NUMA nodes: <node>: <bytes>;...")
+    {
+        IsReadOnly = true;
+        IsRuntimeOnly = true;
+        RequireControllers = CGROUP_MEMORY;
+    }
+    void Init(void) {
+        IsSupported = MemorySubsystem.RootCgroup().Has(MemorySubsystem.NUMA_STAT);
+    }
+    TError Get(std::string &value) {
+        auto cg = CT->GetCgroup(MemorySubsystem);
+        TUintMap usage;
+        TError error = MemorySubsystem.GetNumaUsage(cg, usage);
+        if (error)
+            return error;
+        return UintMapToString(usage, value);
+    }
+    TError GetIndexed(const std::string &index, std::string &value) {
+        auto cg = CT->GetCgroup(MemorySubsystem);
+        TUintMap usage;
+        TError error = MemorySubsystem.GetNumaUsage(cg, usage);
+        if (error)
+            return error;
+        if (!usage.count(index))
+            return TError(EError::InvalidValue, "invalid index " + index);
+        value = std::to_string(usage[index]);
+        return OK;
+    }
+} static NumaUsage;
+
 class TIoLimit : public TProperty {
 public:
     TIoLimit(std::string name, EProperty prop, std::string desc) :
@@ -2368,6 +2505,54 @@ public:
     }
 } static OomKills;
 
+class TOomHistoryProperty : public TProperty {
+public:
+    TOomHistoryProperty() : TProperty(P_OOM_HISTORY, EProperty::NONE,
+            "Recent OOMs: <time> pid=<victim> comm=<name> usage=<bytes> limit=<bytes>;...")
+    {
+        IsReadOnly = true;
+    }
+    TError Get(std::string &value) {
+        value = CT->OomHistory.Format();
+        return OK;
+    }
+} static OomHistoryProperty;
+
+class TMemoryEvents : public TProperty {
+public:
+    TMemoryEvents() : TProperty(P_MEMORY_EVENTS, EProperty::NONE,
+            "Memory events: max|oom|oom_kill: <count>;...")
+    {
+        IsReadOnly = true;
+        IsRuntimeOnly = true;
+        RequireControllers = CGROUP_MEMORY;
+    }
+    TError GetMap(TUintMap &events) {
+        auto cg = CT->GetCgroup(MemorySubsystem);
+        TError error = MemorySubsystem.GetEvents(cg, events);
+        if (!error && !events.count("oom"))
+            events["oom"] = CT->OomEvents;
+        return error;
+    }
+    TError Get(std::string &value) {
+        TUintMap events;
+        TError error = GetMap(events);
+        if (error)
+            return error;
+        return UintMapToString(events, value);
+    }
+    TError GetIndexed(const std::string &index, std::string &value) {
+        TUintMap events;
+        TError error = GetMap(events);
+        if (error)
+            return error;
+        if (!events.count(index))
+            return TError(EError::InvalidValue, "invalid index " + index);
+        value = std::to_string(events[index]);
+        return OK;
+    }
+} static MemoryEvents;
+
 class TCoreDumped : public TProperty {
 public:
     TCoreDumped() : TProperty(P_CORE_DUMPED, EProperty::NONE,
@@ -2521,6 +2706,58 @@ public:
     }
 } static MemUsage;
 
+class TProactiveReclaim : public TProperty {
+public:
+    TProactiveReclaim() : TProperty(P_PROACTIVE_RECLAIM, EProperty::PROACTIVE_RECLAIM,
+            "Reclaim share of cold memory above working set every memory_reclaim_ms: 0..100 [%] (dynamic)")
+    {
+        IsDynamic = true;
+        RequireControllers = CGROUP_MEMORY;
+    }
+    void Init(void) {
+        IsSupported = config().container().memory_reclaim_ms() != 0;
+    }
+    TError Get(std::string &value) {
+        value = std::to_string(CT->ProactiveReclaim);
+        return OK;
+    }
+    TError Set(const std::string &value) {
+        std::string str = value;
+        uint64_t val;
+
+        if (str.size() && str.back() == '%')
+            str.pop_back();
+
+        TError error = StringToUint64(str, val);
+        if (error)
+            return error;
+        if (val > 100)
+            return TError(EError::InvalidValue, "out of range");
+
+        CT->ProactiveReclaim = val;
+        CT->SetProp(EProperty::PROACTIVE_RECLAIM);
+        return OK;
+    }
+} static ProactiveReclaim;
+
+class TWorkingSet : public TProperty {
+public:
+    TWorkingSet() : TProperty(P_WORKING_SET, EProperty::NONE,
+            "Estimated working set: recently active and unevictable memory [bytes] (ro)")
+    {
+        IsReadOnly = true;
+        IsRuntimeOnly = true;
+        RequireControllers = CGROUP_MEMORY;
+    }
+    TError Get(std::string &value) {
+        uint64_t val;
+        TError error = CT->GetWorkingSet(val);
+        if (!error)
+            value = std::to_string(val);
+        return error;
+    }
+} static WorkingSet;
+
 class TMemReclaimed : public TProperty {
 public:
     TMemReclaimed() : TProperty(P_MEMORY_RECLAIMED, EProperty::NONE,
@@ -2755,6 +2992,111 @@ public:
     }
 } static CpuWait;
 
+class TPressure : public TProperty {
+public:
+    const std::string Resource;
+    TPressure(std::string name, std::string resource) :
+        TProperty(name, EProperty::NONE,
+                  "Pressure stall information for " + resource +
+                  ": some avg10=<%> avg60=<%> avg300=<%> total=<us>; full ..."),
+        Resource(resource)
+    {
+        IsReadOnly = true;
+        IsRuntimeOnly = true;
+        RequireControllers = CGROUP_CPUACCT;
+    }
+    void Init(void) {
+        IsSupported = CpuacctSubsystem.Supported &&
+            TPath("/proc/pressure/" + Resource).Exists();
+    }
+    TError Get(std::string &value) {
+        auto cg = CT->GetCgroup(CpuacctSubsystem);
+        return CpuacctSubsystem.GetPressure(cg, Resource, value);
+    }
+    TError GetIndexed(const std::string &index, std::string &value) {
+        std::string text;
+        TError error = Get(text);
+        if (error)
+            return error;
+        for (auto &line: SplitString(text, ';')) {
+            line = StringTrim(line);
+            if (StringStartsWith(line, index + " ")) {
+                value = line.substr(index.size() + 1);
+                return OK;
+            }
+        }
+        return TError(EError::InvalidValue, "invalid index " + index);
+    }
+};
+
+static TPressure CpuPressure(P_CPU_PRESSURE, "cpu");
+static TPressure MemoryPressure(P_MEMORY_PRESSURE, "memory");
+static TPressure IoPressure(P_IO_PRESSURE, "io");
+
+class TPressureTriggerProperty : public TProperty {
+public:
+    TPressureTriggerProperty() : TProperty(P_PRESSURE_TRIGGER, EProperty::PRESSURE_TRIGGER,
+            "Report pressure events to async wait: cpu|memory|io some|full <stall> <window>;...")
+    {
+        IsDynamic = true;
+        RequireControllers = CGROUP_CPUACCT;
+    }
+    void Init(void) {
+        IsSupported = CpuacctSubsystem.Supported &&
+            TPath("/proc/pressure").Exists();
+    }
+    TError Get(std::string &value) {
+        value = "";
+        for (auto &trigger: CT->PressureTriggers) {
+            if (value.size())
+                value += "; ";
+            value += fmt::format("{} {} {}us {}us", trigger.Resource, trigger.Type,
+                                 trigger.Stall, trigger.Window);
+        }
+        return OK;
+    }
+    TError Set(const std::string &value) {
+        std::vector<TPressureTrigger> triggers;
+        TError error;
+
+        for (auto &line: SplitEscapedString(value, ' ', ';')) {
+            if (line.empty())
+                continue;
+            if (line.size() != 4)
+                return TError(EError::InvalidValue, "wrong format");
+
+            TPressureTrigger trigger;
+            uint64_t stall, window;
+
+            trigger.Resource = line[0];
+            if (trigger.Resource != "cpu" && trigger.Resource != "memory" &&
+                    trigger.Resource != "io")
+                return TError(EError::InvalidValue, "unknown resource: {}", line[0]);
+
+            trigger.Type = line[1];
+            if (trigger.Type != "some" && trigger.Type != "full")
+                return TError(EError::InvalidValue, "unknown pressure type: {}", line[1]);
+
+            error = StringToNsec(line[2], stall);
+            if (!error)
+                error = StringToNsec(line[3], window);
+            if (error)
+                return error;
+
+            trigger.Stall = stall / 1000;
+            trigger.Window = window / 1000;
+            if (!trigger.Stall || trigger.Stall > trigger.Window)
+                return TError(EError::InvalidValue, "stall time must be within window");
+
+            triggers.push_back(trigger);
+        }
+
+        CT->PressureTriggers = triggers;
+        CT->SetProp(EProperty::PRESSURE_TRIGGER);
+        return OK;
+    }
+} static PressureTriggerProperty;
+
 class TCpuThrottled : public TProperty {
 public:
     TCpuThrottled() : TProperty(P_CPU_THROTTLED, EProperty::NONE,
@@ -3184,6 +3526,7 @@ void TPortoStat::Populate(TUintMap &m) {
     m["log_bytes"] = Statistics->LogBytes;
     m["log_lines_lost"] = Statistics->LogLinesLost;
     m["log_bytes_lost"] = Statistics->LogBytesLost;
+    m["log_lines_dropped"] = Statistics->LogLinesDropped;
 
     m["log_rotate_bytes"] = Statistics->LogRotateBytes;
     m["log_rotate_errors"] = Statistics->LogRotateErrors;
@@ -3210,6 +3553,10 @@ void TPortoStat::Populate(TUintMap &m) {
     m["volume_links"] = Statistics->VolumeLinks;
     m["volume_links_mounted"] = Statistics->VolumeLinksMounted;
     m["volume_lost"] = Statistics->VolumeLost;
+    m["volume_trash"] = TStorage::TrashBacklog();
+    m["volume_trash_reclaimed"] = Statistics->VolumeTrashReclaimed;
+    m["volume_trash_entries"] = Statistics->VolumeTrashEntries;
+    m["volume_trash_rate"] = Statistics->VolumeTrashRate;
 
     m["networks"] = Statistics->NetworksCount;
 
@@ -3382,7 +3729,78 @@ public:
     }
 } static Taint;
 
+/*
+ * Property names are known after static initialization, so the hash seed
+ * and table size are chosen once at start to get one property per slot:
+ * lookup is one hash and one compare, save walks the EProperty table.
+ */
+
+static std::vector<TProperty *> PropertyHashTable;
+static uint32_t PropertyHashSeed;
+static uint32_t PropertyHashMask;
+static TProperty *PropertyEnumTable[(int)EProperty::NR_PROPERTIES];
+
+static inline uint32_t PropertyHash(const char *name, size_t len, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)name[i];
+        hash *= 16777619u;
+    }
+
+    return hash ^ (hash >> 15);
+}
+
+static bool BuildPropertyHash(uint32_t size, uint32_t seed) {
+    PropertyHashTable.assign(size, nullptr);
+
+    for (auto &it: ContainerProperties) {
+        auto &name = it.first;
+        uint32_t slot = PropertyHash(name.data(), name.size(), seed) & (size - 1);
+        if (PropertyHashTable[slot])
+            return false;
+        PropertyHashTable[slot] = it.second;
+    }
+
+    PropertyHashSeed = seed;
+    PropertyHashMask = size - 1;
+    return true;
+}
+
+TProperty *FindContainerProperty(const char *name, size_t len) {
+    if (PropertyHashTable.empty())
+        return nullptr;
+
+    uint32_t slot = PropertyHash(name, len, PropertyHashSeed) & PropertyHashMask;
+    TProperty *prop = PropertyHashTable[slot];
+
+    if (prop && prop->Name.size() == len && !prop->Name.compare(0, len, name, len))
+        return prop;
+
+    return nullptr;
+}
+
+TProperty *FindContainerProperty(EProperty prop) {
+    return PropertyEnumTable[(int)prop];
+}
+
 void InitContainerProperties(void) {
-    for (auto prop: ContainerProperties)
+    uint32_t size = 1;
+
+    for (auto prop: ContainerProperties) {
         prop.second->Init();
+
+        if (prop.second->Prop != EProperty::NONE)
+            PropertyEnumTable[(int)prop.second->Prop] = prop.second;
+    }
+
+    while (size < ContainerProperties.size() * 2)
+        size <<= 1;
+
+    for (uint32_t seed = 0; !BuildPropertyHash(size, seed); seed++) {
+        if (seed == 1000) {
+            seed = 0;
+            size <<= 1;
+        }
+    }
 }
@@ -46,6 +46,9 @@ constexpr const char *P_CACHE_USAGE = "cache_usage";
 constexpr const char *P_HUGETLB_USAGE = "hugetlb_usage";
 constexpr const char *P_MINOR_FAULTS = "minor_faults";
 constexpr const char *P_MAJOR_FAULTS = "major_faults";
+constexpr const char *P_MEM_NODES = "memory_nodes";
+constexpr const char *P_NUMA_POLICY = "numa_policy";
+constexpr const char *P_NUMA_USAGE = "numa_usage";
 
 constexpr const char *P_CPU_POLICY = "cpu_policy";
 constexpr const char *P_CPU_GUARANTEE = "cpu_guarantee";
@@ -56,7 +59,12 @@ constexpr const char *P_CPU_PERIOD = "cpu_period";
 constexpr const char *P_CPU_WEIGHT = "cpu_weight";
 constexpr const char *P_CPU_SET = "cpu_set";
 constexpr const char *P_CPU_SET_AFFINITY  = "cpu_set_affinity";
+constexpr const char *P_CPU_SET_LAYOUT = "cpu_set_layout";
 constexpr const char *P_CPU_USAGE = "cpu_usage";
+constexpr const char *P_CPU_PRESSURE = "cpu_pressure";
+constexpr const char *P_MEMORY_PRESSURE = "memory_pressure";
+constexpr const char *P_IO_PRESSURE = "io_pressure";
+constexpr const char *P_PRESSURE_TRIGGER = "pressure_trigger";
 constexpr const char *P_CPU_SYSTEM = "cpu_usage_system";
 constexpr const char *P_CPU_WAIT = "cpu_wait";
 constexpr const char *P_CPU_THROTTLED = "cpu_throttled";
@@ -108,6 +116,10 @@ constexpr const char *P_ABSOLUTE_NAMESPACE = "absolute_namespace";
 constexpr const char *P_STATE = "state";
 constexpr const char *P_OOM_KILLED = "oom_killed";
 constexpr const char *P_OOM_KILLS = "oom_kills";
+constexpr const char *P_OOM_HISTORY = "oom_history";
+constexpr const char *P_MEMORY_EVENTS = "memory_events";
+constexpr const char *P_PROACTIVE_RECLAIM = "proactive_reclaim";
+constexpr const char *P_WORKING_SET = "working_set";
 constexpr const char *P_CORE_DUMPED = "core_dumped";
 constexpr const char *P_PARENT = "parent";
 constexpr const char *P_ROOT_PID = "root_pid";
@@ -184,6 +196,10 @@ enum class EProperty {
     CPU_WEIGHT,
     CPU_SET,
     CPU_SET_AFFINITY,
+    MEM_NODES,
+    NUMA_POLICY,
+    PRESSURE_TRIGGER,
+    PROACTIVE_RECLAIM,
     IO_POLICY,
     IO_WEIGHT,
     IO_LIMIT,
@@ -263,6 +279,16 @@ public:
 
 void InitContainerProperties(void);
 
+/* Lookup in perfect hash built by InitContainerProperties, no allocations */
+TProperty *FindContainerProperty(const char *name, size_t len);
+
+static inline TProperty *FindContainerProperty(const std::string &name) {
+    return FindContainerProperty(name.data(), name.size());
+}
+
+/* Property which stores EProperty value or nullptr */
+TProperty *FindContainerProperty(EProperty prop);
+
 class TContainer;
 extern __thread TContainer *CT;
 extern std::map<std::string, TProperty*> ContainerProperties;
@@ -18,9 +18,12 @@
 #include "util/quota.hpp"
 
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
 
 extern "C" {
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 }
 
 void TRequest::Classify() {
@@ -898,11 +901,7 @@ noinline TError ListVolumes(const rpc::TVolumeListRequest &req,
 
     std::map<TPath, std::shared_ptr<TVolumeLink>> map;
     auto volumes_lock = LockVolumes();
-    for (auto &it: VolumeLinks) {
-        TPath path = base_path.InnerPath(it.first);
-        if (path)
-            map[path] = it.second;
-    }
+    TVolume::ListLinksLocked(base_path, map);
     volumes_lock.unlock();
 
     for (auto &it: map)
@@ -1120,6 +1119,8 @@ noinline TError ListStorage(const rpc::TStorageListRequest &req,
         return error;
 
     auto list = rsp.mutable_storagelist();
+    list->set_trash_backlog(TStorage::TrashBacklog(place));
+
     for (auto &storage: storages) {
         if (req.has_mask() && !StringMatch(storage.Name, req.mask()))
             continue;
@@ -1254,6 +1255,7 @@ noinline static TError GetSystemProperties(const rpc::TGetSystemRequest *, rpc::
     rsp->set_log_bytes(Statistics->LogBytes);
     rsp->set_log_lines_lost(Statistics->LogLinesLost);
     rsp->set_log_bytes_lost(Statistics->LogBytesLost);
+    rsp->set_log_lines_dropped(Statistics->LogLinesDropped);
 
     rsp->set_container_count(Statistics->ContainersCount - NR_SERVICE_CONTAINERS);
     rsp->set_container_limit(config().container().max_total());
@@ -1276,6 +1278,10 @@ noinline static TError GetSystemProperties(const rpc::TGetSystemRequest *, rpc::
     rsp->set_volume_links(Statistics->VolumeLinks);
     rsp->set_volume_links_mounted(Statistics->VolumeLinksMounted);
     rsp->set_volume_lost(Statistics->VolumeLost);
+    rsp->set_volume_trash(TStorage::TrashBacklog());
+    rsp->set_volume_trash_reclaimed(Statistics->VolumeTrashReclaimed);
+    rsp->set_volume_trash_entries(Statistics->VolumeTrashEntries);
+    rsp->set_volume_trash_rate(Statistics->VolumeTrashRate);
 
     rsp->set_layer_import(Statistics->LayerImport);
     rsp->set_layer_export(Statistics->LayerExport);
@@ -1342,6 +1348,157 @@ TError TRequest::Check() {
     return OK;
 }
 
+static std::mutex RequestJournalMutex;
+static std::condition_variable RequestJournalCv;
+static std::thread RequestJournalThread;
+static std::vector<std::string> RequestJournalQueue;
+static uint64_t RequestJournalQueued;
+static bool RequestJournalStop;
+static TFile RequestJournal;
+static uint64_t RequestJournalSize;
+
+static TError OpenRequestJournal() {
+    TPath path = config().daemon().request_journal();
+    TError error;
+
+    /* Requests could contain secrets in environment */
+    error = RequestJournal.Create(path, O_WRONLY | O_APPEND | O_CREAT |
+                                  O_CLOEXEC | O_NOFOLLOW, 0600);
+    if (error)
+        return error;
+
+    off_t size = lseek(RequestJournal.Fd, 0, SEEK_END);
+    RequestJournalSize = size > 0 ? size : 0;
+    return OK;
+}
+
+/* Keeps current and one previous file: <path> and <path>.old */
+static TError RotateRequestJournal() {
+    TPath path = config().daemon().request_journal();
+
+    RequestJournal.Close();
+
+    TError error = path.Rename(path.ToString() + ".old");
+    if (error)
+        return error;
+
+    return OpenRequestJournal();
+}
+
+/* Only this thread touches journal file, rpc workers just queue records */
+static void RequestJournalWorker() {
+    std::vector<std::string> records;
+
+    SetProcessName("portod-journal");
+
+    auto lock = std::unique_lock<std::mutex>(RequestJournalMutex);
+    while (true) {
+        while (RequestJournalQueue.empty() && !RequestJournalStop)
+            RequestJournalCv.wait(lock);
+        if (RequestJournalQueue.empty())
+            break;
+
+        records.swap(RequestJournalQueue);
+        RequestJournalQueued = 0;
+        lock.unlock();
+
+        for (auto &buf: records) {
+            if (!RequestJournal)
+                break;
+
+            TError error;
+            if (RequestJournalSize && RequestJournalSize + buf.size() >
+                    config().daemon().request_journal_size())
+                error = RotateRequestJournal();
+            if (!error)
+                error = RequestJournal.WriteAll(buf);
+            if (error) {
+                L_WRN("Cannot write request journal: {}", error);
+                RequestJournal.Close();
+                break;
+            }
+
+            RequestJournalSize += buf.size();
+        }
+        records.clear();
+
+        lock.lock();
+    }
+}
+
+static void JournalRequest(const TRequest &request, const TError &error) {
+    rpc::TRequestRecord record;
+    std::string buf;
+
+    if (!RequestJournalThread.joinable())
+        return;
+
+    *record.mutable_request() = request.Req;
+    record.set_client(request.Client->Id);
+    record.set_pid(request.Client->Pid);
+    record.set_uid(request.Client->Cred.Uid);
+    record.set_gid(request.Client->Cred.Gid);
+    record.set_comm(request.Client->Comm);
+    if (request.Client->ClientContainer)
+        record.set_container(request.Client->ClientContainer->Name);
+    record.set_queue_time(request.QueueTime);
+    record.set_start_time(request.StartTime);
+    record.set_finish_time(request.FinishTime);
+    record.set_error(error.Error);
+
+    size_t size = record.ByteSizeLong();
+    if (size > UINT32_MAX) {
+        L_WRN("Request {} too big for journal: {} bytes", request.Cmd, size);
+        return;
+    }
+
+    uint32_t len = size;
+    size_t lenLen = google::protobuf::io::CodedOutputStream::VarintSize32(len);
+
+    buf.resize(len + lenLen);
+    google::protobuf::io::CodedOutputStream::WriteVarint32ToArray(len, (uint8_t *)&buf[0]);
+    if (!record.SerializeToArray((uint8_t *)&buf[lenLen], len))
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(RequestJournalMutex);
+
+    /* Do not pile up more than whole journal if writer is stuck */
+    if (RequestJournalQueued + buf.size() > config().daemon().request_journal_size()) {
+        L_WRN("Request journal queue is full, {} dropped", request.Cmd);
+        return;
+    }
+
+    RequestJournalQueued += buf.size();
+    RequestJournalQueue.emplace_back(std::move(buf));
+    lock.unlock();
+    RequestJournalCv.notify_one();
+}
+
+static void StartRequestJournal() {
+    TError error = OpenRequestJournal();
+    if (error) {
+        L_WRN("Cannot open request journal: {}", error);
+        return;
+    }
+
+    RequestJournalStop = false;
+    RequestJournalThread = std::thread(RequestJournalWorker);
+}
+
+/* Writes out everything queued before closing */
+static void StopRequestJournal() {
+    if (!RequestJournalThread.joinable())
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(RequestJournalMutex);
+    RequestJournalStop = true;
+    lock.unlock();
+    RequestJournalCv.notify_all();
+
+    RequestJournalThread.join();
+    RequestJournal.Close();
+}
+
 void TRequest::Handle() {
     rpc::TContainerResponse rsp;
     TError error;
@@ -1480,6 +1637,8 @@ void TRequest::Handle() {
         Statistics->LongestRoRequest = RequestTime;
     }
 
+    JournalRequest(*this, error);
+
     if (error == EError::Queued)
         return;
 
@@ -1582,6 +1741,9 @@ static TRequestQueue RoQueue("portod-RO");
 static TRequestQueue IoQueue("portod-IO");
 
 void StartRpcQueue() {
+    if (config().daemon().request_journal().size())
+        StartRequestJournal();
+
     RwQueue.Start(config().daemon().rw_threads());
     RoQueue.Start(config().daemon().ro_threads());
     IoQueue.Start(config().daemon().io_threads());
@@ -1591,6 +1753,8 @@ void StopRpcQueue() {
     RwQueue.Stop();
     RoQueue.Stop();
     IoQueue.Stop();
+
+    StopRequestJournal();
 }
 
 void QueueRpcRequest(std::unique_ptr<TRequest> &request) {
@@ -0,0 +1,363 @@
+#include <mutex>
+#include <map>
+
+#include "spawner.hpp"
+#include "task.hpp"
+#include "helpers.hpp"
+#include "config.hpp"
+#include "spawn.pb.h"
+#include "util/log.hpp"
+#include "util/signal.hpp"
+
+extern "C" {
+#include <unistd.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <sys/signalfd.h>
+}
+
+/* Upper limit for size of launch descriptor */
+#define SPAWN_MAX_SIZE  (16 << 20)
+#define SPAWN_MAX_FDS   64
+
+static TTask SpawnerTask;
+static TUnixSocket SpawnerSock;
+static std::mutex SpawnerMutex;
+
+static TError SendData(int fd, const std::string &data) {
+    size_t off = 0;
+
+    while (off < data.size()) {
+        ssize_t ret = write(fd, data.data() + off, data.size() - off);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return TError::System("spawner write");
+        off += ret;
+    }
+
+    return OK;
+}
+
+static TError RecvData(int fd, std::string &data, size_t size) {
+    size_t off = 0;
+
+    data.resize(size);
+    while (off < size) {
+        ssize_t ret = read(fd, &data[off], size - off);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret < 0)
+            return TError::System("spawner read");
+        if (!ret)
+            return TError(EError::Unknown, EPIPE, "spawner read: end of file");
+        off += ret;
+    }
+
+    return OK;
+}
+
+static TError RecvRequest(const TUnixSocket &sock, std::string &data,
+                          std::vector<int> &fds) {
+    TError error;
+    int size, nr;
+
+    error = sock.RecvInt(size);
+    if (error)
+        return error;
+
+    if (size < 0 || size > SPAWN_MAX_SIZE)
+        return TError("Spawner: wrong request size {}", size);
+
+    error = RecvData(sock.GetFd(), data, size);
+    if (error)
+        return error;
+
+    error = sock.RecvInt(nr);
+    if (error)
+        return error;
+
+    if (nr < 1 || nr > SPAWN_MAX_FDS)
+        return TError("Spawner: wrong count of fds {}", nr);
+
+    for (int i = 0; i < nr; i++) {
+        int fd;
+        error = sock.RecvFd(fd);
+        if (error)
+            return error;
+        fds.push_back(fd);
+    }
+
+    return OK;
+}
+
+static void SpawnTaskChild(const spawn::TTaskEnv &msg, std::vector<int> &fds) {
+    TTaskEnv env;
+    TError error;
+
+    error = env.Unpack(msg, fds);
+    if (error) {
+        if (env.Sock.GetFd() < 0)
+            _exit(EXIT_FAILURE);
+        env.Abort(error);
+    }
+
+    for (auto fd: fds)
+        if (fd >= 0)
+            close(fd);
+
+    env.StartForked();
+}
+
+static void SpawnHelperChild(const spawn::THelper &msg, std::vector<int> &fds) {
+    auto fd = [&fds](int index) -> int {
+        if (index < 0 || index >= (int)fds.size())
+            return -1;
+        return fds[index];
+    };
+
+    std::vector<std::string> command(msg.argv().begin(), msg.argv().end());
+    TFile dir(fd(msg.dir_fd()));
+    TFile in(fd(msg.stdin_fd()));
+    TFile out(fd(msg.stdout_fd()));
+    TFile err(fd(msg.stderr_fd()));
+    TCapabilities caps;
+
+    caps.Permitted = msg.caps();
+
+    ExecHelper(command, dir, in, out, err, caps);
+}
+
+static void SpawnChild(const std::string &data, std::vector<int> &fds) {
+    spawn::TRequest msg;
+
+    if (!msg.ParseFromString(data))
+        _exit(EXIT_FAILURE);
+
+    if (msg.has_task())
+        SpawnTaskChild(msg.task(), fds);
+    else if (msg.has_helper())
+        SpawnHelperChild(msg.helper(), fds);
+
+    _exit(EXIT_FAILURE);
+}
+
+static void ReapChildren(std::map<pid_t, int> &children) {
+    pid_t pid;
+    int status;
+
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        auto it = children.find(pid);
+        if (it == children.end())
+            continue;
+        if (write(it->second, &status, sizeof(status)) != sizeof(status))
+            L_VERBOSE("Spawner: cannot report status of {}", pid);
+        close(it->second);
+        children.erase(it);
+    }
+}
+
+static int SpawnerMain(TUnixSocket &sock) {
+    std::map<pid_t, int> children;
+    struct pollfd pfd[2];
+    TError error;
+
+    pfd[0].fd = sock.GetFd();
+    pfd[0].events = POLLIN;
+    pfd[1].fd = SignalFd();
+    pfd[1].events = POLLIN;
+
+    while (true) {
+        if (poll(pfd, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            L_ERR("Spawner: {}", TError::System("poll"));
+            return EXIT_FAILURE;
+        }
+
+        if (pfd[1].revents) {
+            struct signalfd_siginfo info;
+            while (read(pfd[1].fd, &info, sizeof(info)) == sizeof(info))
+                ;
+            ReapChildren(children);
+        }
+
+        if (!pfd[0].revents)
+            continue;
+
+        std::string data;
+        std::vector<int> fds;
+
+        error = RecvRequest(sock, data, fds);
+        if (error) {
+            /* portod is gone or stream is broken */
+            if (error.Errno != EPIPE)
+                L_ERR("Spawner: {}", error);
+            return error.Errno == EPIPE ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+
+        /* Last fd is socket for reporting pid and exit status */
+        int status = fds.back();
+        fds.pop_back();
+
+        pid_t pid = fork();
+        if (!pid) {
+            close(status);
+            close(pfd[1].fd);
+            sock.Close();
+            SpawnChild(data, fds);
+        }
+
+        for (auto fd: fds)
+            close(fd);
+
+        int report = pid < 0 ? -errno : pid;
+        if (write(status, &report, sizeof(report)) != sizeof(report) || pid < 0) {
+            if (pid > 0)
+                kill(pid, SIGKILL);
+            close(status);
+            status = -1;
+        }
+
+        if (pid > 0)
+            children[pid] = status;
+    }
+}
+
+TError TSpawner::Start() {
+    TUnixSocket sock;
+    TError error;
+
+    if (!config().container().task_spawner())
+        return OK;
+
+    error = TUnixSocket::SocketPair(SpawnerSock, sock);
+    if (error)
+        return error;
+
+    error = SpawnerTask.Fork();
+    if (error)
+        return error;
+
+    if (!SpawnerTask.Pid) {
+        SetDieOnParentExit(SIGKILL);
+        SetProcessName("portod-spawner");
+        SpawnerSock.Close();
+        TFile::CloseAll({0, 1, 2, sock.GetFd(), LogFile.Fd});
+        _exit(SpawnerMain(sock));
+    }
+
+    L_SYS("Start spawner {}", SpawnerTask.Pid);
+
+    return OK;
+}
+
+bool TSpawner::Running() {
+    return SpawnerTask.Pid && SpawnerTask.Running;
+}
+
+static TError SpawnRequest(const spawn::TRequest &msg, std::vector<int> &fds,
+                           pid_t &pid, TUnixSocket &status) {
+    TUnixSocket sock;
+    std::string data;
+    TError error;
+
+    if (!msg.SerializeToString(&data))
+        return TError("Cannot serialize launch descriptor");
+
+    error = TUnixSocket::SocketPair(status, sock);
+    if (error)
+        return error;
+
+    fds.push_back(sock.GetFd());
+
+    auto lock = std::unique_lock<std::mutex>(SpawnerMutex);
+
+    error = SpawnerSock.SendInt(data.size());
+    if (!error)
+        error = SendData(SpawnerSock.GetFd(), data);
+    if (!error)
+        error = SpawnerSock.SendInt(fds.size());
+    for (auto fd: fds) {
+        if (error)
+            break;
+        error = SpawnerSock.SendFd(fd);
+    }
+
+    if (error) {
+        L_ERR("Spawner is broken: {}", error);
+        SpawnerSock.Close();
+        SpawnerTask.Kill(SIGKILL);
+        return error;
+    }
+
+    lock.unlock();
+
+    sock.Close();
+
+    error = status.SetRecvTimeout(config().container().start_timeout_ms());
+    if (error)
+        return error;
+
+    int report;
+    error = status.RecvInt(report);
+    if (error)
+        return error;
+
+    if (report < 0)
+        return TError(EError::ResourceNotAvailable, -report, "Spawner: fork()");
+
+    pid = report;
+
+    /* Exit status could take any time */
+    return status.SetRecvTimeout(0);
+}
+
+TError TSpawner::SpawnTask(const TTaskEnv &env, pid_t &pid, TUnixSocket &status) {
+    spawn::TRequest msg;
+    std::vector<int> fds;
+
+    env.Pack(*msg.mutable_task(), fds);
+
+    return SpawnRequest(msg, fds, pid, status);
+}
+
+TError TSpawner::SpawnHelper(const std::vector<std::string> &command,
+                             const TFile &dir, const TFile &in,
+                             const TFile &out, const TFile &err,
+                             const TCapabilities &caps,
+                             pid_t &pid, TUnixSocket &status) {
+    spawn::TRequest msg;
+    std::vector<int> fds;
+
+    auto fd = [&fds](int fd) -> int {
+        if (fd < 0)
+            return -1;
+        fds.push_back(fd);
+        return fds.size() - 1;
+    };
+
+    auto helper = msg.mutable_helper();
+    for (auto &arg: command)
+        helper->add_argv(arg);
+    helper->set_caps(caps.Permitted);
+    helper->set_dir_fd(fd(dir.Fd));
+    helper->set_stdin_fd(fd(in.Fd));
+    helper->set_stdout_fd(fd(out.Fd));
+    helper->set_stderr_fd(fd(err.Fd));
+
+    return SpawnRequest(msg, fds, pid, status);
+}
+
+TError TSpawner::WaitTask(const TUnixSocket &status) {
+    int report;
+
+    TError error = status.RecvInt(report);
+    if (error)
+        return error;
+
+    if (report)
+        return TError(EError::Unknown, FormatExitStatus(report));
+
+    return OK;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "util/error.hpp"
+#include "util/unix.hpp"
+#include "util/path.hpp"
+#include "util/cred.hpp"
+
+struct TTaskEnv;
+
+/*
+ * Spawner is small helper process forked at portod start before it
+ * grows big. It receives launch descriptors and forks tasks instead of
+ * portod, thus cost of container start doesn't depend on portod size.
+ */
+class TSpawner {
+public:
+    static TError Start();
+    static bool Running();
+
+    /* Returns pid of forked child and socket for its exit status */
+    static TError SpawnTask(const TTaskEnv &env, pid_t &pid, TUnixSocket &status);
+    static TError SpawnHelper(const std::vector<std::string> &command,
+                              const TFile &dir, const TFile &in,
+                              const TFile &out, const TFile &err,
+                              const TCapabilities &caps,
+                              pid_t &pid, TUnixSocket &status);
+    static TError WaitTask(const TUnixSocket &status);
+};
@@ -5,15 +5,21 @@
 #include "filesystem.hpp"
 #include "client.hpp"
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <thread>
+#include <queue>
+#include <set>
 #include "util/unix.hpp"
 #include "util/log.hpp"
 #include "util/string.hpp"
 #include "util/md5.hpp"
 #include "util/quota.hpp"
+#include "util/tree.hpp"
 
 extern "C" {
 #include <sys/stat.h>
+#include <sys/xattr.h>
 #include <fcntl.h>
 #include <unistd.h>
 }
@@ -25,11 +31,17 @@ static const char REMOVE_PREFIX[] = "_remove_";
 static const char PRIVATE_PREFIX[] = "_private_";
 static const char META_PREFIX[] = "_meta_";
 static const char META_LAYER[] = "_layer_";
+static const char BLOB_XATTR[] = "user.porto.blob";
+
+/* Temporary blob links younger than this could belong to running dedup */
+static const time_t BLOB_TMP_GRACE = 3600;
 
 /* Protected with VolumesMutex */
 
 static unsigned RemoveCounter = 0;
 
+static std::atomic<unsigned> BlobCounter(0);
+
 static std::list<TPath> ActivePaths;
 
 static bool PathIsActive(const TPath &path) {
@@ -103,6 +115,170 @@ void TStorage::DecPlaceLoad(const TPath &place) {
     StorageCv.notify_all();
 }
 
+/*
+ * Trash: PLACE/porto_trash/<time>_<counter>, directories renamed here
+ * are removed later by background reclaimer at limited rate.
+ */
+
+static std::mutex TrashMutex;
+static std::condition_variable TrashCv;
+static std::thread TrashThread;
+static std::set<std::string> TrashPlaces;
+static std::map<std::string, uint64_t> TrashBacklogs;
+static uint64_t TrashQueued = 0;
+static bool TrashStop = false;
+static TTreeThrottle TrashThrottle;
+
+static void AddTrashPlace(const TPath &place) {
+    auto lock = std::unique_lock<std::mutex>(TrashMutex);
+    if (TrashPlaces.insert(place.ToString()).second)
+        TrashCv.notify_all();
+}
+
+TError TStorage::MoveToTrash(const TPath &place, const TPath &path) {
+    TPath trash = place / PORTO_TRASH;
+    TError error;
+
+    if (!TrashThread.joinable())
+        return TError(EError::NotSupported, "Trash reclaimer is not running");
+
+    if (!trash.IsDirectoryStrict()) {
+        error = trash.Mkdir(0700);
+        if (error && error.Errno != EEXIST)
+            return error;
+    }
+
+    auto lock = std::unique_lock<std::mutex>(TrashMutex);
+
+    TPath dest = trash / fmt::format("{}_{}", GetCurrentTimeMs(), TrashQueued);
+
+    error = path.Rename(dest);
+    if (error)
+        return error;
+
+    L_ACT("Move {} to trash {}", path, dest);
+
+    TrashPlaces.insert(place.ToString());
+    TrashBacklogs[place.ToString()]++;
+    TrashQueued++;
+    TrashCv.notify_all();
+
+    return OK;
+}
+
+uint64_t TStorage::TrashBacklog(const TPath &place) {
+    auto lock = std::unique_lock<std::mutex>(TrashMutex);
+    auto it = TrashBacklogs.find(place.ToString());
+    return it != TrashBacklogs.end() ? it->second : 0;
+}
+
+uint64_t TStorage::TrashBacklog() {
+    auto lock = std::unique_lock<std::mutex>(TrashMutex);
+    uint64_t total = 0;
+    for (auto &it: TrashBacklogs)
+        total += it.second;
+    return total;
+}
+
+static void ReclaimTrash(const TPath &place) {
+    TPath trash = place / PORTO_TRASH;
+    std::vector<std::string> names;
+    TError error;
+    TFile dir;
+
+    if (dir.OpenDirStrict(trash))
+        return;
+
+    /* Resync with leftovers from previous runs */
+    auto lock = std::unique_lock<std::mutex>(TrashMutex);
+    if (trash.ReadDirectory(names))
+        return;
+    TrashBacklogs[place.ToString()] = names.size();
+    lock.unlock();
+
+    /* Oldest first */
+    std::sort(names.begin(), names.end(), [](const std::string &a, const std::string &b) {
+        return a.size() < b.size() || (a.size() == b.size() && a < b);
+    });
+
+    for (auto &name: names) {
+        uint64_t start = GetCurrentTimeMs();
+        uint64_t entries = TrashThrottle.Entries;
+
+        /* Follow config changes */
+        TrashThrottle.Rate = config().volumes().trash_rate();
+
+        error = RemoveTree(dir, name, 1, &TrashThrottle);
+        if (TrashThrottle.Abort)
+            break;
+
+        entries = TrashThrottle.Entries - entries;
+        Statistics->VolumeTrashEntries += entries;
+
+        if (error) {
+            L_WRN("Cannot reclaim {}: {}", trash / name, error);
+            continue;
+        }
+
+        lock.lock();
+        if (TrashBacklogs[place.ToString()])
+            TrashBacklogs[place.ToString()]--;
+        lock.unlock();
+
+        uint64_t time = GetCurrentTimeMs() - start;
+        Statistics->VolumeTrashReclaimed++;
+        Statistics->VolumeTrashRate = entries * 1000 / std::max(time, (uint64_t)1);
+
+        L_ACT("Reclaimed {} entries={} time={} ms", trash / name, entries, time);
+    }
+}
+
+static void TrashReclaimer() {
+    SetProcessName("portod-trash");
+
+    /* IOPRIO_CLASS_IDLE */
+    if (SetIoPrio(GetTid(), 3 << 13))
+        L_WRN("Cannot set idle io priority: {}", TError::System("ioprio_set"));
+
+    auto lock = std::unique_lock<std::mutex>(TrashMutex);
+    while (!TrashStop) {
+        auto queued = TrashQueued;
+        std::set<std::string> places = TrashPlaces;
+
+        lock.unlock();
+        for (auto &place: places)
+            ReclaimTrash(place);
+        lock.lock();
+
+        TrashCv.wait_for(lock, std::chrono::seconds(60), [&]{
+            return TrashStop || TrashQueued != queued || TrashPlaces.size() != places.size();
+        });
+    }
+}
+
+void TStorage::StartReclaimer() {
+    if (!config().volumes().async_destroy() || TrashThread.joinable())
+        return;
+
+    TrashStop = false;
+    TrashThrottle.Abort = false;
+    TrashPlaces.insert(PORTO_PLACE);
+    TrashThread = std::thread(TrashReclaimer);
+}
+
+void TStorage::StopReclaimer() {
+    if (!TrashThread.joinable())
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(TrashMutex);
+    TrashStop = true;
+    TrashThrottle.Abort = true;
+    TrashCv.notify_all();
+    lock.unlock();
+
+    TrashThread.join();
+}
+
 /* FIXME racy. rewrite with openat... etc */
 TError TStorage::Cleanup(const TPath &place, EStorageType type, unsigned perms) {
     TPath base;
@@ -198,6 +374,12 @@ TError TStorage::Cleanup(const TPath &place, EStorageType type, unsigned perms)
 
         lock.unlock();
         L_ACT("Remove junk: {}", path);
+        if (type == EStorageType::Layer) {
+            error = RemoveLayerTree(place, path);
+            if (error)
+                L_WRN("cannot remove junk {}: {}", path, error);
+            continue;
+        }
         error = RemoveRecursive(path);
         if (error) {
             L_VERBOSE("Cannot remove junk {}: {}", path, error);
@@ -230,10 +412,15 @@ TError TStorage::CheckPlace(const TPath &place) {
     if (error)
         return error;
 
+    SweepBlobs(place);
+
     error = Cleanup(place, EStorageType::Storage, 0700);
     if (error)
         return error;
 
+    if (TrashThread.joinable() && (place / PORTO_TRASH).Exists())
+        AddTrashPlace(place);
+
     return OK;
 }
 
@@ -445,6 +632,54 @@ TError TStorage::Touch() {
     return error;
 }
 
+static bool HelperExists(const std::string &name) {
+    const char *env = getenv("PATH");
+    for (auto &dir: SplitString(env ? env : "/usr/bin:/bin", ':')) {
+        if (TPath(dir + "/" + name).IsRegularFollow())
+            return true;
+    }
+    return false;
+}
+
+/*
+ * Compressor which uses several threads: tar pipes stream through it and
+ * adds "-d" for extraction. Empty string means tar builtin filter.
+ */
+static std::string ParallelCompressor(const std::string &format) {
+    static std::mutex probeMutex;
+    static unsigned probedThreads = 0;
+    static bool pigz = false, xz = false;
+    unsigned threads = config().volumes().archive_threads();
+
+    if (threads <= 1)
+        return "";
+
+    /* probe again whenever config changes thread count */
+    std::unique_lock<std::mutex> lock(probeMutex);
+    if (probedThreads != threads) {
+        pigz = HelperExists("pigz");
+        xz = HelperExists("xz");
+        L_SYS("parallel compression pigz:{} xz:{} threads:{}", pigz, xz, threads);
+        probedThreads = threads;
+    }
+    bool usePigz = pigz, useXz = xz;
+    lock.unlock();
+
+    if (format == "gz" && usePigz)
+        return fmt::format("--use-compress-program=pigz --processes {}", threads);
+
+    if (format == "xz" && useXz)
+        return fmt::format("--use-compress-program=xz --threads={}", threads);
+
+    return "";
+}
+
+/* zstd levels are 1..22, above 19 only with --ultra */
+static int ZstdCompressionLevel() {
+    int level = config().volumes().zstd_compression_level();
+    return std::min(std::max(level, 1), 22);
+}
+
 static TError Compression(const TPath &archive, const TFile &arc,
                              const std::string &compress,
                              std::string &format, std::string &option) {
@@ -456,6 +691,8 @@ static TError Compression(const TPath &archive, const TFile &arc,
             goto xz;
         if (compress == "tgz" || compress == "tar.gz")
             goto gz;
+        if (compress == "tzst" || compress == "tar.zst")
+            goto zst;
         if (compress == "tar")
             goto tar;
         if (StringEndsWith(compress, "squashfs"))
@@ -472,6 +709,8 @@ static TError Compression(const TPath &archive, const TFile &arc,
                 goto xz;
             if (!strncmp(magic, "\x1F\x8B\x08", 3))
                 goto gz;
+            if (!strncmp(magic, "\x28\xB5\x2F\xFD", 4))
+                goto zst;
             if (!strncmp(magic, "hsqs", 4))
                 goto squash;
         }
@@ -491,6 +730,9 @@ static TError Compression(const TPath &archive, const TFile &arc,
     if (StringEndsWith(name, ".gz") || StringEndsWith(name, ".tgz"))
         goto gz;
 
+    if (StringEndsWith(name, ".zst") || StringEndsWith(name, ".tzst"))
+        goto zst;
+
     if (StringEndsWith(name, ".squash") || StringEndsWith(name, ".squashfs"))
         goto squash;
 
@@ -498,11 +740,24 @@ tar:
     option = "--no-auto-compress";
     return OK;
 gz:
-    option = "--gzip";
+    option = ParallelCompressor("gz");
+    if (option.empty())
+        option = "--gzip";
     return OK;
 xz:
-    option = "--xz";
+    option = ParallelCompressor("xz");
+    if (option.empty())
+        option = "--xz";
     return OK;
+zst:
+{
+    /* tar adds "-d" for extraction, level is ignored there */
+    int level = ZstdCompressionLevel();
+    option = fmt::format("--use-compress-program=zstd --threads={}{} -{}",
+                         std::max(config().volumes().archive_threads(), 1u),
+                         level > 19 ? " --ultra" : "", level);
+    return OK;
+}
 squash:
     format = "squashfs";
     auto sep = compress.find('.');
@@ -526,42 +781,386 @@ static bool TarSupportsXattrs() {
     return result;
 }
 
+static TError SaveFileChecksums(const TPath &path, bool xxh64,
+                                std::vector<char> &buffer) {
+    std::string md5sum, xxh64sum;
+    TFile file;
+    TError error;
+
+    error = file.OpenRead(path);
+    if (error)
+        return error;
+    error = Md5Sum(file, md5sum, xxh64 ? &xxh64sum : nullptr, buffer);
+    if (error)
+        return error;
+    error = file.SetXAttr("user.porto.md5sum", md5sum);
+    if (error)
+        return error;
+    if (xxh64)
+        return file.SetXAttr("user.porto.xxh64sum", xxh64sum);
+    /* do not leave checksum of previous content */
+    error = file.RemoveXAttr("user.porto.xxh64sum");
+    if (error && error.Errno == ENODATA)
+        return OK;
+    return error;
+}
+
+/*
+ * Tree walk feeds bounded queue of regular files,
+ * workers compute checksums and save them into xattrs.
+ */
 TError TStorage::SaveChecksums() {
+    const std::string &extra = config().volumes().extra_checksum();
+    unsigned nr_threads = std::max(config().volumes().archive_threads(), 1u);
+    const size_t queue_limit = 1024;
+    std::vector<std::thread> threads;
+    std::condition_variable cv;
+    std::queue<TPath> queue;
+    std::mutex mutex;
+    bool done = false;
+    TError result;
     TPathWalk walk;
     TError error;
 
+    if (extra != "" && extra != "xxh64") {
+        static std::once_flag warned;
+        std::call_once(warned, [&] { L_WRN("Unknown extra checksum {}", extra); });
+    }
+
+    bool xxh64 = extra == "xxh64";
+
     error = walk.OpenScan(Path);
     if (error)
         return error;
 
     Size = 0;
 
+    for (unsigned i = 0; i < nr_threads; i++) {
+        threads.emplace_back([&] {
+            std::vector<char> buffer;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (1) {
+                cv.wait(lock, [&] { return !queue.empty() || done; });
+                if (queue.empty())
+                    break;
+                TPath path = queue.front();
+                queue.pop();
+                cv.notify_all();
+                if (result)
+                    continue;
+                lock.unlock();
+                TError error = SaveFileChecksums(path, xxh64, buffer);
+                lock.lock();
+                if (error && !result)
+                    result = error;
+            }
+        });
+    }
+
     while (1) {
         error = walk.Next();
-        if (error)
-            return error;
-        if (!walk.Path)
+        if (error || !walk.Path)
             break;
         if (!walk.Postorder)
             Size += walk.Stat->st_blocks * 512ull;
         if (!S_ISREG(walk.Stat->st_mode))
             continue;
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return queue.size() < queue_limit || result; });
+        if (result)
+            break;
+        queue.push(walk.Path);
+        cv.notify_all();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done = true;
+        cv.notify_all();
+    }
+
+    for (auto &thread: threads)
+        thread.join();
+
+    if (!error)
+        error = result;
+
+    return error;
+}
+
+/*
+ * Content-addressed store for layer files: PLACE/porto_blobs/xx/KEY where
+ * KEY is md5 of content plus inode attributes shared by hardlinks.
+ * Files with other xattrs are not shared. Link count is the reference
+ * count, store holds one link.
+ */
+
+static bool BlobShareable(const TFile &file) {
+    char names[256];
+    ssize_t len = flistxattr(file.Fd, names, sizeof(names));
+
+    if (len < 0)
+        return errno == ENOTSUP;
+
+    for (ssize_t off = 0; off < len; off += strlen(names + off) + 1) {
+        if (strcmp(names + off, BLOB_XATTR) &&
+                strcmp(names + off, "user.porto.md5sum"))
+            return false;
+    }
+
+    return true;
+}
+
+static TError CompareFiles(const TFile &a, const TFile &b, bool &equal) {
+    std::vector<char> bufa(1 << 20), bufb(1 << 20);
+    off_t off = 0;
+
+    equal = false;
+
+    while (1) {
+        ssize_t lena = pread(a.Fd, bufa.data(), bufa.size(), off);
+        if (lena < 0)
+            return TError::System("pread");
+        ssize_t lenb = pread(b.Fd, bufb.data(), lena ?: 1, off);
+        if (lenb < 0)
+            return TError::System("pread");
+        if (lena != lenb || memcmp(bufa.data(), bufb.data(), lena))
+            return OK;
+        if (!lena)
+            break;
+        off += lena;
+    }
+
+    equal = true;
+    return OK;
+}
+
+static bool ValidBlobKey(const std::string &key) {
+    return key.size() > 32 && key.find('/') == std::string::npos &&
+           key.find_first_not_of("0123456789abcdef") == 32;
+}
+
+TError TStorage::DedupLayer(const TPath &layer) {
+    TPath store = Place / PORTO_BLOBS;
+    uint64_t linked = 0, stored = 0;
+    std::vector<char> buffer;
+    TPathWalk walk;
+    TError error;
+
+    if (!store.Exists()) {
+        error = store.Mkdir(0700);
+        if (error && error.Errno != EEXIST)
+            return error;
+    }
+
+    error = walk.OpenScan(layer);
+    if (error)
+        return error;
+
+    while (1) {
+        error = walk.Next();
+        if (error)
+            return error;
+        if (!walk.Path)
+            break;
+
+        struct stat *st = walk.Stat;
+        if (!S_ISREG(st->st_mode) || st->st_nlink != 1 || !st->st_size)
+            continue;
+
         TFile file;
         error = file.OpenRead(walk.Path);
         if (error)
             return error;
+
+        if (!BlobShareable(file))
+            continue;
+
         std::string sum;
-        error = Md5Sum(file, sum);
+        error = Md5Sum(file, sum, nullptr, buffer);
         if (error)
             return error;
-        error = file.SetXAttr("user.porto.md5sum", sum);
+
+        std::string key = fmt::format("{}-{}-{}-{:o}-{}", sum, st->st_uid,
+                                      st->st_gid, st->st_mode & 07777, st->st_mtime);
+        TPath dir = store / sum.substr(0, 2);
+        TPath blob = dir / key;
+        struct stat blob_st;
+
+        if (!blob.StatStrict(blob_st)) {
+            TFile blob_file;
+            bool equal;
+
+            /* md5 is not collision resistant - compare content */
+            if (blob_st.st_size != st->st_size ||
+                    blob_file.OpenRead(blob) ||
+                    CompareFiles(file, blob_file, equal) || !equal)
+                continue;
+
+            TPath temp = dir / fmt::format("{}{}_{}", LAYER_TMP, GetTid(), BlobCounter++);
+            error = temp.Hardlink(blob);
+            if (!error) {
+                error = temp.Rename(walk.Path);
+                if (error)
+                    (void)temp.Unlink();
+            }
+            if (error) {
+                L_WRN("Cannot link {} to {}: {}", walk.Path, blob, error);
+                continue;
+            }
+            linked++;
+            continue;
+        }
+
+        if (!dir.Exists()) {
+            error = dir.Mkdir(0700);
+            if (error && error.Errno != EEXIST)
+                return error;
+        }
+
+        error = file.SetXAttr(BLOB_XATTR, key);
+        if (!error)
+            error = blob.Hardlink(walk.Path);
+        if (error) {
+            L_WRN("Cannot store {} as {}: {}", walk.Path, blob, error);
+            continue;
+        }
+        stored++;
+    }
+
+    L_ACT("Dedup layer {}: {} files shared, {} new", Name, linked, stored);
+
+    return OK;
+}
+
+/* Store entries referenced by files of layer */
+TError TStorage::CollectBlobs(const TPath &place, const TPath &layer,
+                              std::vector<TPath> &blobs) {
+    TPath store = place / PORTO_BLOBS;
+    TPathWalk walk;
+    TError error;
+
+    if (!store.Exists())
+        return OK;
+
+    error = walk.OpenScan(layer);
+    if (error)
+        return error;
+
+    while (1) {
+        error = walk.Next();
         if (error)
             return error;
+        if (!walk.Path)
+            break;
+
+        struct stat *st = walk.Stat;
+        if (!S_ISREG(st->st_mode) || st->st_nlink < 2)
+            continue;
+
+        std::string key;
+        if (walk.Path.GetXAttr(BLOB_XATTR, key) || !ValidBlobKey(key))
+            continue;
+
+        TPath blob = store / key.substr(0, 2) / key;
+        struct stat blob_st;
+
+        /* xattr comes from archive, check that this is the same inode */
+        if (blob.StatStrict(blob_st) || blob_st.st_dev != st->st_dev ||
+                blob_st.st_ino != st->st_ino)
+            continue;
+
+        blobs.push_back(blob);
     }
 
     return OK;
 }
 
+/*
+ * Drop store links which became last references. Called after removal,
+ * thus concurrent removals of layers sharing blob cannot both miss it.
+ */
+void TStorage::ReleaseBlobs(const std::vector<TPath> &blobs) {
+    for (auto &blob: blobs) {
+        struct stat st;
+
+        if (blob.StatStrict(st) || st.st_nlink != 1)
+            continue;
+
+        TError error = blob.Unlink();
+        if (error && error.Errno != ENOENT)
+            L_WRN("Cannot remove blob {}: {}", blob, error);
+    }
+}
+
+/* Remove unreferenced store entries left by crash or old versions */
+void TStorage::SweepBlobs(const TPath &place) {
+    static std::mutex sweepMutex;
+    static std::set<std::string> swept;
+    TPath store = place / PORTO_BLOBS;
+    std::vector<std::string> dirs;
+    uint64_t removed = 0;
+    time_t now = time(nullptr);
+
+    auto lock = std::unique_lock<std::mutex>(sweepMutex);
+    if (!swept.insert(place.ToString()).second)
+        return;
+    lock.unlock();
+
+    if (store.ReadDirectory(dirs))
+        return;
+
+    for (auto &dir: dirs) {
+        std::vector<std::string> names;
+
+        if ((store / dir).ReadDirectory(names))
+            continue;
+
+        for (auto &name: names) {
+            TPath blob = store / dir / name;
+            struct stat st;
+
+            if (blob.StatStrict(st) || !S_ISREG(st.st_mode))
+                continue;
+
+            if (StringStartsWith(name, LAYER_TMP)) {
+                /* link() updates ctime, DedupLayer renames it over file soon */
+                if (st.st_ctime + BLOB_TMP_GRACE > now)
+                    continue;
+            } else if (st.st_nlink != 1)
+                continue;
+
+            TError error = blob.Unlink();
+            if (error && error.Errno != ENOENT)
+                L_WRN("Cannot remove blob {}: {}", blob, error);
+            else
+                removed++;
+        }
+    }
+
+    if (removed)
+        L_ACT("Removed {} unused blobs in {}", removed, store);
+}
+
+TError TStorage::RemoveLayerTree(const TPath &place, const TPath &path) {
+    std::vector<TPath> blobs;
+    TError error;
+
+    error = CollectBlobs(place, path, blobs);
+    if (error)
+        L_WRN("Cannot collect blobs of {}: {}", path, error);
+
+    error = RemoveRecursive(path);
+    if (error) {
+        L_VERBOSE("Cannot remove layer {}: {}", path, error);
+        error = path.RemoveAll();
+    }
+
+    ReleaseBlobs(blobs);
+
+    return error;
+}
+
 TError TStorage::ImportArchive(const TPath &archive, const std::string &compress, bool merge) {
     TPath temp = TempPath(IMPORT_PREFIX);
     TError error;
@@ -666,7 +1265,7 @@ TError TStorage::ImportArchive(const TPath &archive, const std::string &compress
         TTuple args = { "unsquashfs",
                         "-force",
                         "-no-progress",
-                        "-processors", "1",
+                        "-processors", std::to_string(std::max(config().volumes().archive_threads(), 1u)),
                         "-dest", temp.ToString(),
                         archive.ToString() };
 
@@ -686,6 +1285,13 @@ TError TStorage::ImportArchive(const TPath &archive, const std::string &compress
         error = SanitizeLayer(temp, merge);
         if (error)
             goto err;
+
+        /* project quota of meta storage forbids cross-links */
+        if (config().volumes().layer_dedup() && Meta.empty()) {
+            error = DedupLayer(temp);
+            if (error)
+                L_WRN("Cannot dedup layer {}: {}", Name, error);
+        }
     }
 
     if (!Owner.IsUnknown()) {
@@ -715,7 +1321,8 @@ TError TStorage::ImportArchive(const TPath &archive, const std::string &compress
     return OK;
 
 err:
-    TError error2 = temp.RemoveAll();
+    TError error2 = Type == EStorageType::Layer ?
+                    RemoveLayerTree(Place, temp) : temp.RemoveAll();
     if (error2)
         L_WRN("Cannot cleanup layer: {}", error2);
 
@@ -797,16 +1404,24 @@ TError TStorage::ExportArchive(const TPath &archive, const std::string &compress
                         "--create",
                         "-C", Path.ToString(), "." };
 
+        /* blob keys are meaningful only inside this place */
         if (TarSupportsXattrs())
-            args.insert(args.begin() + 4, "--xattrs");
+            args.insert(args.begin() + 4, {
+                        "--xattrs",
+                        fmt::format("--xattrs-exclude={}", BLOB_XATTR)});
 
         error = RunCommand(args, dir, TFile(), arc);
     } else if (compress_format == "squashfs") {
         TTuple args = { "mksquashfs", Path.ToString(),
                         archive.BaseName(),
                         "-noappend",
+                        "-processors", std::to_string(std::max(config().volumes().archive_threads(), 1u)),
                         "-comp", compress_option };
 
+        if (compress_option == "zstd")
+            args.insert(args.end(), { "-Xcompression-level",
+                        std::to_string(ZstdCompressionLevel()) });
+
         error = RunCommand(args, dir, TFile());
     } else
         error = TError(EError::NotSupported, "Unsupported format " + compress_format);
@@ -885,12 +1500,18 @@ TError TStorage::Remove(bool weak) {
             L_WRN("Cannot destroy quota {}: {}", temp, error);
     }
 
-    error = RemoveRecursive(temp);
-    if (error) {
-        L_VERBOSE("Cannot remove storage {}: {}", temp, error);
-        error = temp.RemoveAll();
+    if (Type == EStorageType::Layer && Meta.empty()) {
+        error = RemoveLayerTree(Place, temp);
         if (error)
             L_WRN("Cannot remove storage {}: {}", temp, error);
+    } else {
+        error = RemoveRecursive(temp);
+        if (error) {
+            L_VERBOSE("Cannot remove storage {}: {}", temp, error);
+            error = temp.RemoveAll();
+            if (error)
+                L_WRN("Cannot remove storage {}: {}", temp, error);
+        }
     }
 
     DecPlaceLoad(Place);
@@ -53,8 +53,20 @@ public:
     static void IncPlaceLoad(const TPath &place);
     static void DecPlaceLoad(const TPath &place);
 
+    /* Deferred removal of volume data, see volumes.async_destroy */
+    static TError MoveToTrash(const TPath &place, const TPath &path);
+    static uint64_t TrashBacklog(const TPath &place);
+    static uint64_t TrashBacklog();
+    static void StartReclaimer();
+    static void StopReclaimer();
+
 private:
     static TError Cleanup(const TPath &place, EStorageType type, unsigned perms);
     TPath TempPath(const std::string &kind);
     TError CheckUsage();
+    TError DedupLayer(const TPath &layer);
+    static TError CollectBlobs(const TPath &place, const TPath &layer, std::vector<TPath> &blobs);
+    static void ReleaseBlobs(const std::vector<TPath> &blobs);
+    static void SweepBlobs(const TPath &place);
+    static TError RemoveLayerTree(const TPath &place, const TPath &path);
 };
@@ -34,10 +34,8 @@ TPath TStdStream::ResolveOutside(const TContainer &container) const {
     return container.RootPath / container.GetCwd() / Path;
 }
 
-TError TStdStream::Open(const TPath &path, const TCred &cred) {
-    int fd, flags;
-
-    Offset = 0;
+TError TStdStream::Open(const TPath &path, const TCred &cred, TFile &file) const {
+    int flags;
 
     if (Stream)
         flags = O_WRONLY | O_APPEND;
@@ -45,40 +43,52 @@ TError TStdStream::Open(const TPath &path, const TCred &cred) {
         flags = O_RDONLY;
 
     /* Never assign controlling terminal at open */
-    flags |= O_NOCTTY;
+    flags |= O_NOCTTY | O_CLOEXEC;
+
+    file.Close();
 
 retry:
-    fd = open(path.c_str(), flags);
-    if (fd < 0 && errno == ENOENT && Stream) {
-        fd = open(path.c_str(), flags | O_CREAT | O_EXCL, 0660);
-        if (fd < 0 && errno == EEXIST)
+    file.SetFd = open(path.c_str(), flags);
+    if (file.Fd < 0 && errno == ENOENT && Stream) {
+        file.SetFd = open(path.c_str(), flags | O_CREAT | O_EXCL, 0660);
+        if (file.Fd < 0 && errno == EEXIST)
             goto retry;
-        if (fd >= 0 && fchown(fd, cred.Uid, cred.Gid)) {
-            close(fd);
+        if (file.Fd >= 0 && fchown(file.Fd, cred.Uid, cred.Gid)) {
+            file.Close();
             return TError::System("fchown " + path.ToString());
         }
     }
-    if (fd < 0)
+    if (file.Fd < 0)
         return TError(EError::InvalidValue, errno, "open " + path.ToString());
 
-    if (fd != Stream) {
-        if (dup2(fd, Stream) < 0) {
-            close(fd);
-            return TError::System("dup2(" + std::to_string(fd) +
-                          ", " + std::to_string(Stream) + ")");
-        }
-        close(fd);
-    } else {
-        Stream = fd;
-    }
+    return OK;
+}
+
+TError TStdStream::Open(const TPath &path, const TCred &cred) {
+    TFile file;
+    TError error;
+
+    Offset = 0;
+
+    error = Open(path, cred, file);
+    if (error)
+        return error;
+
+    if (file.Fd == Stream) {
+        if (fcntl(Stream, F_SETFD, 0) < 0)
+            return TError::System("fcntl(F_SETFD)");
+        file.SetFd = -1;
+    } else if (dup2(file.Fd, Stream) < 0)
+        return TError::System("dup2(" + std::to_string(file.Fd) +
+                              ", " + std::to_string(Stream) + ")");
 
     return OK;
 }
 
 TError TStdStream::OpenOutside(const TContainer &container,
-                               const TClient &client) {
+                               const TClient &client, TFile &file) const {
     if (IsNull())
-        return Open("/dev/null", container.TaskCred);
+        return Open("/dev/null", container.TaskCred, file);
 
     if (IsRedirect()) {
         int clientFd = -1;
@@ -93,14 +103,13 @@ TError TStdStream::OpenOutside(const TContainer &container,
             return error;
 
         TPath path(StringFormat("/proc/%u/fd/%u", client.Pid, clientFd));
-        error = Open(path, container.TaskCred);
+        error = Open(path, container.TaskCred, file);
         if (error)
             return error;
 
         /* check permissions agains our copy */
-        path = StringFormat("/proc/self/fd/%u", Stream);
         struct stat st;
-        error = path.StatFollow(st);
+        error = file.ProcPath().StatFollow(st);
         if (error)
             return error;
         if (!TFile::Access(st, client.TaskCred, Stream ? TFile::W : TFile::R) &&
@@ -108,16 +117,16 @@ TError TStdStream::OpenOutside(const TContainer &container,
             return TError(EError::Permission,
                     "Not enough permissions for redirect: " + Path.ToString());
     } else if (Outside)
-        return Open(ResolveOutside(container), container.TaskCred);
+        return Open(ResolveOutside(container), container.TaskCred, file);
 
     return OK;
 }
 
-TError TStdStream::OpenInside(const TContainer &container) {
+TError TStdStream::OpenInside(const TCred &cred) {
     TError error;
 
     if (!Outside && !IsNull() && !IsRedirect())
-        error = Open(Path, container.TaskCred);
+        error = Open(Path, cred);
 
     /* Assign controlling terminal for our own session */
     if (!error && isatty(Stream))
@@ -30,9 +30,11 @@ public:
     bool IsRedirect(void) const;
     TPath ResolveOutside(const TContainer &container) const;
 
+    TError Open(const TPath &path, const TCred &cred, TFile &file) const;
     TError Open(const TPath &path, const TCred &cred);
-    TError OpenOutside(const TContainer &container, const TClient &client);
-    TError OpenInside(const TContainer &container);
+    TError OpenOutside(const TContainer &container, const TClient &client,
+                       TFile &file) const;
+    TError OpenInside(const TCred &cred);
 
     TError Remove(const TContainer &container);
 
@@ -8,6 +8,8 @@
 #include "device.hpp"
 #include "config.hpp"
 #include "network.hpp"
+#include "spawner.hpp"
+#include "spawn.pb.h"
 #include "util/log.hpp"
 #include "util/string.hpp"
 #include "util/signal.hpp"
@@ -162,11 +164,11 @@ TError TTaskEnv::ChildExec() {
 
     auto envp = Env.Envp();
 
-    if (CT->IsMeta()) {
+    if (Meta) {
         const char *args[] = {
             "portoinit",
             "--container",
-            CT->Name.c_str(),
+            Name.c_str(),
             NULL,
         };
         SetDieOnParentExit(0);
@@ -177,7 +179,7 @@ TError TTaskEnv::ChildExec() {
 
     wordexp_t result;
 
-    int ret = wordexp(CT->Command.c_str(), &result, WRDE_NOCMD | WRDE_UNDEF);
+    int ret = wordexp(Command.c_str(), &result, WRDE_NOCMD | WRDE_UNDEF);
     switch (ret) {
     case WRDE_BADCHAR:
         return TError(EError::InvalidCommand, "wordexp(): illegal occurrence of newline or one of |, &, ;, <, >, (, ), {{, }}");
@@ -195,7 +197,7 @@ TError TTaskEnv::ChildExec() {
     }
 
     if (Verbose) {
-        L("command={}", CT->Command);
+        L("command={}", Command);
         for (unsigned i = 0; result.we_wordv[i]; i++)
             L("argv[{}]={}", i, result.we_wordv[i]);
         for (unsigned i = 0; envp[i]; i++)
@@ -214,21 +216,19 @@ TError TTaskEnv::ChildExec() {
 }
 
 TError TTaskEnv::WriteResolvConf() {
-    if (CT->HasProp(EProperty::RESOLV_CONF) ? !CT->ResolvConf.size() : CT->Root == "/")
+    if (!SetResolvConf)
         return OK;
-    L_ACT("Write resolv.conf for CT{}:{}", CT->Id, CT->Name);
-    std::string cfg = MergeEscapeStrings(CT->ResolvConf.size() ? CT->ResolvConf :
-                                         RootContainer->ResolvConf, '\n');
-    return TPath("/etc/resolv.conf").WritePrivate(cfg);
+    L_ACT("Write resolv.conf for CT{}:{}", Id, Name);
+    return TPath("/etc/resolv.conf").WritePrivate(ResolvConf);
 }
 
 TError TTaskEnv::SetHostname() {
     TError error;
 
-    if (CT->Hostname.size()) {
-        error = TPath("/etc/hostname").WritePrivate(CT->Hostname + "\n");
+    if (Hostname.size()) {
+        error = TPath("/etc/hostname").WritePrivate(Hostname + "\n");
         if (!error)
-            error = SetHostName(CT->Hostname);
+            error = SetHostName(Hostname);
     }
 
     return error;
@@ -237,7 +237,7 @@ TError TTaskEnv::SetHostname() {
 TError TTaskEnv::ApplySysctl() {
     TError error;
 
-    if (CT->Isolate) {
+    if (Isolate) {
         for (const auto &it: config().container().ipc_sysctl()) {
             error = SetSysctl(it.key(), it.val());
             if (error)
@@ -245,15 +245,15 @@ TError TTaskEnv::ApplySysctl() {
         }
     }
 
-    for (const auto &it: CT->Sysctl) {
+    for (const auto &it: Sysctl) {
         auto &key = it.first;
 
         if (TNetwork::NetworkSysctl(key)) {
-            if (!CT->NetIsolate)
+            if (!NetIsolate)
                 return TError(EError::Permission, "Sysctl " + key + " requires net isolation");
             continue; /* Set by TNetEnv */
         } else if (std::find(IpcSysctls.begin(), IpcSysctls.end(), key) != IpcSysctls.end()) {
-            if (!CT->Isolate)
+            if (!Isolate)
                 return TError(EError::Permission, "Sysctl " + key + " requires ipc isolation");
         } else
             return TError(EError::Permission, "Sysctl " + key + " is not allowed");
@@ -269,7 +269,7 @@ TError TTaskEnv::ApplySysctl() {
 TError TTaskEnv::ConfigureChild() {
     TError error;
 
-    error = CT->GetUlimit().Apply();
+    error = Ulimit.Apply();
     if (error)
         return error;
 
@@ -285,12 +285,7 @@ TError TTaskEnv::ConfigureChild() {
     }
 
     if (!Mnt.Root.IsRoot()) {
-        TDevices devices = CT->Devices;
-
-        for (auto p = CT->Parent; p; p = p->Parent)
-            devices.Merge(p->Devices);
-
-        error = devices.Makedev();
+        error = Devices.Makedev();
         if (error)
             return error;
     }
@@ -327,7 +322,7 @@ TError TTaskEnv::ConfigureChild() {
             const char * argv[] = {
                 "portoinit",
                 "--container",
-                CT->Name.c_str(),
+                Name.c_str(),
                 "--wait",
                 pid_.c_str(),
                 NULL,
@@ -371,38 +366,38 @@ TError TTaskEnv::ConfigureChild() {
     if (error)
         return error;
 
-    if (CT->CapAmbient.Permitted)
-        L("Ambient capabilities: {}", CT->CapAmbient);
+    if (CapAmbient.Permitted)
+        L("Ambient capabilities: {}", CapAmbient);
 
-    error = CT->CapAmbient.ApplyAmbient();
+    error = CapAmbient.ApplyAmbient();
     if (error)
         return error;
 
-    L("Capabilities: {}", CT->CapBound);
+    L("Capabilities: {}", CapBound);
 
-    error = CT->CapBound.ApplyLimit();
+    error = CapBound.ApplyLimit();
     if (error)
         return error;
 
     if (!Cred.IsRootUser()) {
-        error = CT->CapAmbient.ApplyEffective();
+        error = CapAmbient.ApplyEffective();
         if (error)
             return error;
     }
 
-    error = CT->Stdin.OpenInside(*CT);
+    error = Stdin.OpenInside(Cred);
     if (error)
         return error;
 
-    error = CT->Stdout.OpenInside(*CT);
+    error = Stdout.OpenInside(Cred);
     if (error)
         return error;
 
-    error = CT->Stderr.OpenInside(*CT);
+    error = Stderr.OpenInside(Cred);
     if (error)
         return error;
 
-    umask(CT->Umask);
+    umask(Umask);
 
     return OK;
 }
@@ -425,7 +420,7 @@ TError TTaskEnv::WaitAutoconf() {
         if (error)
             return error;
 
-        error = link.WaitAddress(config().network().autoconf_timeout_s());
+        error = link.WaitAddress(AutoconfTimeout);
         if (error)
             return error;
     }
@@ -470,199 +465,513 @@ void TTaskEnv::StartChild() {
     Abort(error);
 }
 
-TError TTaskEnv::Start() {
-    TError error, error2;
+TError TTaskEnv::OpenStreams() {
+    TError error;
 
-    CT->Task.Pid = 0;
-    CT->TaskVPid = 0;
-    CT->WaitTask.Pid = 0;
-    CT->SeizeTask.Pid = 0;
+    /* Default streams and redirections are outside */
+    error = CT->Stdin.OpenOutside(*CT, *Client, StdFile[0]);
+    if (error)
+        return error;
 
-    error = TUnixSocket::SocketPair(MasterSock, Sock);
+    error = CT->Stdout.OpenOutside(*CT, *Client, StdFile[1]);
     if (error)
         return error;
 
-    // we want our child to have portod master as parent, so we
-    // are doing double fork here (fork + clone);
-    // we also need to know child pid so we are using pipe to send it back
+    return CT->Stderr.OpenOutside(*CT, *Client, StdFile[2]);
+}
 
-    TTask task;
+void TTaskEnv::Pack(spawn::TTaskEnv &msg, std::vector<int> &fds) const {
+    auto fd = [&fds](int fd) -> int {
+        if (fd < 0)
+            return -1;
+        fds.push_back(fd);
+        return fds.size() - 1;
+    };
+
+    auto cred = [](spawn::TCred *msg, const TCred &cred) {
+        msg->set_uid(cred.Uid);
+        msg->set_gid(cred.Gid);
+        for (auto gid: cred.Groups)
+            msg->add_groups(gid);
+    };
+
+    msg.set_id(Id);
+    msg.set_name(Name);
+    msg.set_command(Command);
+    msg.set_meta(Meta);
+    msg.set_isolate(Isolate);
+    msg.set_net_isolate(NetIsolate);
+    msg.set_hostname(Hostname);
+    if (SetResolvConf)
+        msg.set_resolv_conf(ResolvConf);
+
+    for (auto &it: Sysctl) {
+        auto sysctl = msg.add_sysctl();
+        sysctl->set_key(it.first);
+        sysctl->set_val(it.second);
+    }
 
-    error = task.Fork();
-    if (error) {
-        Sock.Close();
-        L("Can't spawn child: {}", error);
-        return error;
+    for (auto &res: Ulimit.Resources) {
+        auto ulimit = msg.add_ulimit();
+        ulimit->set_type(res.Type);
+        ulimit->set_soft(res.Soft);
+        ulimit->set_hard(res.Hard);
     }
 
-    if (!task.Pid) {
-        TError error;
+    for (auto &dev: Devices.Devices) {
+        auto device = msg.add_device();
+        device->set_path(dev.Path.ToString());
+        device->set_path_inside(dev.PathInside.ToString());
+        device->set_node(dev.Node);
+        device->set_uid(dev.Uid);
+        device->set_gid(dev.Gid);
+        device->set_mode(dev.Mode);
+        device->set_may_read(dev.MayRead);
+        device->set_may_write(dev.MayWrite);
+        device->set_may_mknod(dev.MayMknod);
+        device->set_wildcard(dev.Wildcard);
+    }
 
-        /* Switch from signafd back to normal signal delivery */
-        ResetBlockedSignals();
+    msg.set_oom_score_adj(OomScoreAdj);
+    msg.set_sched_nice(SchedNice);
+    msg.set_sched_policy(SchedPolicy);
+    msg.set_sched_prio(SchedPrio);
+    msg.set_io_prio(IoPrio);
+    if (MemPolicy) {
+        msg.set_mem_policy(MemPolicy);
+        msg.set_mem_policy_nodes(MemPolicyNodes.Format());
+    }
+    msg.set_cap_ambient(CapAmbient.Permitted);
+    msg.set_cap_bound(CapBound.Permitted);
+    msg.set_umask(Umask);
+
+    for (auto stream: {&Stdin, &Stdout, &Stderr}) {
+        auto out = msg.add_stream();
+        out->set_path(stream->Path.ToString());
+        out->set_outside(stream->Outside);
+    }
 
-        SetDieOnParentExit(SIGKILL);
+    for (auto &name: Autoconf)
+        msg.add_autoconf(name);
+    msg.set_autoconf_timeout(AutoconfTimeout);
 
-        SetProcessName("portod-CT" + std::to_string(CT->Id));
+    msg.set_triple_fork(TripleFork);
+    msg.set_quadro_fork(QuadroFork);
+    msg.set_new_mount_ns(NewMountNs);
 
-        /* FIXME try to replace clone() with  unshare() */
-#if __has_feature(address_sanitizer) || defined(__SANITIZE_ADDRESS__)
-        char stack[8192*4];
-#else
-        char stack[8192];
-#endif
+    for (auto &cg: Cgroups) {
+        auto cgroup = msg.add_cgroup();
+        cgroup->set_type(cg.Type());
+        cgroup->set_name(cg.Name);
+    }
 
-        (void)setsid();
+    cred(msg.mutable_cred(), Cred);
+    msg.set_login_uid(LoginUid);
 
-        // move to target cgroups
-        for (auto &cg : Cgroups) {
-            error = cg.Attach(GetPid());
-            if (error)
-                Abort(error);
-        }
+    for (auto &var: Env.Vars) {
+        auto env = msg.add_env();
+        env->set_name(var.Name);
+        env->set_value(var.Value);
+        env->set_set(var.Set);
+        env->set_locked(var.Locked);
+    }
 
-        error = TPath("/proc/self/oom_score_adj").WriteAll(std::to_string(CT->OomScoreAdj));
-        if (error && CT->OomScoreAdj)
-            Abort(error);
+    auto mnt = msg.mutable_mnt();
+    mnt->set_container(Mnt.Container);
+    cred(mnt->mutable_bind_cred(), Mnt.BindCred);
+    mnt->set_cwd(Mnt.Cwd.ToString());
+    mnt->set_root(Mnt.Root.ToString());
+    mnt->set_root_ro(Mnt.RootRo);
+    for (auto &bm: Mnt.BindMounts) {
+        auto bind = mnt->add_bind();
+        bind->set_source(bm.Source.ToString());
+        bind->set_target(bm.Target.ToString());
+        bind->set_flags(bm.MntFlags);
+        bind->set_control_source(bm.ControlSource);
+        bind->set_control_target(bm.ControlTarget);
+    }
+    for (auto &it: Mnt.Symlink) {
+        auto link = mnt->add_symlink();
+        link->set_symlink(it.first.ToString());
+        link->set_target(it.second.ToString());
+    }
+    mnt->set_bind_porto_sock(Mnt.BindPortoSock);
+    mnt->set_run_size(Mnt.RunSize);
+    mnt->set_systemd(Mnt.Systemd);
+
+    msg.set_sock_fd(fd(Sock.GetFd()));
+    msg.set_porto_init_fd(fd(PortoInit.Fd));
+    for (int i = 0; i < 3; i++)
+        msg.add_stream_fd(fd(StdFile[i].Fd));
+    msg.set_ipc_fd(fd(IpcFd.GetFd()));
+    msg.set_uts_fd(fd(UtsFd.GetFd()));
+    msg.set_net_fd(fd(NetFd.GetFd()));
+    msg.set_pid_fd(fd(PidFd.GetFd()));
+    msg.set_mnt_fd(fd(MntFd.GetFd()));
+    msg.set_root_fd(fd(RootFd.GetFd()));
+    msg.set_cwd_fd(fd(CwdFd.GetFd()));
+    msg.set_log_fd(fd(LogFile.Fd));
+}
 
-        if (setpriority(PRIO_PROCESS, 0, CT->SchedNice))
-            Abort(TError::System("setpriority"));
+TError TTaskEnv::Unpack(const spawn::TTaskEnv &msg, std::vector<int> &fds) {
+    auto fd = [&fds](int index) -> int {
+        if (index < 0 || index >= (int)fds.size())
+            return -1;
+        int fd = fds[index];
+        fds[index] = -1;
+        return fd;
+    };
+
+    auto cred = [](const spawn::TCred &msg, TCred &cred) {
+        cred.Uid = msg.uid();
+        cred.Gid = msg.gid();
+        cred.Groups.assign(msg.groups().begin(), msg.groups().end());
+    };
+
+    /* Take socket first to report errors */
+    Sock = fd(msg.sock_fd());
+    if (Sock.GetFd() < 0)
+        return TError("Spawner: no task socket");
+
+    PortoInit.SetFd = fd(msg.porto_init_fd());
+    for (int i = 0; i < 3 && i < msg.stream_fd_size(); i++)
+        StdFile[i].SetFd = fd(msg.stream_fd(i));
+    IpcFd.SetFd(fd(msg.ipc_fd()));
+    UtsFd.SetFd(fd(msg.uts_fd()));
+    NetFd.SetFd(fd(msg.net_fd()));
+    PidFd.SetFd(fd(msg.pid_fd()));
+    MntFd.SetFd(fd(msg.mnt_fd()));
+    RootFd.SetFd(fd(msg.root_fd()));
+    CwdFd.SetFd(fd(msg.cwd_fd()));
+
+    int logFd = fd(msg.log_fd());
+    if (logFd >= 0) {
+        if (LogFile.Fd >= 0 && logFd != LogFile.Fd)
+            (void)dup2(logFd, LogFile.Fd);
+        close(logFd);
+    }
 
-        struct sched_param param;
-        param.sched_priority = CT->SchedPrio;
-        if (sched_setscheduler(0, CT->SchedPolicy, &param))
-            Abort(TError::System("sched_setparm"));
+    Id = msg.id();
+    Name = msg.name();
+    Command = msg.command();
+    Meta = msg.meta();
+    Isolate = msg.isolate();
+    NetIsolate = msg.net_isolate();
+    Hostname = msg.hostname();
+    SetResolvConf = msg.has_resolv_conf();
+    ResolvConf = msg.resolv_conf();
+
+    for (auto &sysctl: msg.sysctl())
+        Sysctl.emplace_back(sysctl.key(), sysctl.val());
+
+    for (auto &ulimit: msg.ulimit())
+        Ulimit.Set(ulimit.type(), ulimit.soft(), ulimit.hard());
+
+    for (auto &device: msg.device()) {
+        TDevice dev;
+        dev.Path = device.path();
+        dev.PathInside = device.path_inside();
+        dev.Node = device.node();
+        dev.Uid = device.uid();
+        dev.Gid = device.gid();
+        dev.Mode = device.mode();
+        dev.MayRead = device.may_read();
+        dev.MayWrite = device.may_write();
+        dev.MayMknod = device.may_mknod();
+        dev.Wildcard = device.wildcard();
+        Devices.Devices.push_back(dev);
+    }
 
-        if (SetIoPrio(0, CT->IoPrio))
-            Abort(TError::System("ioprio"));
+    OomScoreAdj = msg.oom_score_adj();
+    SchedNice = msg.sched_nice();
+    SchedPolicy = msg.sched_policy();
+    SchedPrio = msg.sched_prio();
+    IoPrio = msg.io_prio();
+    MemPolicy = msg.mem_policy();
+    if (msg.has_mem_policy_nodes() && MemPolicyNodes.Parse(msg.mem_policy_nodes()))
+        return TError("Spawner: wrong mem policy nodes");
+    CapAmbient.Permitted = msg.cap_ambient();
+    CapBound.Permitted = msg.cap_bound();
+    Umask = msg.umask();
+
+    TStdStream *streams[] = {&Stdin, &Stdout, &Stderr};
+    for (int i = 0; i < 3 && i < msg.stream_size(); i++) {
+        streams[i]->Path = msg.stream(i).path();
+        streams[i]->Outside = msg.stream(i).outside();
+    }
 
-        /* Default streams and redirections are outside */
-        error = CT->Stdin.OpenOutside(*CT, *Client);
-        if (error)
-            Abort(error);
+    Autoconf.assign(msg.autoconf().begin(), msg.autoconf().end());
+    AutoconfTimeout = msg.autoconf_timeout();
+
+    TripleFork = msg.triple_fork();
+    QuadroFork = msg.quadro_fork();
+    NewMountNs = msg.new_mount_ns();
+
+    for (auto &cgroup: msg.cgroup()) {
+        const TSubsystem *subsys = nullptr;
+        for (auto ss: AllSubsystems)
+            if (ss->Type == cgroup.type())
+                subsys = ss;
+        if (!subsys)
+            return TError("Spawner: unknown cgroup {}", cgroup.type());
+        Cgroups.emplace_back(subsys, cgroup.name());
+    }
 
-        error = CT->Stdout.OpenOutside(*CT, *Client);
-        if (error)
-            Abort(error);
+    cred(msg.cred(), Cred);
+    LoginUid = msg.login_uid();
+
+    for (auto &env: msg.env())
+        Env.Vars.push_back({env.name(), env.value(), env.set(), env.locked(), ""});
+
+    auto &mnt = msg.mnt();
+    Mnt.Container = mnt.container();
+    cred(mnt.bind_cred(), Mnt.BindCred);
+    Mnt.Cwd = mnt.cwd();
+    Mnt.Root = mnt.root();
+    Mnt.RootRo = mnt.root_ro();
+    for (auto &bind: mnt.bind()) {
+        TBindMount bm;
+        bm.Source = bind.source();
+        bm.Target = bind.target();
+        bm.MntFlags = bind.flags();
+        bm.ControlSource = bind.control_source();
+        bm.ControlTarget = bind.control_target();
+        Mnt.BindMounts.push_back(bm);
+    }
+    for (auto &link: mnt.symlink())
+        Mnt.Symlink[link.symlink()] = link.target();
+    Mnt.BindPortoSock = mnt.bind_porto_sock();
+    Mnt.RunSize = mnt.run_size();
+    Mnt.Systemd = mnt.systemd();
 
-        error = CT->Stderr.OpenOutside(*CT, *Client);
-        if (error)
-            Abort(error);
+    return OK;
+}
 
-        /* Enter namespaces */
+/* Runs in forked child of portod or spawner, never returns */
+void TTaskEnv::StartForked() {
+    TError error;
 
-        error = IpcFd.SetNs(CLONE_NEWIPC);
-        if (error)
-            Abort(error);
+    /* Switch from signafd back to normal signal delivery */
+    ResetBlockedSignals();
 
-        error = UtsFd.SetNs(CLONE_NEWUTS);
-        if (error)
-            Abort(error);
+    SetDieOnParentExit(SIGKILL);
 
-        error = NetFd.SetNs(CLONE_NEWNET);
-        if (error)
-            Abort(error);
+    SetProcessName("portod-CT" + std::to_string(Id));
 
-        error = PidFd.SetNs(CLONE_NEWPID);
-        if (error)
-            Abort(error);
+    MasterSock.Close();
 
-        error = MntFd.SetNs(CLONE_NEWNS);
-        if (error)
-            Abort(error);
+    /* FIXME try to replace clone() with  unshare() */
+#if __has_feature(address_sanitizer) || defined(__SANITIZE_ADDRESS__)
+    char stack[8192*4];
+#else
+    char stack[8192];
+#endif
+
+    (void)setsid();
 
-        error = RootFd.Chroot();
+    // move to target cgroups
+    for (auto &cg : Cgroups) {
+        error = cg.Attach(GetPid());
         if (error)
             Abort(error);
+    }
+
+    error = TPath("/proc/self/oom_score_adj").WriteAll(std::to_string(OomScoreAdj));
+    if (error && OomScoreAdj)
+        Abort(error);
+
+    if (setpriority(PRIO_PROCESS, 0, SchedNice))
+        Abort(TError::System("setpriority"));
 
-        error = CwdFd.Chdir();
+    struct sched_param param;
+    param.sched_priority = SchedPrio;
+    if (sched_setscheduler(0, SchedPolicy, &param))
+        Abort(TError::System("sched_setparm"));
+
+    if (SetIoPrio(0, IoPrio))
+        Abort(TError::System("ioprio"));
+
+    if (MemPolicy && SetMemPolicy(MemPolicy, MemPolicyNodes))
+        Abort(TError::System("set_mempolicy"));
+
+    /* Forked right from portod: open streams here, spawner gets them opened */
+    if (CT) {
+        error = OpenStreams();
         if (error)
             Abort(error);
+    }
 
-        if (TripleFork) {
-            /*
-             * Enter into pid-namespace. fork() hangs in libc if child pid
-             * collide with parent pid outside. vfork() has no such problem.
-             */
-            pid_t forkPid = vfork();
-            if (forkPid < 0)
-                Abort(TError::System("fork()"));
+    /* Default streams and redirections are outside */
+    for (int stream = 0; stream < 3; stream++) {
+        if (StdFile[stream] && dup2(StdFile[stream].Fd, stream) < 0)
+            Abort(TError::System("dup2"));
+    }
 
-            if (forkPid)
-                _exit(EXIT_SUCCESS);
+    /* Enter namespaces */
 
-            error = TUnixSocket::SocketPair(MasterSock2, Sock2);
-            if (error)
-                Abort(error);
+    error = IpcFd.SetNs(CLONE_NEWIPC);
+    if (error)
+        Abort(error);
 
-            /* Report WPid */
-            ReportPid(GetTid());
-        }
+    error = UtsFd.SetNs(CLONE_NEWUTS);
+    if (error)
+        Abort(error);
 
-        int cloneFlags = SIGCHLD;
-        if (CT->Isolate)
-            cloneFlags |= CLONE_NEWPID | CLONE_NEWIPC;
+    error = NetFd.SetNs(CLONE_NEWNET);
+    if (error)
+        Abort(error);
 
-        if (NewMountNs)
-            cloneFlags |= CLONE_NEWNS;
+    error = PidFd.SetNs(CLONE_NEWPID);
+    if (error)
+        Abort(error);
 
-        /* Create UTS namspace if hostname is changed or isolate=true */
-        if (CT->Isolate || CT->Hostname != "")
-            cloneFlags |= CLONE_NEWUTS;
+    error = MntFd.SetNs(CLONE_NEWNS);
+    if (error)
+        Abort(error);
 
-        pid_t clonePid = clone(ChildFn, stack + sizeof(stack), cloneFlags, this);
+    error = RootFd.Chroot();
+    if (error)
+        Abort(error);
 
-        if (clonePid < 0) {
-            TError error(errno == ENOMEM ?
-                         EError::ResourceNotAvailable :
-                         EError::Unknown, errno, "clone()");
-            Abort(error);
-        }
+    error = CwdFd.Chdir();
+    if (error)
+        Abort(error);
 
-        if (!TripleFork)
+    if (TripleFork) {
+        /*
+         * Enter into pid-namespace. fork() hangs in libc if child pid
+         * collide with parent pid outside. vfork() has no such problem.
+         */
+        pid_t forkPid = vfork();
+        if (forkPid < 0)
+            Abort(TError::System("fork()"));
+
+        if (forkPid)
             _exit(EXIT_SUCCESS);
 
-        /* close other side before reading */
-        Sock2.Close();
-
-        pid_t appPid, appVPid;
-        error = MasterSock2.RecvPid(appPid, appVPid);
+        error = TUnixSocket::SocketPair(MasterSock2, Sock2);
         if (error)
             Abort(error);
 
-        /* Forward VPid */
-        ReportPid(appPid);
+        /* Report WPid */
+        ReportPid(GetTid());
+    }
 
-        /* Ack VPid */
-        error = MasterSock2.SendZero();
-        if (error)
-            Abort(error);
+    int cloneFlags = SIGCHLD;
+    if (Isolate)
+        cloneFlags |= CLONE_NEWPID | CLONE_NEWIPC;
 
-        MasterSock2.Close();
+    if (NewMountNs)
+        cloneFlags |= CLONE_NEWNS;
 
-        auto pid = std::to_string(clonePid);
-        const char * argv[] = {
-            "portoinit",
-            "--container",
-            CT->Name.c_str(),
-            "--wait",
-            pid.c_str(),
-            NULL,
-        };
-        auto envp = Env.Envp();
+    /* Create UTS namspace if hostname is changed or isolate=true */
+    if (Isolate || Hostname != "")
+        cloneFlags |= CLONE_NEWUTS;
 
-        error = PortoInitCapabilities.ApplyLimit();
-        if (error)
-            _exit(EXIT_FAILURE);
+    pid_t clonePid = clone(ChildFn, stack + sizeof(stack), cloneFlags, this);
+
+    if (clonePid < 0) {
+        TError error(errno == ENOMEM ?
+                     EError::ResourceNotAvailable :
+                     EError::Unknown, errno, "clone()");
+        Abort(error);
+    }
+
+    if (!TripleFork)
+        _exit(EXIT_SUCCESS);
+
+    /* close other side before reading */
+    Sock2.Close();
+
+    pid_t appPid, appVPid;
+    error = MasterSock2.RecvPid(appPid, appVPid);
+    if (error)
+        Abort(error);
+
+    /* Forward VPid */
+    ReportPid(appPid);
+
+    /* Ack VPid */
+    error = MasterSock2.SendZero();
+    if (error)
+        Abort(error);
 
-        TFile::CloseAll({PortoInit.Fd});
-        fexecve(PortoInit.Fd, (char *const *)argv, envp);
-        kill(clonePid, SIGKILL);
+    MasterSock2.Close();
+
+    auto pid = std::to_string(clonePid);
+    const char * argv[] = {
+        "portoinit",
+        "--container",
+        Name.c_str(),
+        "--wait",
+        pid.c_str(),
+        NULL,
+    };
+    auto envp = Env.Envp();
+
+    error = PortoInitCapabilities.ApplyLimit();
+    if (error)
         _exit(EXIT_FAILURE);
+
+    TFile::CloseAll({PortoInit.Fd});
+    fexecve(PortoInit.Fd, (char *const *)argv, envp);
+    kill(clonePid, SIGKILL);
+    _exit(EXIT_FAILURE);
+}
+
+TError TTaskEnv::Start() {
+    TError error, error2;
+    TUnixSocket spawnStatus;
+    bool spawned = false;
+
+    CT->Task.Pid = 0;
+    CT->TaskVPid = 0;
+    CT->WaitTask.Pid = 0;
+    CT->SeizeTask.Pid = 0;
+
+    error = TUnixSocket::SocketPair(MasterSock, Sock);
+    if (error)
+        return error;
+
+    // we want our child to have portod master as parent, so we
+    // are doing double fork here (fork + clone);
+    // we also need to know child pid so we are using pipe to send it back
+
+    TTask task;
+
+    if (TSpawner::Running()) {
+        /* Spawner cannot reach client fds, open streams outside */
+        error = OpenStreams();
+        if (error) {
+            Sock.Close();
+            return error;
+        }
+
+        /* Fork from spawner is cheaper than from huge portod */
+        error = TSpawner::SpawnTask(*this, task.Pid, spawnStatus);
+        if (error) {
+            Sock.Close();
+            L("Can't spawn child: {}", error);
+            return error;
+        }
+        spawned = true;
+    } else {
+        error = task.Fork();
+        if (error) {
+            Sock.Close();
+            L("Can't spawn child: {}", error);
+            return error;
+        }
+
+        if (!task.Pid)
+            StartForked();
     }
 
     Sock.Close();
 
+    for (int stream = 0; stream < 3; stream++)
+        StdFile[stream].Close();
+
     error = MasterSock.SetRecvTimeout(config().container().start_timeout_ms());
     if (error)
         goto kill_all;
@@ -680,7 +989,10 @@ TError TTaskEnv::Start() {
     if (error)
         goto kill_all;
 
-    error2 = task.Wait();
+    if (spawned)
+        error2 = TSpawner::WaitTask(spawnStatus);
+    else
+        error2 = task.Wait();
 
     /* Task was alive, even if it already died we'll get zombie */
     error = MasterSock.SendZero();
@@ -703,7 +1015,10 @@ kill_all:
     L("Task start failed: {}", error);
     if (task.Pid) {
         task.Kill(SIGKILL);
-        task.Wait();
+        if (spawned)
+            TSpawner::WaitTask(spawnStatus);
+        else
+            task.Wait();
     }
     CT->Task.Pid = 0;
     CT->TaskVPid = 0;
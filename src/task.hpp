@@ -10,16 +10,49 @@
 #include "cgroup.hpp"
 #include "env.hpp"
 #include "filesystem.hpp"
+#include "device.hpp"
+#include "stream.hpp"
 
 class TContainer;
 class TClient;
 
+namespace spawn {
+    class TTaskEnv;
+}
+
 struct TTaskEnv {
     std::shared_ptr<TContainer> CT;
     TClient *Client;
     TFile PortoInit;
     TMountNamespace Mnt;
 
+    /* Everything below is used in child and could be sent to spawner */
+    int Id;
+    std::string Name;
+    std::string Command;
+    bool Meta;
+    bool Isolate;
+    bool NetIsolate;
+    std::string Hostname;
+    bool SetResolvConf = false;
+    std::string ResolvConf;
+    std::vector<std::pair<std::string, std::string>> Sysctl;
+    TUlimit Ulimit;
+    TDevices Devices;
+    int OomScoreAdj;
+    int SchedNice;
+    int SchedPolicy;
+    int SchedPrio;
+    int IoPrio;
+    int MemPolicy = 0;
+    TBitMap MemPolicyNodes;
+    TCapabilities CapAmbient;
+    TCapabilities CapBound;
+    mode_t Umask;
+    TStdStream Stdin{0}, Stdout{1}, Stderr{2};
+    TFile StdFile[3];   /* opened outside in portod */
+    uint64_t AutoconfTimeout;
+
     TNamespaceFd IpcFd;
     TNamespaceFd UtsFd;
     TNamespaceFd NetFd;
@@ -42,8 +75,13 @@ struct TTaskEnv {
     int ReportStage = 0;
 
     TError OpenNamespaces(TContainer &ct);
+    TError OpenStreams();
+
+    void Pack(spawn::TTaskEnv &msg, std::vector<int> &fds) const;
+    TError Unpack(const spawn::TTaskEnv &msg, std::vector<int> &fds);
 
     TError Start();
+    void StartForked();
     void StartChild();
 
     TError ConfigureChild();
@@ -3,12 +3,23 @@
 #include "util/signal.hpp"
 #include "common.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
 extern "C" {
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <string.h>
+#include <sys/uio.h>
 #include <execinfo.h>
 #include <cxxabi.h>
 }
@@ -40,6 +51,45 @@ void InitStatistics() {
 
 TFile LogFile(STDOUT_FILENO);
 
+/*
+ * Single producer single consumer byte ring: owner thread appends
+ * whole lines, log writer drains them. Positions grow monotonically.
+ */
+struct TLogRing {
+    std::vector<char> Data;
+    const uint64_t Mask;
+    std::atomic<uint64_t> Head{0};  /* written by owner */
+    std::atomic<uint64_t> Tail{0};  /* written by log writer */
+    std::atomic<bool> Dead{false};  /* owner thread is gone */
+
+    TLogRing(size_t size) : Data(size), Mask(size - 1) {}
+};
+
+struct TLogRingOwner {
+    TLogRing *Ring = nullptr;
+    bool Writer = false;
+    time_t Time = 0;
+    std::string Name;
+    std::string Header;     /* "<time> <name>[<tid>]: " */
+
+    ~TLogRingOwner() {
+        if (Ring)
+            Ring->Dead.store(true, std::memory_order_release);
+    }
+};
+
+static thread_local TLogRingOwner LogThread;
+
+static std::atomic<bool> LogAsync{false};
+static size_t LogRingSize;
+static uint64_t LogFlushMs;
+
+static std::mutex LogWriterMutex;   /* protects LogRings, LogFile and draining */
+static std::condition_variable LogWriterCv;
+static std::thread LogWriterThread;
+static bool LogWriterStop;
+static std::vector<TLogRing *> LogRings;
+
 void OpenLog(const TPath &path) {
     int fd;
 
@@ -57,6 +107,7 @@ void OpenLog(const TPath &path) {
         fd = fcntl(fd, F_DUPFD_CLOEXEC, 3);
 
     if (fd >= 0) {
+        auto lock = std::unique_lock<std::mutex>(LogWriterMutex);
         if (LogFile.Fd != STDOUT_FILENO)
             LogFile.Close();
         LogFile.SetFd = fd;
@@ -69,7 +120,216 @@ void OpenLog(const TPath &path) {
     }
 }
 
+static void LogLost(int err, uint64_t lines, uint64_t bytes) {
+    if (!Statistics)
+        return;
+    if (err != ENOSPC &&
+            err != EDQUOT &&
+            err != EROFS &&
+            err != EIO &&
+            err != EUCLEAN)
+        Statistics->Warns++;
+    Statistics->LogLinesLost += lines;
+    Statistics->LogBytesLost += bytes;
+}
+
+static void WriteLogSync(const std::string &msg) {
+    if (!LogFile)
+        return;
+
+    TError error = LogFile.WriteAll(msg);
+    if (error)
+        LogLost(error.Errno, 1, msg.size());
+}
+
+/* Called under LogWriterMutex */
+static void WriteLogBatch(struct iovec *iov, int nr) {
+    while (nr && LogFile) {
+        ssize_t ret = writev(LogFile.Fd, iov, nr);
+        if (ret < 0 && errno == EINTR)
+            continue;
+
+        if (ret <= 0) {
+            int err = ret < 0 ? errno : EIO;
+            uint64_t lines = 0, bytes = 0;
+            for (int i = 0; i < nr; i++) {
+                const char *data = (const char *)iov[i].iov_base;
+                lines += std::count(data, data + iov[i].iov_len, '\n');
+                bytes += iov[i].iov_len;
+            }
+            LogLost(err, lines, bytes);
+            return;
+        }
+
+        while (nr && (size_t)ret >= iov->iov_len) {
+            ret -= iov->iov_len;
+            iov++;
+            nr--;
+        }
+
+        if (nr) {
+            iov->iov_base = (char *)iov->iov_base + ret;
+            iov->iov_len -= ret;
+        }
+    }
+}
+
+/* Called under LogWriterMutex */
+static void DrainLogRings() {
+    struct iovec iov[IOV_MAX];
+    std::vector<std::pair<TLogRing *, uint64_t>> batch;
+    int nr = 0;
+
+    auto flush = [&]() {
+        WriteLogBatch(iov, nr);
+        for (auto &it: batch)
+            it.first->Tail.store(it.second, std::memory_order_release);
+        batch.clear();
+        nr = 0;
+    };
+
+    for (auto ring: LogRings) {
+        uint64_t tail = ring->Tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->Head.load(std::memory_order_acquire);
+
+        if (head == tail)
+            continue;
+
+        if (nr + 2 > IOV_MAX)
+            flush();
+
+        uint64_t size = ring->Data.size();
+        uint64_t off = tail & ring->Mask;
+        uint64_t len = std::min(head - tail, size - off);
+
+        iov[nr].iov_base = &ring->Data[off];
+        iov[nr++].iov_len = len;
+        if (len < head - tail) {
+            iov[nr].iov_base = &ring->Data[0];
+            iov[nr++].iov_len = head - tail - len;
+        }
+
+        batch.emplace_back(ring, head);
+    }
+
+    flush();
+
+    /* Dead flag is set after last line thus head is final */
+    for (auto it = LogRings.begin(); it != LogRings.end(); ) {
+        auto ring = *it;
+        if (ring->Dead.load(std::memory_order_acquire) &&
+                ring->Tail.load(std::memory_order_relaxed) ==
+                ring->Head.load(std::memory_order_acquire)) {
+            delete ring;
+            it = LogRings.erase(it);
+        } else
+            ++it;
+    }
+}
+
+static void LogWriterWorker() {
+    LogThread.Writer = true;
+    SetProcessName("portod-log");
+
+    auto lock = std::unique_lock<std::mutex>(LogWriterMutex);
+    while (!LogWriterStop) {
+        DrainLogRings();
+        LogWriterCv.wait_for(lock, std::chrono::milliseconds(LogFlushMs));
+    }
+    DrainLogRings();
+}
+
+static void LogAtForkChild() {
+    /* writer thread does not exist in child */
+    LogAsync = false;
+
+    /* fork could happen while writer held the lock, rings are parent's */
+    new (&LogWriterMutex) std::mutex();
+    LogRings.clear();
+    LogThread.Ring = nullptr;
+}
+
+static void CopyToRing(TLogRing *ring, uint64_t pos, const char *data, size_t len) {
+    uint64_t size = ring->Data.size();
+    uint64_t off = pos & ring->Mask;
+    size_t part = std::min((uint64_t)len, size - off);
+
+    memcpy(&ring->Data[off], data, part);
+    if (part < len)
+        memcpy(&ring->Data[0], data + part, len - part);
+}
+
+/* Returns false if line must be written synchronously */
+static bool WriteLogAsync(const char *prefix, const std::string &log_msg) {
+    auto &thread = LogThread;
+
+    if (thread.Writer)
+        return false;
+
+    if (!thread.Ring) {
+        auto ring = new TLogRing(LogRingSize);
+        auto lock = std::unique_lock<std::mutex>(LogWriterMutex);
+        LogRings.push_back(ring);
+        thread.Ring = ring;
+    }
+
+    time_t now = time(nullptr);
+    std::string name = GetTaskName();
+    if (now != thread.Time || name != thread.Name) {
+        thread.Time = now;
+        thread.Name = name;
+        thread.Header = fmt::format("{} {}[{}]: ", FormatTime(now), name, GetTid());
+    }
+
+    auto ring = thread.Ring;
+    size_t prefix_len = strlen(prefix);
+    size_t len = thread.Header.size() + prefix_len + 1 + log_msg.size() + 1;
+
+    /* Huge lines would block ring for others */
+    if (len > ring->Data.size() / 4)
+        return false;
+
+    if (Statistics) {
+        Statistics->LogLines++;
+        Statistics->LogBytes += len;
+    }
+
+    uint64_t head = ring->Head.load(std::memory_order_relaxed);
+    uint64_t used = head - ring->Tail.load(std::memory_order_acquire);
+
+    if (used + len > ring->Data.size()) {
+        if (Statistics) {
+            Statistics->LogLinesDropped++;
+            Statistics->LogLinesLost++;
+            Statistics->LogBytesLost += len;
+        }
+        return true;
+    }
+
+    uint64_t pos = head;
+    CopyToRing(ring, pos, thread.Header.data(), thread.Header.size());
+    pos += thread.Header.size();
+    CopyToRing(ring, pos, prefix, prefix_len);
+    pos += prefix_len;
+    CopyToRing(ring, pos, " ", 1);
+    pos += 1;
+    CopyToRing(ring, pos, log_msg.data(), log_msg.size());
+    pos += log_msg.size();
+    CopyToRing(ring, pos, "\n", 1);
+
+    ring->Head.store(head + len, std::memory_order_release);
+
+    /* Wake writer when ring becomes half full */
+    if (used < ring->Data.size() / 2 && used + len >= ring->Data.size() / 2)
+        LogWriterCv.notify_one();
+
+    return true;
+}
+
 void WriteLog(const char *prefix, const std::string &log_msg) {
+    if (LogAsync && WriteLogAsync(prefix, log_msg))
+        return;
+
     std::string msg = fmt::format("{} {}[{}]: {} {}\n",
             FormatTime(time(nullptr)), GetTaskName(), GetTid(), prefix, log_msg);
 
@@ -78,19 +338,59 @@ void WriteLog(const char *prefix, const std::string &log_msg) {
         Statistics->LogBytes += msg.size();
     }
 
-    if (!LogFile)
+    WriteLogSync(msg);
+}
+
+void StartLogWriter(size_t ring_size, uint64_t flush_ms) {
+    static bool atfork = false;
+
+    if (!ring_size || LogWriterThread.joinable())
         return;
 
-    TError error = LogFile.WriteAll(msg);
-    if (error && Statistics) {
-        if (error.Errno != ENOSPC &&
-                error.Errno != EDQUOT &&
-                error.Errno != EROFS &&
-                error.Errno != EIO &&
-                error.Errno != EUCLEAN)
-            Statistics->Warns++;
-        Statistics->LogLinesLost++;
-        Statistics->LogBytesLost += msg.size();
+    if (!atfork) {
+        pthread_atfork(nullptr, nullptr, LogAtForkChild);
+        atfork = true;
+    }
+
+    LogRingSize = 4096;
+    while (LogRingSize < ring_size)
+        LogRingSize <<= 1;
+    LogFlushMs = std::max(flush_ms, (uint64_t)1);
+
+    LogWriterStop = false;
+    LogWriterThread = std::thread(LogWriterWorker);
+    LogAsync = true;
+}
+
+void StopLogWriter() {
+    if (!LogWriterThread.joinable())
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(LogWriterMutex);
+    LogWriterStop = true;
+    LogWriterCv.notify_all();
+    lock.unlock();
+
+    LogWriterThread.join();
+    LogAsync = false;
+
+    /* Lines appended while writer was stopping */
+    lock.lock();
+    DrainLogRings();
+}
+
+void FlushLog() {
+    if (!LogAsync || LogThread.Writer)
+        return;
+
+    /* Could be called at crash, do not wait forever */
+    for (int i = 0; i < 100; i++) {
+        auto lock = std::unique_lock<std::mutex>(LogWriterMutex, std::try_to_lock);
+        if (lock) {
+            DrainLogRings();
+            return;
+        }
+        usleep(10000);
     }
 }
 
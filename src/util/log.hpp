@@ -14,6 +14,14 @@ void OpenLog(const TPath &path);
 void WriteLog(const char *prefix, const std::string &log_msg);
 void Stacktrace();
 
+/*
+ * Lines are copied into per-thread rings and written by separate thread.
+ * Until start and in forked children log is written synchronously.
+ */
+void StartLogWriter(size_t ring_size, uint64_t flush_ms);
+void StopLogWriter();
+void FlushLog();
+
 struct TStatistics {
     std::atomic<uint64_t> PortoStarts;
     std::atomic<uint64_t> Errors;
@@ -61,6 +69,10 @@ struct TStatistics {
     std::atomic<uint64_t> Taints;
     std::atomic<uint64_t> ContainersTainted;
     std::atomic<uint64_t> LongestRoRequest;
+    std::atomic<uint64_t> VolumeTrashReclaimed;
+    std::atomic<uint64_t> VolumeTrashEntries;
+    std::atomic<uint64_t> VolumeTrashRate;
+    std::atomic<uint64_t> LogLinesDropped;
 
     /* --- add new fields at the end --- */
 };
@@ -36,6 +36,12 @@
  */
 
 #include "md5.hpp"
+#include "xxhash.hpp"
+
+extern "C" {
+#include <fcntl.h>
+#include <unistd.h>
+}
 
 /* Any 32-bit or wider unsigned integer data type will do */
 typedef unsigned int MD5_u32plus;
@@ -294,24 +300,61 @@ static void MD5_Final(unsigned char *result, MD5_CTX *ctx)
     memset(ctx, 0, sizeof(*ctx));
 }
 
-TError Md5Sum(TFile &file, std::string &sum) {
+static std::string HexDigest(const unsigned char *bin, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+    std::string str(len * 2, '0');
+
+    for (size_t i = 0; i < len; i++) {
+        str[i * 2] = hex[bin[i] >> 4];
+        str[i * 2 + 1] = hex[bin[i] & 15];
+    }
+
+    return str;
+}
+
+TError Md5Sum(TFile &file, std::string &sum, std::string *xxh64,
+              std::vector<char> &buffer) {
     MD5_CTX ctx;
+    TXxHash64 xxh;
     unsigned char bin[16];
-    std::string buf;
-    TError error;
+
+    if (buffer.empty())
+        buffer.resize(MD5_BUFFER_SIZE);
+
+    (void)posix_fadvise(file.Fd, 0, 0, POSIX_FADV_SEQUENTIAL);
 
     MD5_Init(&ctx);
     while (1) {
-        error = file.Read(buf);
-        if (error)
-            return error;
-        if (!buf.size())
+        ssize_t len = read(file.Fd, buffer.data(), buffer.size());
+        if (len < 0) {
+            if (errno == EINTR)
+                continue;
+            return TError::System("read");
+        }
+        if (!len)
             break;
-        MD5_Update(&ctx, buf.c_str(), buf.size());
+        MD5_Update(&ctx, buffer.data(), len);
+        if (xxh64)
+            xxh.Update(buffer.data(), len);
     }
     MD5_Final(bin, &ctx);
-    sum = "";
-    for (int i = 0; i < 16; ++i)
-        sum += fmt::format("{:02x}", bin[i]);
+    sum = HexDigest(bin, sizeof(bin));
+    if (xxh64)
+        *xxh64 = xxh.HexDigest();
     return OK;
 }
+
+TError Md5Sum(TFile &file, std::string &sum) {
+    std::vector<char> buffer;
+    return Md5Sum(file, sum, nullptr, buffer);
+}
+
+std::string Md5Sum(const std::string &data) {
+    MD5_CTX ctx;
+    unsigned char bin[16];
+
+    MD5_Init(&ctx);
+    MD5_Update(&ctx, data.data(), data.size());
+    MD5_Final(bin, &ctx);
+    return HexDigest(bin, sizeof(bin));
+}
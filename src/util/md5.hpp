@@ -1,5 +1,14 @@
 #pragma once
 
+#include <vector>
 #include "util/path.hpp"
 
+constexpr size_t MD5_BUFFER_SIZE = 1 << 20;
+
 TError Md5Sum(TFile &file, std::string &sum);
+
+/* Computes optional xxh64 in the same pass, buffer is reused between calls */
+TError Md5Sum(TFile &file, std::string &sum, std::string *xxh64,
+              std::vector<char> &buffer);
+
+std::string Md5Sum(const std::string &data);
@@ -21,6 +21,7 @@ public:
     TError Open(TPath path);
     TError Open(pid_t pid, std::string type);
     int GetFd() const { return Fd; }
+    void SetFd(int fd) { Close(); Fd = fd; }
     void Close();
     TError SetNs(int type = 0) const;
     TError Chroot() const;
@@ -5,6 +5,7 @@
 #include "util/string.hpp"
 #include "util/unix.hpp"
 #include "util/log.hpp"
+#include "util/tree.hpp"
 
 extern "C" {
 #include <unistd.h>
@@ -481,43 +482,11 @@ TError TPath::ClearDirectory() const {
 }
 
 TError TFile::ClearDirectory() const {
-    TPathWalk walk;
-    TError error;
-
-    error = Chdir();
-    if (error)
-        return error;
-
-    error = walk.OpenNoStat(".");
-    while (!error) {
-        error = walk.Next();
-        if (error || !walk.Path)
-            break;
-        if (walk.Directory) {
-            if (!walk.Postorder || walk.Path == ".")
-                continue;
-            error = RmdirAt(walk.Path);
-        } else
-            error = UnlinkAt(walk.Path);
-    }
-
-    (void)TPath("/").Chdir();
-    return error;
+    return ClearTree(*this);
 }
 
 TError TFile::RemoveAt(const TPath &path) const {
-    TError error;
-    TFile dir;
-
-    error = dir.OpenAt(*this, path, O_RDONLY | O_CLOEXEC | O_DIRECTORY | O_NOCTTY | O_NOFOLLOW, 0);
-    if (error) {
-        error = UnlinkAt(path);
-    } else {
-        error = dir.ClearDirectory();
-        if (!error)
-            error = RmdirAt(path);
-    }
-    return error;
+    return RemoveTree(*this, path);
 }
 
 TError TPath::RemoveAll() const {
@@ -1492,6 +1461,12 @@ TError TFile::SetXAttr(const std::string &name, const std::string &value) const
     return OK;
 }
 
+TError TFile::RemoveXAttr(const std::string &name) const {
+    if (syscall(SYS_fremovexattr, Fd, name.c_str()))
+        return TError::System("removexattr {}", name);
+    return OK;
+}
+
 TError TFile::WalkFollow(const TFile &dir, const TPath &path) {
     if (path.IsAbsolute())
         return TError(EError::InvalidValue, "Absolute path: " + path.Path);
@@ -279,6 +279,7 @@ public:
     TError Touch() const;
     TError GetXAttr(const std::string &name, std::string &value) const;
     TError SetXAttr(const std::string &name, const std::string &value) const;
+    TError RemoveXAttr(const std::string &name) const;
     TError WalkFollow(const TFile &dir, const TPath &path);
     TError WalkStrict(const TFile &dir, const TPath &path);
     TError Chdir() const;
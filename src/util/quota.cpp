@@ -1,5 +1,6 @@
 #include "quota.hpp"
 #include "log.hpp"
+#include "tree.hpp"
 #include <mutex>
 
 extern "C" {
@@ -17,6 +18,23 @@ extern "C" {
 #define PRJQUOTA 2
 #endif
 
+#ifndef Q_GETNEXTQUOTA
+#define Q_GETNEXTQUOTA 0x800009
+
+struct if_nextdqblk {
+    __u64 dqb_bhardlimit;
+    __u64 dqb_bsoftlimit;
+    __u64 dqb_curspace;
+    __u64 dqb_ihardlimit;
+    __u64 dqb_isoftlimit;
+    __u64 dqb_curinodes;
+    __u64 dqb_btime;
+    __u64 dqb_itime;
+    __u32 dqb_valid;
+    __u32 dqb_id;
+};
+#endif
+
 #ifndef DQF_SYS_FILE
 #define DQF_SYS_FILE    0x10000
 #endif
@@ -171,49 +189,38 @@ TError TProjectQuota::GetProjectId(const TPath &path, uint32_t &id) {
     return OK;
 }
 
-TError TProjectQuota::SetProjectIdOne(const TPath &path, uint32_t id) {
+TError TProjectQuota::SetProjectIdFd(int fd, uint32_t id) {
     struct fsxattr attr;
-    int fd, ret;
-    TError error;
-
-    fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY | O_NOFOLLOW | O_NOATIME | O_NONBLOCK);
-    if (fd < 0 && errno == EPERM)
-        fd = open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY | O_NOFOLLOW | O_NONBLOCK);
-    if (fd < 0)
-        return TError::System("Cannot open: " + path.ToString());
+    int ret;
 
     ret = ioctl(fd, FS_IOC_FSGETXATTR, &attr);
-    if (!ret) {
-        attr.fsx_xflags |= FS_XFLAG_PROJINHERIT;
-        attr.fsx_projid = id;
-        ret = ioctl(fd, FS_IOC_FSSETXATTR, &attr);
-    }
     if (ret)
-        error = TError::System("Cannot set quota id: " + path.ToString());
-    close(fd);
-    return error;
+        return TError::System("ioctl(FS_IOC_FSGETXATTR)");
+
+    attr.fsx_xflags |= FS_XFLAG_PROJINHERIT;
+    attr.fsx_projid = id;
+    ret = ioctl(fd, FS_IOC_FSSETXATTR, &attr);
+    if (ret)
+        return TError::System("ioctl(FS_IOC_FSSETXATTR)");
+
+    return OK;
 }
 
-TError TProjectQuota::SetProjectIdAll(const TPath &path, uint32_t id) {
-    TPathWalk walk;
+/* Directories are walked in parallel, progress and abort via throttle */
+TError TProjectQuota::SetProjectIdAll(const TPath &path, uint32_t id,
+                                      TTreeThrottle *throttle) {
+    TFile dir;
     TError error;
 
-    error = walk.OpenNoStat(path);
+    error = dir.OpenDir(path);
     if (error)
         return error;
 
-    while (1) {
-        error = walk.Next();
-        if (error || !walk.Path)
-            return error;
-        error = SetProjectIdOne(walk.Path, id);
-        if (error) {
-            /* ignore errors for non-regular and non-directory */
-            if (walk.Directory || walk.Path.IsRegularStrict())
-                return error;
-            L_VERBOSE("SetProjectIdAll {}", error);
-        }
-    }
+    error = ApplyTree(dir, [id](int fd) -> TError {
+        return SetProjectIdFd(fd, id);
+    }, Threads, throttle);
+    if (error)
+        return TError(error, "Cannot set quota id at {}", path);
 
     return OK;
 }
@@ -353,8 +360,12 @@ TError TProjectQuota::Create() {
                     Path.ToString() + " already in project " +
                     std::to_string(CurrentId));
 
-        /* Reset current project id */
-        error = SetProjectIdAll(Path, 0);
+        /* Reset current project id, build progress counts only move below */
+        if (Throttle)
+            Throttle->Quiet = true;
+        error = SetProjectIdAll(Path, 0, Throttle);
+        if (Throttle)
+            Throttle->Quiet = false;
         if (error)
             return error;
     }
@@ -388,7 +399,7 @@ TError TProjectQuota::Create() {
     quotactl(QCMD(Q_SYNC, PRJQUOTA), Device.c_str(), 0, NULL);
 
     /* Move files into project */
-    error = SetProjectIdAll(Path, ProjectId);
+    error = SetProjectIdAll(Path, ProjectId, Throttle);
     if (error)
         (void)Destroy();
 
@@ -433,7 +444,7 @@ TError TProjectQuota::Destroy() {
     if (error)
         return error;
 
-    error = SetProjectIdAll(Path, 0);
+    error = SetProjectIdAll(Path, 0, nullptr);
     if (error)
         return error;
 
@@ -449,17 +460,7 @@ TError TProjectQuota::Destroy() {
     return OK;
 }
 
-TError TProjectQuota::StatFS(TStatFS &result) {
-    TError error;
-
-    error = Path.StatFS(result);
-    if (error)
-        return error;
-
-    error = Load();
-    if (error)
-        return error;
-
+void TProjectQuota::ApplyLimits(TStatFS &result) const {
     result.SpaceUsage = SpaceUsage;
 
     if (SpaceLimit && SpaceLimit < SpaceUsage + result.SpaceAvail) {
@@ -477,6 +478,71 @@ TError TProjectQuota::StatFS(TStatFS &result) {
         else
             result.InodeAvail = 0;
     }
+}
+
+TError TProjectQuota::StatFS(TStatFS &result) {
+    TError error;
+
+    error = Path.StatFS(result);
+    if (error)
+        return error;
+
+    error = Load();
+    if (error)
+        return error;
+
+    ApplyLimits(result);
+
+    return OK;
+}
+
+/*
+ * Q_GETNEXTQUOTA returns next project with usage or limits starting
+ * from given id, generic interface works for both ext4 and xfs.
+ */
+TError TProjectQuota::LoadAll(std::map<uint32_t, TProjectUsage> &usage) {
+    struct if_nextdqblk quota;
+    uint32_t id = 0;
+    TError error;
+
+    error = FindDevice();
+    if (error)
+        return error;
+
+    while (!quotactl(QCMD(Q_GETNEXTQUOTA, PRJQUOTA), Device.c_str(),
+                     id, (caddr_t)&quota)) {
+        auto &use = usage[quota.dqb_id];
+
+        use.SpaceLimit = quota.dqb_bhardlimit * QIF_DQBLKSIZE;
+        use.SpaceUsage = quota.dqb_curspace;
+        use.InodeLimit = quota.dqb_ihardlimit;
+        use.InodeUsage = quota.dqb_curinodes;
+
+        if (quota.dqb_id == UINT32_MAX)
+            return OK;
+        id = quota.dqb_id + 1;
+    }
+
+    if (errno != ENOENT)
+        return TError::System("Cannot get quota state");
+
+    return OK;
+}
+
+TError TProjectQuota::StatFS(TStatFS &result, const TStatFS &fs,
+                             const std::map<uint32_t, TProjectUsage> &usage) {
+    auto it = usage.find(ProjectId);
+    if (it == usage.end())
+        return StatFS(result);
+
+    result = fs;
+
+    SpaceLimit = it->second.SpaceLimit;
+    SpaceUsage = it->second.SpaceUsage;
+    InodeLimit = it->second.InodeLimit;
+    InodeUsage = it->second.InodeUsage;
+
+    ApplyLimits(result);
 
     return OK;
 }
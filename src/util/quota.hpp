@@ -1,7 +1,17 @@
 #pragma once
 
+#include <map>
+
 #include "util/error.hpp"
 #include "util/path.hpp"
+#include "util/tree.hpp"
+
+struct TProjectUsage {
+    uint64_t SpaceLimit = 0;
+    uint64_t SpaceUsage = 0;
+    uint64_t InodeLimit = 0;
+    uint64_t InodeUsage = 0;
+};
 
 class TProjectQuota {
     static constexpr const char * PROJECT_QUOTA_FILE = "quota.project";
@@ -11,14 +21,16 @@ class TProjectQuota {
     TPath RootPath;
     std::string Type;
 
-    TError FindProject();
     TError FindDevice();
 
     static TError InitProjectQuotaFile(const TPath &path);
     static TError GetProjectId(const TPath &path, uint32_t &id);
-    static TError SetProjectIdOne(const TPath &path, uint32_t id);
-    static TError SetProjectIdAll(const TPath &path, uint32_t id);
+    static TError SetProjectIdFd(int fd, uint32_t id);
+    TError SetProjectIdAll(const TPath &path, uint32_t id,
+                           TTreeThrottle *throttle);
     static TError InventProjectId(const TPath &path, uint32_t &id);
+
+    void ApplyLimits(TStatFS &result) const;
 public:
     TPath Path;
 
@@ -28,15 +40,29 @@ public:
     uint64_t InodeLimit = 0;
     uint64_t InodeUsage = 0;
 
+    /* Threads for walking tree, progress and abort of Create */
+    unsigned Threads = 1;
+    TTreeThrottle *Throttle = nullptr;
+
     TProjectQuota(const TPath &path) { Path = path; }
     TError Enable();
 
     bool Exists();
 
+    /* Fills ProjectId of Path */
+    TError FindProject();
+
     TError Load();
     TError Create();
     TError Resize();
     TError Destroy();
 
     TError StatFS(TStatFS &result);
+
+    /* Usage of all projects at filesystem of Path, keyed by project id */
+    TError LoadAll(std::map<uint32_t, TProjectUsage> &usage);
+
+    /* StatFS of ProjectId with filesystem stat and usage preloaded by LoadAll */
+    TError StatFS(TStatFS &result, const TStatFS &fs,
+                  const std::map<uint32_t, TProjectUsage> &usage);
 };
@@ -12,6 +12,7 @@ extern "C" {
 void Crash() {
     L_ERR("Crashed");
     Stacktrace();
+    FlushLog();
 
     /* that's all */
     Signal(SIGABRT, SIG_DFL);
@@ -25,6 +26,7 @@ void FatalSignal(int sig) {
 
     L_ERR("Fatal signal: {}", std::string(strsignal(sig)));
     Stacktrace();
+    FlushLog();
 
     /* ok, die */
     Signal(sig, SIG_DFL);
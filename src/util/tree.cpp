@@ -0,0 +1,868 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "util/tree.hpp"
+#include "util/log.hpp"
+#include "util/unix.hpp"
+
+extern "C" {
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/limits.h>
+}
+
+#ifndef FICLONE
+#define FICLONE _IOW(0x94, 9, int)
+#endif
+
+#define TREE_OPEN_FLAGS (O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC | O_NOCTTY)
+
+namespace {
+
+/*
+ * Directory in walk. File descriptors are held only by the thread which
+ * currently works with the directory: walk descends by openat(name) and
+ * ascends by openat("..") checked against saved inode, thus depth of tree
+ * does not consume descriptors or stack.
+ */
+struct TTreeNode {
+    std::shared_ptr<TTreeNode> Parent;
+    std::string Name;
+    TFile Src;
+    TFile Dst;
+    struct stat Stat;
+    dev_t DstDev = 0;
+    ino_t DstIno = 0;
+    /* Subdirectories found by scan, walked in order */
+    std::vector<std::string> Subdirs;
+    size_t Next = 0;
+    /* Self plus subdirectories still in work */
+    std::atomic<int> Pending{1};
+};
+
+class TTreeWalk {
+public:
+    virtual ~TTreeWalk() {}
+    TError Run(std::shared_ptr<TTreeNode> root, unsigned threads);
+
+    TTreeThrottle *Throttle = nullptr;
+
+protected:
+    bool NeedStat = false;
+
+    /* Non-directory entry, st is null unless NeedStat */
+    virtual TError Entry(TTreeNode &dir, const char *name, const struct stat *st) = 0;
+
+    /* Subdirectory is opened, called before walking into it */
+    virtual TError Enter(TTreeNode &, TTreeNode &) { return OK; }
+
+    /* Subdirectory on other filesystem */
+    virtual TError MountPoint(TTreeNode &, TTreeNode &child) {
+        return TError(EError::Busy, EBUSY, "Mountpoint {}", child.Name);
+    }
+
+    /* Called once for each directory after all its content,
+     * parent is opened parent directory, null for root */
+    virtual TError Leave(TTreeNode &node, const TFile *parent) = 0;
+
+private:
+    std::mutex Mutex;
+    std::condition_variable Cond;
+    std::deque<std::shared_ptr<TTreeNode>> Queue;
+    unsigned Threads = 1;
+    unsigned Busy = 0;
+    std::atomic<bool> Failed{false};
+    TError Error;
+    dev_t Dev;
+    int MountId;
+    uint64_t StartTime;
+    std::atomic<uint64_t> Processed{0};
+
+    void Fail(const TError &error);
+    void Account(unsigned batch);
+    bool Share(const std::shared_ptr<TTreeNode> &node);
+    TError Scan(TTreeNode &node);
+    TError OpenChild(TTreeNode &node, const std::shared_ptr<TTreeNode> &child, bool &enter);
+    TError OpenParent(const TTreeNode &node, TFile &src, TFile &dst);
+    void Release(std::shared_ptr<TTreeNode> node);
+    void Walk(std::shared_ptr<TTreeNode> start);
+    void Worker();
+};
+
+/* Path of directory relative to root of walk */
+std::string NodePath(const TTreeNode &node) {
+    std::string path;
+    for (auto n = &node; n->Parent; n = n->Parent.get())
+        path = path.empty() ? n->Name : n->Name + "/" + path;
+    return path;
+}
+
+void MoveFile(TFile &to, TFile &from) {
+    to.Close();
+    to.SetFd = from.Fd;
+    from.SetFd = -1;
+}
+
+void TTreeWalk::Fail(const TError &error) {
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (!Failed) {
+        Error = error;
+        Failed = true;
+    }
+}
+
+/* Entries are accounted in batches to not bounce shared counters */
+#define TREE_ACCOUNT_BATCH 64
+
+void TTreeWalk::Account(unsigned batch) {
+    uint64_t entries = Processed += batch;
+
+    if (!Throttle->Quiet)
+        Throttle->Entries += batch;
+
+    while (!Failed) {
+        if (Throttle->Abort) {
+            Fail(TError(EError::Unknown, ECANCELED, "Tree walk aborted"));
+            break;
+        }
+        if (!Throttle->Rate)
+            break;
+        uint64_t due = StartTime + entries * 1000 / Throttle->Rate;
+        uint64_t now = GetCurrentTimeMs();
+        if (due <= now)
+            break;
+        usleep(std::min(due - now, (uint64_t)100) * 1000);
+    }
+}
+
+/* Queue subtree if somebody is idle, otherwise walk it in place */
+bool TTreeWalk::Share(const std::shared_ptr<TTreeNode> &node) {
+    if (Threads < 2)
+        return false;
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (Queue.size() + Busy >= Threads)
+        return false;
+    Queue.push_back(node);
+    Cond.notify_one();
+    return true;
+}
+
+/* Reads whole directory and closes it, handles all non-directories */
+TError TTreeWalk::Scan(TTreeNode &node) {
+    unsigned batch = 0;
+    struct dirent *de;
+    TError error;
+    DIR *dir;
+
+    /* Separate open file description for independent position */
+    int fd = openat(node.Src.Fd, ".", TREE_OPEN_FLAGS);
+    dir = fd < 0 ? nullptr : fdopendir(fd);
+    if (!dir) {
+        error = TError::System("Cannot open directory {}", node.Name);
+        if (fd >= 0)
+            close(fd);
+        return error;
+    }
+
+    while (!Failed) {
+        errno = 0;
+        de = readdir(dir);
+        if (!de) {
+            if (errno)
+                error = TError::System("readdir {}", node.Name);
+            break;
+        }
+
+        if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, ".."))
+            continue;
+
+        if (Throttle && ++batch == TREE_ACCOUNT_BATCH) {
+            Account(batch);
+            batch = 0;
+            if (Failed)
+                break;
+        }
+
+        bool isdir = de->d_type == DT_DIR;
+        struct stat st;
+
+        if (NeedStat || de->d_type == DT_UNKNOWN) {
+            if (fstatat(node.Src.Fd, de->d_name, &st, AT_SYMLINK_NOFOLLOW)) {
+                if (errno == ENOENT)
+                    continue;
+                error = TError::System("stat {}", de->d_name);
+                break;
+            }
+            isdir = S_ISDIR(st.st_mode);
+        }
+
+        if (isdir) {
+            node.Subdirs.emplace_back(de->d_name);
+            continue;
+        }
+
+        error = Entry(node, de->d_name, NeedStat ? &st : nullptr);
+        if (error)
+            break;
+    }
+
+    closedir(dir);
+
+    if (Throttle && batch)
+        Account(batch);
+
+    return error;
+}
+
+/* Opens subdirectory and enters it unless this is mountpoint */
+TError TTreeWalk::OpenChild(TTreeNode &node, const std::shared_ptr<TTreeNode> &child, bool &enter) {
+    TError error;
+
+    enter = false;
+
+    error = child->Src.OpenAt(node.Src, child->Name, TREE_OPEN_FLAGS, 0);
+    if (error)
+        return error.Errno == ENOENT ? OK : error;
+
+    error = child->Src.Stat(child->Stat);
+    if (error)
+        return error;
+
+    int mnt = child->Stat.st_dev != Dev ? -2 : child->Src.GetMountId();
+    if (mnt == -2 || (mnt >= 0 && MountId >= 0 && mnt != MountId)) {
+        error = MountPoint(node, *child);
+        child->Src.Close();
+        child->Dst.Close();
+        return error;
+    }
+
+    error = Enter(node, *child);
+    if (error)
+        return error;
+
+    if (child->Dst) {
+        struct stat st;
+        error = child->Dst.Stat(st);
+        if (error)
+            return error;
+        child->DstDev = st.st_dev;
+        child->DstIno = st.st_ino;
+    }
+
+    enter = true;
+    return OK;
+}
+
+/* Opens parent directories via ".." and checks that they were not moved */
+TError TTreeWalk::OpenParent(const TTreeNode &node, TFile &src, TFile &dst) {
+    const TTreeNode &parent = *node.Parent;
+    struct stat st;
+    TError error;
+
+    error = src.OpenAt(node.Src, "..", TREE_OPEN_FLAGS, 0);
+    if (!error)
+        error = src.Stat(st);
+    if (error)
+        return error;
+    if (st.st_dev != parent.Stat.st_dev || st.st_ino != parent.Stat.st_ino)
+        return TError(EError::Busy, EBUSY, "Directory {} moved during walk", node.Name);
+
+    if (!node.Dst)
+        return OK;
+
+    error = dst.OpenAt(node.Dst, "..", TREE_OPEN_FLAGS, 0);
+    if (!error)
+        error = dst.Stat(st);
+    if (error)
+        return error;
+    if (st.st_dev != parent.DstDev || st.st_ino != parent.DstIno)
+        return TError(EError::Busy, EBUSY, "Directory {} moved during walk", node.Name);
+
+    return OK;
+}
+
+/*
+ * Drops one reference to directory opened by caller. The last one leaves
+ * it and goes up while parents are complete too.
+ */
+void TTreeWalk::Release(std::shared_ptr<TTreeNode> node) {
+    TFile src, dst;
+
+    /* Until the last reference other thread might work in this node */
+    MoveFile(src, node->Src);
+    MoveFile(dst, node->Dst);
+
+    while (node) {
+        if (--node->Pending)
+            return;
+
+        MoveFile(node->Src, src);
+        MoveFile(node->Dst, dst);
+
+        if (!Failed && node->Parent) {
+            TError error = OpenParent(*node, src, dst);
+            if (error)
+                Fail(error);
+        }
+
+        if (!Failed) {
+            TError error = Leave(*node, node->Parent ? &src : nullptr);
+            if (error)
+                Fail(error);
+        }
+
+        node->Src.Close();
+        node->Dst.Close();
+
+        if (Failed)
+            return;
+
+        node = node->Parent;
+    }
+}
+
+/*
+ * Depth-first walk without recursion. Only the directory on top of the
+ * stack is open, parents are reopened through ".." when walk goes back.
+ */
+void TTreeWalk::Walk(std::shared_ptr<TTreeNode> start) {
+    std::vector<std::shared_ptr<TTreeNode>> stack;
+    TError error;
+
+    error = Scan(*start);
+    if (error) {
+        Fail(error);
+        return;
+    }
+
+    stack.push_back(start);
+    start = nullptr;
+
+    while (!stack.empty() && !Failed) {
+        auto node = stack.back();
+
+        if (node->Next < node->Subdirs.size()) {
+            auto child = std::make_shared<TTreeNode>();
+            bool enter;
+
+            child->Parent = node;
+            child->Name = std::move(node->Subdirs[node->Next++]);
+
+            error = OpenChild(*node, child, enter);
+            if (error) {
+                Fail(error);
+                break;
+            }
+            if (!enter)
+                continue;
+
+            node->Pending++;
+            if (Share(child))
+                continue;
+
+            node->Src.Close();
+            node->Dst.Close();
+
+            error = Scan(*child);
+            if (error) {
+                Fail(error);
+                break;
+            }
+
+            stack.push_back(child);
+            continue;
+        }
+
+        node->Subdirs.clear();
+        node->Subdirs.shrink_to_fit();
+        stack.pop_back();
+
+        if (stack.empty()) {
+            Release(node);
+            break;
+        }
+
+        /* Reopen parent which is walked by this thread before release */
+        auto &parent = stack.back();
+        error = OpenParent(*node, parent->Src, parent->Dst);
+        if (error) {
+            Fail(error);
+            break;
+        }
+
+        TFile src, dst;
+        MoveFile(src, node->Src);
+        MoveFile(dst, node->Dst);
+
+        /* Subtree shared with other threads, the last one will leave it */
+        if (--node->Pending)
+            continue;
+
+        MoveFile(node->Src, src);
+        MoveFile(node->Dst, dst);
+
+        error = Leave(*node, &parent->Src);
+        node->Src.Close();
+        node->Dst.Close();
+        if (error) {
+            Fail(error);
+            break;
+        }
+
+        /* Never drops to zero: this thread holds reference of parent */
+        --parent->Pending;
+    }
+}
+
+void TTreeWalk::Worker() {
+    std::unique_lock<std::mutex> lock(Mutex);
+
+    while (true) {
+        if (Queue.empty()) {
+            if (!Busy)
+                break;
+            Cond.wait(lock);
+            continue;
+        }
+
+        auto node = Queue.front();
+        Queue.pop_front();
+        Busy++;
+
+        lock.unlock();
+        if (!Failed)
+            Walk(node);
+        node = nullptr;
+        lock.lock();
+
+        if (!--Busy && Queue.empty())
+            Cond.notify_all();
+    }
+}
+
+TError TTreeWalk::Run(std::shared_ptr<TTreeNode> root, unsigned threads) {
+    std::vector<std::thread> workers;
+
+    Threads = std::max(threads, 1u);
+    Dev = root->Stat.st_dev;
+    MountId = root->Src.GetMountId();
+
+    if (root->Dst) {
+        struct stat st;
+        TError error = root->Dst.Stat(st);
+        if (error)
+            return error;
+        root->DstDev = st.st_dev;
+        root->DstIno = st.st_ino;
+    }
+
+    if (Throttle)
+        StartTime = GetCurrentTimeMs();
+
+    Queue.push_back(root);
+    root = nullptr;
+
+    for (unsigned i = 1; i < Threads; i++)
+        workers.emplace_back(&TTreeWalk::Worker, this);
+
+    Worker();
+
+    for (auto &thread: workers)
+        thread.join();
+
+    return Error;
+}
+
+class TTreeRemove : public TTreeWalk {
+public:
+    TTreeRemove(const TFile *parent) : Parent(parent) {}
+
+private:
+    const TFile *Parent;
+
+    TError Entry(TTreeNode &dir, const char *name, const struct stat *) override {
+        if (unlinkat(dir.Src.Fd, name, 0) && errno != ENOENT)
+            return TError::System("Cannot unlink {}", name);
+        return OK;
+    }
+
+    TError Leave(TTreeNode &node, const TFile *parent) override {
+        if (!parent)
+            parent = Parent;
+        if (parent && unlinkat(parent->Fd, node.Name.c_str(), AT_REMOVEDIR) &&
+                errno != ENOENT)
+            return TError::System("Cannot rmdir {}", node.Name);
+        return OK;
+    }
+};
+
+class TTreeCopy : public TTreeWalk {
+public:
+    TTreeCopy(const TFile &dst) : Dst(dst) {
+        NeedStat = true;
+    }
+
+private:
+    const TFile &Dst;
+    std::mutex LinksMutex;
+    std::map<std::pair<dev_t, ino_t>, std::string> Links;
+
+    static std::string RelativePath(const TTreeNode &dir, const char *name);
+    static TError CopyData(const TFile &src, const TFile &dst, off_t size);
+    static void CopyXattrs(int src, int dst);
+    static TError CopyAttrs(int src, int dst, const struct stat &st);
+    TError CreateFile(TTreeNode &dir, const char *name,
+                      const struct stat &st, TFile &dst, bool &linked);
+
+    TError Entry(TTreeNode &dir, const char *name, const struct stat *st) override;
+    TError Enter(TTreeNode &dir, TTreeNode &child) override;
+    TError MountPoint(TTreeNode &dir, TTreeNode &child) override;
+    TError Leave(TTreeNode &node, const TFile *parent) override;
+};
+
+std::string TTreeCopy::RelativePath(const TTreeNode &dir, const char *name) {
+    std::string path = name;
+    for (auto node = &dir; node->Parent; node = node->Parent.get())
+        path = node->Name + "/" + path;
+    return path;
+}
+
+TError TTreeCopy::CopyData(const TFile &src, const TFile &dst, off_t size) {
+    std::vector<char> buf;
+    off_t pos = 0;
+
+    if (!size || !ioctl(dst.Fd, FICLONE, src.Fd))
+        return OK;
+
+    while (pos < size) {
+        off_t beg = lseek(src.Fd, pos, SEEK_DATA);
+        if (beg < 0 && errno == ENXIO)
+            break;
+        off_t end = beg < 0 ? size : lseek(src.Fd, beg, SEEK_HOLE);
+        if (beg < 0)
+            beg = pos;
+        if (end < 0 || end > size)
+            end = size;
+
+        while (beg < end) {
+            ssize_t ret = -1;
+#ifdef SYS_copy_file_range
+            loff_t off_in = beg, off_out = beg;
+            if (buf.empty())
+                ret = syscall(SYS_copy_file_range, src.Fd, &off_in,
+                              dst.Fd, &off_out, end - beg, 0);
+            if (ret < 0 && (errno == ENOSYS || errno == EXDEV ||
+                            errno == EINVAL || errno == EOPNOTSUPP))
+                buf.resize(1 << 20);
+#else
+            buf.resize(1 << 20);
+#endif
+            if (!buf.empty()) {
+                ret = pread(src.Fd, buf.data(), std::min((off_t)buf.size(), end - beg), beg);
+                if (ret > 0 && pwrite(dst.Fd, buf.data(), ret, beg) != ret)
+                    ret = -1;
+            }
+            if (ret < 0 && errno == EINTR)
+                continue;
+            if (ret < 0)
+                return TError::System("Cannot copy data");
+            if (!ret)
+                break;
+            beg += ret;
+        }
+
+        pos = end;
+    }
+
+    if (ftruncate(dst.Fd, size))
+        return TError::System("Cannot truncate");
+
+    return OK;
+}
+
+void TTreeCopy::CopyXattrs(int src, int dst) {
+    ssize_t size = syscall(SYS_flistxattr, src, nullptr, 0);
+    if (size <= 0)
+        return;
+
+    std::string names(size, '\0');
+    size = syscall(SYS_flistxattr, src, &names[0], size);
+    if (size <= 0)
+        return;
+    names.resize(size);
+
+    std::string value;
+    for (size_t pos = 0; pos < names.size(); pos = names.find('\0', pos) + 1) {
+        const char *name = names.c_str() + pos;
+        ssize_t len = syscall(SYS_fgetxattr, src, name, nullptr, 0);
+        if (len < 0)
+            continue;
+        value.resize(len);
+        len = syscall(SYS_fgetxattr, src, name, &value[0], len);
+        /* Like cp --archive ignore failures */
+        if (len >= 0 && syscall(SYS_fsetxattr, dst, name, value.data(), len, 0))
+            L_VERBOSE("Cannot copy xattr {}: {}", name, strerror(errno));
+    }
+}
+
+TError TTreeCopy::CopyAttrs(int src, int dst, const struct stat &st) {
+    if (fchown(dst, st.st_uid, st.st_gid))
+        return TError::System("Cannot chown");
+
+    /* After chown which drops suid/sgid */
+    if (fchmod(dst, st.st_mode & 07777))
+        return TError::System("Cannot chmod");
+
+    CopyXattrs(src, dst);
+
+    struct timespec ts[2] = { st.st_atim, st.st_mtim };
+    if (futimens(dst, ts))
+        return TError::System("Cannot set times");
+
+    return OK;
+}
+
+TError TTreeCopy::CreateFile(TTreeNode &dir, const char *name,
+                             const struct stat &st, TFile &dst, bool &linked) {
+    std::unique_lock<std::mutex> lock(LinksMutex, std::defer_lock);
+    auto key = std::make_pair(st.st_dev, st.st_ino);
+    TError error;
+
+    linked = false;
+
+    if (st.st_nlink > 1) {
+        lock.lock();
+        auto it = Links.find(key);
+        if (it != Links.end()) {
+            (void)unlinkat(dir.Dst.Fd, name, 0);
+            if (linkat(Dst.Fd, it->second.c_str(), dir.Dst.Fd, name, 0))
+                return TError::System("Cannot link {}", name);
+            linked = true;
+            return OK;
+        }
+    }
+
+    /* Replace existing non-regular file like cp --force */
+    error = dst.OpenAt(dir.Dst, name, O_WRONLY | O_CREAT | O_TRUNC |
+                       O_NOFOLLOW | O_CLOEXEC | O_NOCTTY, 0600);
+    if (error && error.Errno != ENOENT) {
+        (void)unlinkat(dir.Dst.Fd, name, 0);
+        error = dst.OpenAt(dir.Dst, name, O_WRONLY | O_CREAT | O_EXCL |
+                           O_NOFOLLOW | O_CLOEXEC | O_NOCTTY, 0600);
+    }
+
+    /* Other links see file created but might see it with partial data */
+    if (!error && lock.owns_lock())
+        Links[key] = RelativePath(dir, name);
+
+    return error;
+}
+
+TError TTreeCopy::Entry(TTreeNode &dir, const char *name, const struct stat *st) {
+    struct timespec ts[2] = { st->st_atim, st->st_mtim };
+    TError error;
+
+    if (S_ISREG(st->st_mode)) {
+        TFile src, dst;
+        bool linked;
+
+        error = src.OpenAt(dir.Src, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC | O_NOCTTY, 0);
+        if (error)
+            return error.Errno == ENOENT ? OK : error;
+
+        error = CreateFile(dir, name, *st, dst, linked);
+        if (error || linked)
+            return error;
+
+        error = CopyData(src, dst, st->st_size);
+        if (error)
+            return TError(error, "Cannot copy {}", name);
+
+        return CopyAttrs(src.Fd, dst.Fd, *st);
+    }
+
+    if (S_ISLNK(st->st_mode)) {
+        std::string target(PATH_MAX, '\0');
+        ssize_t len = readlinkat(dir.Src.Fd, name, &target[0], target.size());
+        if (len < 0)
+            return errno == ENOENT ? OK : TError::System("Cannot readlink {}", name);
+        target.resize(len);
+
+        if (symlinkat(target.c_str(), dir.Dst.Fd, name) && (errno != EEXIST ||
+                unlinkat(dir.Dst.Fd, name, 0) ||
+                symlinkat(target.c_str(), dir.Dst.Fd, name)))
+            return TError::System("Cannot create symlink {}", name);
+    } else {
+        if (mknodat(dir.Dst.Fd, name, st->st_mode, st->st_rdev) && (errno != EEXIST ||
+                unlinkat(dir.Dst.Fd, name, 0) ||
+                mknodat(dir.Dst.Fd, name, st->st_mode, st->st_rdev)))
+            return TError::System("Cannot create node {}", name);
+    }
+
+    if (fchownat(dir.Dst.Fd, name, st->st_uid, st->st_gid, AT_SYMLINK_NOFOLLOW))
+        return TError::System("Cannot chown {}", name);
+
+    if (!S_ISLNK(st->st_mode) && fchmodat(dir.Dst.Fd, name, st->st_mode & 07777, 0))
+        return TError::System("Cannot chmod {}", name);
+
+    if (utimensat(dir.Dst.Fd, name, ts, AT_SYMLINK_NOFOLLOW))
+        return TError::System("Cannot set times {}", name);
+
+    return OK;
+}
+
+TError TTreeCopy::Enter(TTreeNode &dir, TTreeNode &child) {
+    const char *name = child.Name.c_str();
+
+    if (mkdirat(dir.Dst.Fd, name, 0700) && errno != EEXIST)
+        return TError::System("Cannot mkdir {}", name);
+
+    return child.Dst.OpenAt(dir.Dst, child.Name, TREE_OPEN_FLAGS, 0);
+}
+
+/* Like cp --one-file-system copy mountpoint but not its content */
+TError TTreeCopy::MountPoint(TTreeNode &dir, TTreeNode &child) {
+    TError error = Enter(dir, child);
+    if (!error)
+        error = Leave(child, &dir.Src);
+    return error;
+}
+
+TError TTreeCopy::Leave(TTreeNode &node, const TFile *) {
+    return CopyAttrs(node.Src.Fd, node.Dst.Fd, node.Stat);
+}
+
+class TTreeApply : public TTreeWalk {
+public:
+    TTreeApply(const std::function<TError(int)> &fn) : Fn(fn) {}
+
+private:
+    const std::function<TError(int)> &Fn;
+
+    TError Entry(TTreeNode &dir, const char *name, const struct stat *) override {
+        struct stat st;
+        int fd;
+
+        fd = openat(dir.Src.Fd, name, O_RDONLY | O_CLOEXEC | O_NOCTTY |
+                                      O_NOFOLLOW | O_NOATIME | O_NONBLOCK);
+        if (fd < 0 && errno == EPERM)
+            fd = openat(dir.Src.Fd, name, O_RDONLY | O_CLOEXEC | O_NOCTTY |
+                                          O_NOFOLLOW | O_NONBLOCK);
+        if (fd < 0) {
+            int saved_errno = errno;
+            if (saved_errno == ENOENT ||
+                    (!fstatat(dir.Src.Fd, name, &st, AT_SYMLINK_NOFOLLOW) &&
+                     !S_ISREG(st.st_mode)))
+                return OK;
+            return TError(EError::Unknown, saved_errno, "Cannot open {}", name);
+        }
+
+        TError error;
+        if (!fstat(fd, &st) && S_ISREG(st.st_mode)) {
+            error = Fn(fd);
+            if (error) {
+                std::string path = NodePath(dir);
+                error = TError(error, "{}{}", path.empty() ? "" : path + "/", name);
+            }
+        }
+        close(fd);
+        return error;
+    }
+
+    TError MountPoint(TTreeNode &, TTreeNode &) override {
+        return OK;
+    }
+
+    TError Leave(TTreeNode &node, const TFile *) override {
+        TError error = Fn(node.Src.Fd);
+        if (error) {
+            std::string path = NodePath(node);
+            error = TError(error, "{}", path.empty() ? "." : path);
+        }
+        return error;
+    }
+};
+
+}
+
+TError ClearTree(const TFile &dir, unsigned threads) {
+    auto root = std::make_shared<TTreeNode>();
+    TTreeRemove walk(nullptr);
+    TError error;
+
+    error = root->Src.Dup(dir);
+    if (!error)
+        error = root->Src.Stat(root->Stat);
+    if (error)
+        return error;
+
+    return walk.Run(root, threads);
+}
+
+TError RemoveTree(const TFile &dir, const TPath &name, unsigned threads,
+                  TTreeThrottle *throttle) {
+    auto root = std::make_shared<TTreeNode>();
+    TTreeRemove walk(&dir);
+    TError error;
+
+    root->Name = name.ToString();
+
+    error = root->Src.OpenAt(dir, name, TREE_OPEN_FLAGS, 0);
+    if (error) {
+        if (error.Errno == ENOTDIR || error.Errno == ELOOP)
+            return dir.UnlinkAt(name);
+        return error;
+    }
+
+    error = root->Src.Stat(root->Stat);
+    if (error)
+        return error;
+
+    walk.Throttle = throttle;
+
+    return walk.Run(root, threads);
+}
+
+TError CopyTree(const TFile &src, const TFile &dst, unsigned threads) {
+    auto root = std::make_shared<TTreeNode>();
+    TTreeCopy walk(dst);
+    TError error;
+
+    error = root->Src.Dup(src);
+    if (!error)
+        error = root->Dst.Dup(dst);
+    if (!error)
+        error = root->Src.Stat(root->Stat);
+    if (error)
+        return error;
+
+    return walk.Run(root, threads);
+}
+
+TError ApplyTree(const TFile &dir, const std::function<TError(int fd)> &fn,
+                 unsigned threads, TTreeThrottle *throttle) {
+    auto root = std::make_shared<TTreeNode>();
+    TTreeApply walk(fn);
+    TError error;
+
+    error = root->Src.Dup(dir);
+    if (!error)
+        error = root->Src.Stat(root->Stat);
+    if (error)
+        return error;
+
+    walk.Throttle = throttle;
+
+    return walk.Run(root, threads);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include "util/path.hpp"
+
+/*
+ * Recursive operations on directory trees. Walk is fd-relative and never
+ * follows symlinks or crosses mountpoints. Descriptors are held only for
+ * directories in work, thus depth of tree is not limited by RLIMIT_NOFILE.
+ * Directories are distributed between threads: idle workers take subtrees
+ * queued by busy ones.
+ */
+
+/* Optional limit for background work, shared between walks */
+struct TTreeThrottle {
+    uint64_t Rate = 0;                  /* entries per second, 0 - unlimited */
+    std::atomic<bool> Abort{false};     /* fail with ECANCELED at next entry */
+    std::atomic<uint64_t> Entries{0};   /* entries processed so far */
+    bool Quiet = false;                 /* walk does not add to Entries */
+};
+
+/* Removes everything in directory but not directory itself */
+TError ClearTree(const TFile &dir, unsigned threads = 1);
+
+/* Removes file or directory tree name at dir */
+TError RemoveTree(const TFile &dir, const TPath &name, unsigned threads = 1,
+                  TTreeThrottle *throttle = nullptr);
+
+/* Copies content of directory src into dst preserving hardlinks,
+ * ownership, permissions, timestamps and extended attributes */
+TError CopyTree(const TFile &src, const TFile &dst, unsigned threads = 1);
+
+/* Calls fn with fd of each directory and regular file in tree including
+ * dir itself, other entries are skipped if they cannot be opened */
+TError ApplyTree(const TFile &dir, const std::function<TError(int fd)> &fn,
+                 unsigned threads = 1, TTreeThrottle *throttle = nullptr);
@@ -759,3 +759,17 @@ int SetIoPrio(pid_t pid, int ioprio)
 {
     return syscall(SYS_ioprio_set, 1, pid, ioprio);
 }
+
+int SetMemPolicy(int mode, const TBitMap &nodes)
+{
+    const unsigned bits = sizeof(unsigned long) * 8;
+    std::vector<unsigned long> mask(nodes.Size() / bits + 1, 0);
+
+    for (unsigned node = 0; node < nodes.Size(); node++)
+        if (nodes.Get(node))
+            mask[node / bits] |= 1ul << (node % bits);
+
+    /* Kernel ignores the last bit of maxnode */
+    return syscall(SYS_set_mempolicy, mode, mode ? mask.data() : nullptr,
+                   mode ? mask.size() * bits + 1 : 0);
+}
@@ -60,6 +60,7 @@ int GetNumCores();
 void DumpMallocInfo();
 
 int SetIoPrio(pid_t pid, int ioprio);
+int SetMemPolicy(int mode, const TBitMap &nodes);
 
 class TUnixSocket : public TNonCopyable {
     int SockFd;
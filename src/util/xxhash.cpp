@@ -0,0 +1,165 @@
+/*
+ * XXH64 implemented after xxHash specification
+ * https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+ *
+ * xxHash Library
+ * Copyright (c) 2012-2014, Yann Collet
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice, this
+ *   list of conditions and the following disclaimer in the documentation and/or
+ *   other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ * ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "xxhash.hpp"
+
+#include <cstring>
+
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t Rotl64(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+/* little-endian loads, unaligned access is fine on supported arches */
+static inline uint64_t Read64(const unsigned char *p) {
+    uint64_t val;
+    memcpy(&val, p, sizeof(val));
+    return val;
+}
+
+static inline uint32_t Read32(const unsigned char *p) {
+    uint32_t val;
+    memcpy(&val, p, sizeof(val));
+    return val;
+}
+
+static inline uint64_t Round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    acc = Rotl64(acc, 31);
+    return acc * PRIME64_1;
+}
+
+static inline uint64_t MergeRound(uint64_t acc, uint64_t val) {
+    acc ^= Round(0, val);
+    return acc * PRIME64_1 + PRIME64_4;
+}
+
+void TXxHash64::Reset(uint64_t seed) {
+    Seed = seed;
+    V1 = seed + PRIME64_1 + PRIME64_2;
+    V2 = seed + PRIME64_2;
+    V3 = seed;
+    V4 = seed - PRIME64_1;
+    Length = 0;
+    BufferSize = 0;
+}
+
+void TXxHash64::Update(const void *data, size_t len) {
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + len;
+
+    Length += len;
+
+    if (BufferSize + len < 32) {
+        memcpy(Buffer + BufferSize, p, len);
+        BufferSize += len;
+        return;
+    }
+
+    if (BufferSize) {
+        size_t fill = 32 - BufferSize;
+        memcpy(Buffer + BufferSize, p, fill);
+        V1 = Round(V1, Read64(Buffer));
+        V2 = Round(V2, Read64(Buffer + 8));
+        V3 = Round(V3, Read64(Buffer + 16));
+        V4 = Round(V4, Read64(Buffer + 24));
+        p += fill;
+        BufferSize = 0;
+    }
+
+    for (; p + 32 <= end; p += 32) {
+        V1 = Round(V1, Read64(p));
+        V2 = Round(V2, Read64(p + 8));
+        V3 = Round(V3, Read64(p + 16));
+        V4 = Round(V4, Read64(p + 24));
+    }
+
+    if (p < end) {
+        BufferSize = end - p;
+        memcpy(Buffer, p, BufferSize);
+    }
+}
+
+uint64_t TXxHash64::Digest() const {
+    const unsigned char *p = Buffer;
+    const unsigned char *end = Buffer + BufferSize;
+    uint64_t h;
+
+    if (Length >= 32) {
+        h = Rotl64(V1, 1) + Rotl64(V2, 7) + Rotl64(V3, 12) + Rotl64(V4, 18);
+        h = MergeRound(h, V1);
+        h = MergeRound(h, V2);
+        h = MergeRound(h, V3);
+        h = MergeRound(h, V4);
+    } else
+        h = Seed + PRIME64_5;
+
+    h += Length;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= Round(0, Read64(p));
+        h = Rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+    }
+
+    if (p + 4 <= end) {
+        h ^= (uint64_t)Read32(p) * PRIME64_1;
+        h = Rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+
+    for (; p < end; p++) {
+        h ^= *p * PRIME64_5;
+        h = Rotl64(h, 11) * PRIME64_1;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+std::string TXxHash64::HexDigest() const {
+    static const char hex[] = "0123456789abcdef";
+    uint64_t h = Digest();
+    std::string str(16, '0');
+
+    for (int i = 15; i >= 0; i--, h >>= 4)
+        str[i] = hex[h & 15];
+
+    return str;
+}
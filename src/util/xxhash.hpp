@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+/* XXH64 from xxHash by Yann Collet, streaming interface */
+class TXxHash64 {
+    uint64_t V1, V2, V3, V4;
+    uint64_t Seed;
+    uint64_t Length;
+    unsigned char Buffer[32];
+    size_t BufferSize;
+
+public:
+    TXxHash64(uint64_t seed = 0) { Reset(seed); }
+    void Reset(uint64_t seed = 0);
+    void Update(const void *data, size_t len);
+    uint64_t Digest() const;
+    std::string HexDigest() const;
+};
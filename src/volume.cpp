@@ -1,6 +1,10 @@
 #include <sstream>
+#include <cstring>
 #include <algorithm>
+#include <atomic>
 #include <condition_variable>
+#include <thread>
+#include <map>
 
 #include "volume.hpp"
 #include "storage.hpp"
@@ -9,6 +13,7 @@
 #include "util/string.hpp"
 #include "util/unix.hpp"
 #include "util/quota.hpp"
+#include "util/md5.hpp"
 #include "config.hpp"
 #include "kvalue.hpp"
 #include "helpers.hpp"
@@ -33,6 +38,145 @@ std::map<TPath, std::shared_ptr<TVolume>> Volumes;
 std::map<TPath, std::shared_ptr<TVolumeLink>> VolumeLinks;
 static uint64_t NextId = 1;
 
+/*
+ * Index of VolumeLinks by path components: resolving the covering link
+ * or listing links under a container root costs one descent over the
+ * path instead of lookups for each parent or scan of all links.
+ * Children are kept sorted and searched without building strings.
+ */
+class TVolumeLinkTrie {
+    struct TNode {
+        std::vector<std::pair<std::string, std::unique_ptr<TNode>>> Children;
+        std::shared_ptr<TVolumeLink> Link;
+        TPath Path;
+
+        TNode *Find(const char *name, size_t len) const {
+            auto it = std::lower_bound(Children.begin(), Children.end(),
+                                       std::make_pair(name, len), Less);
+            if (it != Children.end() && it->first.size() == len &&
+                    !it->first.compare(0, len, name, len))
+                return it->second.get();
+            return nullptr;
+        }
+
+        TNode *Add(const char *name, size_t len) {
+            auto it = std::lower_bound(Children.begin(), Children.end(),
+                                       std::make_pair(name, len), Less);
+            if (it != Children.end() && it->first.size() == len &&
+                    !it->first.compare(0, len, name, len))
+                return it->second.get();
+            it = Children.emplace(it, std::string(name, len),
+                                  std::unique_ptr<TNode>(new TNode));
+            return it->second.get();
+        }
+
+        static bool Less(const std::pair<std::string, std::unique_ptr<TNode>> &child,
+                         const std::pair<const char *, size_t> &name) {
+            return child.first.compare(0, std::string::npos,
+                                       name.first, name.second) < 0;
+        }
+    };
+
+    TNode Root;
+
+    /* Advances name to next path component, false at the end */
+    static bool Next(const char *&name, size_t &len) {
+        const char *path = name + len;
+        while (*path == '/')
+            path++;
+        name = path;
+        len = strcspn(path, "/");
+        return len != 0;
+    }
+
+    static void Collect(const TNode *node, std::vector<const TNode *> &nodes) {
+        if (node->Link)
+            nodes.push_back(node);
+        for (auto &child: node->Children)
+            Collect(child.second.get(), nodes);
+    }
+
+    static bool Erase(TNode *node, const char *name, size_t len) {
+        if (!Next(name, len)) {
+            if (!node->Link)
+                return false;
+            node->Link = nullptr;
+            node->Path = TPath();
+            return true;
+        }
+        auto it = std::lower_bound(node->Children.begin(), node->Children.end(),
+                                   std::make_pair(name, len), TNode::Less);
+        if (it == node->Children.end() || it->first.size() != len ||
+                it->first.compare(0, len, name, len))
+            return false;
+        if (!Erase(it->second.get(), name, len))
+            return false;
+        if (!it->second->Link && it->second->Children.empty())
+            node->Children.erase(it);
+        return true;
+    }
+
+public:
+    void Insert(const TPath &path, std::shared_ptr<TVolumeLink> link) {
+        TNode *node = &Root;
+        const char *name = path.c_str();
+        size_t len = 0;
+        while (Next(name, len))
+            node = node->Add(name, len);
+        node->Link = link;
+        node->Path = path;
+    }
+
+    bool Erase(const TPath &path) {
+        return Erase(&Root, path.c_str(), 0);
+    }
+
+    /* Deepest link at or above normal path, except root */
+    std::shared_ptr<TVolumeLink> FindOrigin(const TPath &path) const {
+        std::shared_ptr<TVolumeLink> origin;
+        const TNode *node = &Root;
+        const char *name = path.c_str();
+        size_t len = 0;
+        while (Next(name, len)) {
+            node = node->Find(name, len);
+            if (!node)
+                break;
+            if (node->Link)
+                origin = node->Link;
+        }
+        return origin;
+    }
+
+    /* Links at or under normal path */
+    void List(const TPath &path, std::vector<std::pair<TPath, std::shared_ptr<TVolumeLink>>> &links) const {
+        std::vector<const TNode *> nodes;
+        const TNode *node = &Root;
+        const char *name = path.c_str();
+        size_t len = 0;
+        while (node && Next(name, len))
+            node = node->Find(name, len);
+        if (!node)
+            return;
+        Collect(node, nodes);
+        for (auto n: nodes)
+            links.emplace_back(n->Path, n->Link);
+    }
+};
+
+static TVolumeLinkTrie VolumeLinkTrie;
+
+static void AddVolumeLink(const TPath &path, std::shared_ptr<TVolumeLink> link) {
+    VolumeLinks[path] = link;
+    VolumeLinkTrie.Insert(path, link);
+}
+
+static bool DelVolumeLink(const TPath &path) {
+    if (!VolumeLinks.erase(path))
+        return false;
+    VolumeLinkTrie.Erase(path);
+    return true;
+}
+
 static std::condition_variable VolumesCv;
 
 /* TVolumeBackend - abstract */
@@ -53,6 +197,20 @@ std::string TVolumeBackend::ClaimPlace() {
     return Volume->UserStorage() ? "" : Volume->Place.ToString();
 }
 
+TPath TVolumeBackend::QuotaPath() {
+    return TPath();
+}
+
+/* Project quota which moves files into project with several threads */
+static TProjectQuota VolumeQuota(TVolume *volume, const TPath &path) {
+    TProjectQuota quota(path);
+
+    quota.Threads = config().volumes().tree_threads();
+    quota.Throttle = &volume->BuildProgress;
+
+    return quota;
+}
+
 /* TVolumeDirBackend - directory */
 
 class TVolumeDirBackend : public TVolumeBackend {
@@ -311,7 +469,7 @@ public:
     }
 
     TError Build() override {
-        TProjectQuota quota(Volume->Path);
+        auto quota = VolumeQuota(Volume, Volume->Path);
         TError error;
 
         quota.SpaceLimit = Volume->SpaceLimit;
@@ -326,7 +484,7 @@ public:
     }
 
     TError Destroy() override {
-        TProjectQuota quota(Volume->Path);
+        auto quota = VolumeQuota(Volume, Volume->Path);
         TError error;
 
         L_ACT("Destroying project quota: {}", quota.Path);
@@ -334,7 +492,7 @@ public:
     }
 
     TError Resize(uint64_t space_limit, uint64_t inode_limit) override {
-        TProjectQuota quota(Volume->Path);
+        auto quota = VolumeQuota(Volume, Volume->Path);
 
         quota.SpaceLimit = space_limit;
         quota.InodeLimit = inode_limit;
@@ -345,6 +503,10 @@ public:
     TError StatFS(TStatFS &result) override {
         return TProjectQuota(Volume->Path).StatFS(result);
     }
+
+    TPath QuotaPath() override {
+        return Volume->Path;
+    }
 };
 
 /* TVolumeNativeBackend - project quota + bindmount */
@@ -380,7 +542,7 @@ public:
     }
 
     TError Build() override {
-        TProjectQuota quota(Volume->StoragePath);
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
         TError error;
 
         if (Volume->HaveQuota()) {
@@ -398,7 +560,7 @@ public:
     }
 
     TError Destroy() override {
-        TProjectQuota quota(Volume->StoragePath);
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
         TError error = Volume->InternalPath.UmountAll();
 
         if (Volume->HaveQuota() && quota.Exists()) {
@@ -410,7 +572,7 @@ public:
     }
 
     TError Resize(uint64_t space_limit, uint64_t inode_limit) override {
-        TProjectQuota quota(Volume->StoragePath);
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
 
         quota.SpaceLimit = space_limit;
         quota.InodeLimit = inode_limit;
@@ -427,67 +589,414 @@ public:
             return TProjectQuota(Volume->StoragePath).StatFS(result);
         return Volume->InternalPath.StatFS(result);
     }
+
+    TPath QuotaPath() override {
+        return Volume->HaveQuota() ? Volume->StoragePath : TPath();
+    }
+};
+
+#ifndef LOOP_SET_BLOCK_SIZE
+#define LOOP_SET_BLOCK_SIZE 0x4C09
+#endif
+
+#ifndef LOOP_CONFIGURE
+#define LOOP_CONFIGURE 0x4C0A
+#endif
+
+#ifndef LO_FLAGS_DIRECT_IO
+#define LO_FLAGS_DIRECT_IO 16
+#endif
+
+/* struct loop_config from linux 5.8 */
+struct TLoopConfig {
+    uint32_t fd;
+    uint32_t block_size;
+    struct loop_info64 info;
+    uint64_t reserved[8];
 };
 
+/* Detached loop devices ready for reuse, protected with BigLoopLock */
+static std::mutex BigLoopLock;
+static std::vector<int> LoopDevPool;
+/* LOOP_CONFIGURE support: -1 - not probed yet, 0 - no, 1 - yes */
+static std::atomic<int> LoopConfigure(-1);
+
+/* Allocates batch of devices at once to not contend on loop-control */
+static void FillLoopDevPool(const TFile &ctl) {
+    unsigned target = config().volumes().loop_dev_pool();
+
+    int nr = ioctl(ctl.Fd, LOOP_CTL_GET_FREE);
+    if (nr < 0)
+        return;
+
+    LoopDevPool.push_back(nr);
+
+    for (int i = nr + 1; LoopDevPool.size() < target && i < nr + 4 * (int)target; i++) {
+        int ret = ioctl(ctl.Fd, LOOP_CTL_ADD, i);
+        if (ret >= 0)
+            LoopDevPool.push_back(ret);
+    }
+
+    /* Lowest first */
+    std::sort(LoopDevPool.rbegin(), LoopDevPool.rend());
+}
+
+static TError ConfigureLoopDev(const TFile &dev, const TFile &file, const TPath &path) {
+    struct TLoopConfig cfg;
+    TError error;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.fd = file.Fd;
+    cfg.block_size = config().volumes().loop_block_size();
+    strncpy((char *)cfg.info.lo_file_name, path.c_str(), LO_NAME_SIZE - 1);
+    if (config().volumes().direct_io_loop())
+        cfg.info.lo_flags |= LO_FLAGS_DIRECT_IO;
+
+    if (LoopConfigure) {
+        if (!ioctl(dev.Fd, LOOP_CONFIGURE, &cfg)) {
+            LoopConfigure = 1;
+            return OK;
+        }
+        /* Only the first call tells that ioctl is unknown */
+        int probe = -1;
+        if ((errno != EINVAL && errno != ENOTTY) ||
+                !LoopConfigure.compare_exchange_strong(probe, 0))
+            return TError::System("ioctl(LOOP_CONFIGURE)");
+        L("Kernel does not support LOOP_CONFIGURE, fallback to LOOP_SET_FD");
+    }
+
+    if (ioctl(dev.Fd, LOOP_SET_FD, file.Fd) < 0)
+        return TError::System("ioctl(LOOP_SET_FD)");
+
+    cfg.info.lo_flags = 0;
+    if (ioctl(dev.Fd, LOOP_SET_STATUS64, &cfg.info) < 0) {
+        error = TError::System("ioctl(LOOP_SET_STATUS64)");
+        (void)ioctl(dev.Fd, LOOP_CLR_FD, 0);
+        return error;
+    }
+
+    if (cfg.block_size && ioctl(dev.Fd, LOOP_SET_BLOCK_SIZE, cfg.block_size) < 0) {
+        error = TError::System("ioctl(LOOP_SET_BLOCK_SIZE)");
+        (void)ioctl(dev.Fd, LOOP_CLR_FD, 0);
+        return error;
+    }
+
+    if (config().volumes().direct_io_loop() &&
+            ioctl(dev.Fd, LOOP_SET_DIRECT_IO, 1) < 0)
+        L("Cannot enable direct io for loop {}", TError::System("ioctl(LOOP_SET_DIRECT_IO)"));
+
+    return OK;
+}
+
 static TError SetupLoopDev(const TFile &file, const TPath &path, int &loopNr) {
-    static std::mutex BigLoopLock;
     TFile ctl, dev;
-    struct loop_info64 info;
+    uint32_t blockSize = config().volumes().loop_block_size();
     int nr, retry = 10;
     TError error;
 
+    /* Kernel accepts powers of two from 512 to page size */
+    if (blockSize && (blockSize < 512 || blockSize > (uint32_t)getpagesize() ||
+                      (blockSize & (blockSize - 1))))
+        return TError(EError::InvalidValue, "Invalid loop_block_size {}", blockSize);
+
     error = ctl.OpenReadWrite("/dev/loop-control");
     if (error)
         return error;
 
-    if (config().volumes().direct_io_loop() &&
-            fcntl(file.Fd, F_SETFL, fcntl(file.Fd, F_GETFL) | O_DIRECT))
-        L("Cannot enable O_DIRECT for loop {}", TError::System("fcntl"));
-
     auto lock = std::unique_lock<std::mutex>(BigLoopLock);
 
 again:
-    nr = ioctl(ctl.Fd, LOOP_CTL_GET_FREE);
-    if (nr < 0)
+    if (LoopDevPool.empty())
+        FillLoopDevPool(ctl);
+
+    if (LoopDevPool.empty())
         return TError::System("ioctl(LOOP_CTL_GET_FREE)");
 
+    nr = LoopDevPool.back();
+    LoopDevPool.pop_back();
+
+    /* Device open does not hold the lock */
+    lock.unlock();
+
     error = dev.OpenReadWrite("/dev/loop" + std::to_string(nr));
+    if (!error)
+        error = ConfigureLoopDev(dev, file, path);
+
+    lock.lock();
+
+    /* Grabbed by somebody else or not detached yet, forget it */
+    if (error && (error.Errno == EBUSY || error.Errno == ENXIO ||
+                  error.Errno == ENOENT) && --retry > 0)
+        goto again;
+
     if (error)
         return error;
 
-    if (ioctl(dev.Fd, LOOP_SET_FD, file.Fd) < 0) {
-        if (errno == EBUSY) {
-            if (!ioctl(dev.Fd, LOOP_GET_STATUS64, &info) || errno == ENXIO) {
-                if (--retry > 0)
-                    goto again;
+    loopNr = nr;
+    return OK;
+}
+
+TError PutLoopDev(const int loopNr) {
+    TFile loop;
+    TError error = loop.OpenReadWrite("/dev/loop" + std::to_string(loopNr));
+    if (!error && ioctl(loop.Fd, LOOP_CLR_FD, 0) < 0)
+        return TError::System("ioctl(LOOP_CLR_FD)");
+
+    if (!error) {
+        auto lock = std::unique_lock<std::mutex>(BigLoopLock);
+        if (LoopDevPool.size() < config().volumes().loop_dev_pool())
+            LoopDevPool.insert(LoopDevPool.begin(), loopNr);
+    }
+
+    return error;
+}
+
+/*
+ * Shared lower stacks for overlay and squash backends:
+ * PLACE/porto_lower/<id>/L<index> - read-only bind mount of each layer
+ * or squashfs mount of image, id is md5 of place and identities of layers.
+ * Image identity includes size and times: image rewritten in place gets new stack.
+ * Volumes with the same layers use one stack, it is removed with last one.
+ * Stacks are built without LowerStacksMutex, concurrent users wait for Building.
+ *
+ * Overlay holds its lower directories by itself: overlay volume puts stack
+ * right after mount, so bind mounts live only while volumes are being built.
+ * Squash volumes keep stack until destroy, squashfs mount is shared.
+ */
+
+struct TLowerStack {
+    TPath Path;
+    uint64_t Refs = 0;
+    bool Building = false;
+};
+
+static std::mutex LowerStacksMutex;
+static std::condition_variable LowerStacksCv;
+static std::map<std::string, TLowerStack> LowerStacks;
+
+/* Pins layers and computes stack id, image is Layers[0] for squash */
+static TError PinLowerLayers(const TVolume &volume, bool image, bool check,
+                             std::list<TFile> &pins, std::string &id) {
+    std::string key = volume.Place.ToString();
+    TError error;
+
+    for (auto &name: volume.Layers) {
+        pins.emplace_back();
+        TFile &pin = pins.back();
+        struct stat st;
+
+        if (image && pins.size() == 1) {
+            error = pin.OpenRead(name);
+        } else if (name[0] == '/') {
+            error = pin.OpenDir(name);
+            if (!error && check) {
+                error = CL->WriteAccess(pin);
+                if (error)
+                    error = TError(error, "Layer {}", name);
             }
+        } else {
+            TStorage layer(EStorageType::Layer, volume.Place, name);
+            /* Imported layers are available for everybody */
+            if (check)
+                (void)layer.Touch();
+            error = pin.OpenDir(layer.Path);
         }
-        return TError::System("ioctl(LOOP_SET_FD)");
+
+        if (!error)
+            error = pin.Stat(st);
+        if (error)
+            return error;
+
+        if (S_ISDIR(st.st_mode))
+            key += fmt::format("\ndir:{}:{}", st.st_dev, st.st_ino);
+        else
+            key += fmt::format("\nimage:{}:{}:{}:{}.{}:{}.{}", st.st_dev, st.st_ino,
+                               st.st_size, st.st_mtim.tv_sec, st.st_mtim.tv_nsec,
+                               st.st_ctim.tv_sec, st.st_ctim.tv_nsec);
     }
 
-    memset(&info, 0, sizeof(info));
-    strncpy((char *)info.lo_file_name, path.c_str(), LO_NAME_SIZE - 1);
+    id = Md5Sum(key);
+    return OK;
+}
+
+static void RemoveLowerStack(const TPath &path) {
+    TError error = path.UmountNested();
+    if (!error)
+        error = path.RemoveAll();
+    if (error)
+        L_WRN("Cannot remove lower stack {}: {}", path, error);
+}
+
+static void SetLoopAutoclear(int loopNr) {
+    struct loop_info64 info;
+    TFile dev;
 
-    if (ioctl(dev.Fd, LOOP_SET_STATUS64, &info) < 0) {
+    TError error = dev.OpenReadWrite("/dev/loop" + std::to_string(loopNr));
+    if (!error && (ioctl(dev.Fd, LOOP_GET_STATUS64, &info) ||
+                   (info.lo_flags |= LO_FLAGS_AUTOCLEAR,
+                    ioctl(dev.Fd, LOOP_SET_STATUS64, &info))))
         error = TError::System("ioctl(LOOP_SET_STATUS64)");
-        (void)ioctl(dev.Fd, LOOP_CLR_FD, 0);
+    if (error)
+        L_WRN("Cannot set autoclear for loop{}: {}", loopNr, error);
+}
+
+static TError BuildLowerStack(const TVolume &volume, bool image,
+                              std::list<TFile> &pins, const TPath &path) {
+    TError error;
+    int index = 0;
+
+    L_ACT("Build lower stack {}", path);
+
+    error = path.MkdirAll(0700);
+    if (error)
         return error;
+
+    for (auto &pin: pins) {
+        TPath layer = path / ("L" + std::to_string(index));
+
+        error = layer.Mkdir(0700);
+        if (error)
+            break;
+
+        if (image && !index) {
+            int loopNr = -1;
+
+            error = SetupLoopDev(pin, volume.Layers[0], loopNr);
+            if (error)
+                break;
+
+            error = layer.Mount("/dev/loop" + std::to_string(loopNr), "squashfs",
+                                MS_RDONLY | MS_NODEV | MS_NOSUID, {});
+
+            /* Device is released by kernel together with last mount */
+            if (!error)
+                SetLoopAutoclear(loopNr);
+            else
+                PutLoopDev(loopNr);
+        } else
+            error = layer.BindRemount(pin.ProcPath(), MS_RDONLY | MS_NODEV | MS_PRIVATE);
+
+        if (error)
+            break;
+
+        index++;
     }
 
-    loopNr = nr;
+    if (error)
+        RemoveLowerStack(path);
+
     return error;
 }
 
-TError PutLoopDev(const int loopNr) {
-    TFile loop;
-    TError error = loop.OpenReadWrite("/dev/loop" + std::to_string(loopNr));
-    if (!error && ioctl(loop.Fd, LOOP_CLR_FD, 0) < 0)
-        return TError::System("ioctl(LOOP_CLR_FD)");
-    return error;
+/* Returns path of stack and relative lowerdir option */
+static TError GetLowerStack(TVolume &volume, bool image,
+                            TPath &path, std::string &lowerdir) {
+    std::list<TFile> pins;
+    std::string id;
+    TError error;
+
+    error = PinLowerLayers(volume, image, true, pins, id);
+    if (error)
+        return error;
+
+    auto lock = std::unique_lock<std::mutex>(LowerStacksMutex);
+
+    LowerStacksCv.wait(lock, [&]{
+        auto it = LowerStacks.find(id);
+        return it == LowerStacks.end() || !it->second.Building;
+    });
+
+    /* Entry under construction is never erased by others */
+    auto &stack = LowerStacks[id];
+    if (!stack.Refs) {
+        stack.Path = volume.Place / PORTO_LOWER / id;
+        stack.Building = true;
+        lock.unlock();
+
+        error = BuildLowerStack(volume, image, pins, stack.Path);
+
+        lock.lock();
+        stack.Building = false;
+        LowerStacksCv.notify_all();
+        if (error) {
+            LowerStacks.erase(id);
+            return error;
+        }
+    }
+
+    stack.Refs++;
+    volume.LowerStack = id;
+    path = stack.Path;
+
+    lowerdir = "";
+    for (unsigned i = 0; i < volume.Layers.size(); i++)
+        lowerdir += (i ? ":L" : "L") + std::to_string(i);
+
+    return OK;
+}
+
+static void PutLowerStack(TVolume &volume) {
+    if (volume.LowerStack.empty())
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(LowerStacksMutex);
+    auto it = LowerStacks.find(volume.LowerStack);
+    volume.LowerStack = "";
+    if (it == LowerStacks.end() || --it->second.Refs)
+        return;
+
+    L_ACT("Remove lower stack {}", it->second.Path);
+    RemoveLowerStack(it->second.Path);
+    LowerStacks.erase(it);
+}
+
+/* Count references from restored volumes and remove stale stacks */
+static void RestoreLowerStack(TVolume &volume) {
+    bool image = volume.BackendType == "squash";
+    std::list<TFile> pins;
+    std::string id = volume.LowerStack;
+
+    volume.LowerStack = "";
+
+    /* Older versions did not save id, layers must be intact then */
+    if (!image || volume.Device >= 0 ||
+            (id.empty() && PinLowerLayers(volume, image, false, pins, id)))
+        return;
+
+    TPath path = volume.Place / PORTO_LOWER / id;
+    if (!path.Exists())
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(LowerStacksMutex);
+    auto &stack = LowerStacks[id];
+    stack.Path = path;
+    stack.Refs++;
+    volume.LowerStack = id;
+}
+
+static void CleanupLowerStacks(const std::set<TPath> &places) {
+    for (auto &place: places) {
+        std::vector<std::string> names;
+        TPath base = place / PORTO_LOWER;
+
+        if (!base.Exists() || base.ReadDirectory(names))
+            continue;
+
+        for (auto &name: names) {
+            auto lock = std::unique_lock<std::mutex>(LowerStacksMutex);
+            if (LowerStacks.count(name))
+                continue;
+            L_ACT("Remove stale lower stack {}", base / name);
+            RemoveLowerStack(base / name);
+        }
+    }
 }
 
 /* TVolumeLoopBackend - ext4 image + loop device */
 
+static TError TakeLoopImage(const TPath &place, uint64_t size,
+                            const TFile &dir, const std::string &name);
+
 class TVolumeLoopBackend : public TVolumeBackend {
     static constexpr const char *AutoImage = "loop.img";
 
@@ -597,6 +1106,19 @@ public:
             error = file.OpenAt(Volume->StorageFd, AutoImage,
                                 (Volume->IsReadOnly ? O_RDONLY : O_RDWR) |
                                 O_CLOEXEC | O_NOCTTY, 0);
+        } else if (!TakeLoopImage(Volume->Place, Volume->SpaceLimit,
+                                  Volume->StorageFd, AutoImage)) {
+            Volume->KeepStorage = false; /* New storage */
+            error = file.OpenAt(Volume->StorageFd, AutoImage,
+                                O_RDWR | O_CLOEXEC | O_NOCTTY, 0);
+            if (!error && Volume->SpaceGuarantee &&
+                    fallocate(file.Fd, FALLOC_FL_KEEP_SIZE, 0, Volume->SpaceGuarantee))
+                error = TError(EError::ResourceNotAvailable, errno,
+                               "cannot fallocate guarantee " + std::to_string(Volume->SpaceGuarantee));
+            if (!error)
+                error = file.Stat(st);
+            if (error)
+                Volume->StorageFd.UnlinkAt(AutoImage);
         } else {
             error = file.OpenAt(Volume->StorageFd, AutoImage,
                                 O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
@@ -666,6 +1188,211 @@ public:
     }
 };
 
+/*
+ * Pool of pre-formatted images for loop backend:
+ * PLACE/porto_loop_pool/<size>_<id>.img, size classes and count of
+ * images are set in volumes.loop_image_pool, refilled in background.
+ */
+
+static std::mutex LoopPoolMutex;
+static std::condition_variable LoopPoolCv;
+static std::thread LoopPoolThread;
+static std::set<std::string> LoopPoolPlaces;
+static std::map<uint64_t, uint64_t> LoopPoolTarget;
+static uint64_t LoopPoolGen = 0;
+static uint64_t LoopImageId = 0;
+static bool LoopPoolStop = false;
+
+static const char LOOP_POOL_TMP[] = "_tmp_";
+
+static bool ParseLoopImage(const std::string &name, uint64_t &size, uint64_t *id = nullptr) {
+    auto sep = name.find('_');
+    if (sep == std::string::npos || !StringEndsWith(name, ".img") ||
+            StringToUint64(name.substr(0, sep), size))
+        return false;
+    if (id && StringToUint64(name.substr(sep + 1, name.size() - sep - 5), *id))
+        *id = 0;
+    return true;
+}
+
+static TError TakeLoopImage(const TPath &place, uint64_t size,
+                            const TFile &dir, const std::string &name) {
+    TPath pool = place / PORTO_LOOP_POOL;
+    std::vector<std::string> names;
+    std::string best;
+    uint64_t best_size = 0;
+    TError error;
+    TFile poolFd;
+
+    auto lock = std::unique_lock<std::mutex>(LoopPoolMutex);
+
+    if (!LoopPoolThread.joinable())
+        return TError(EError::NotSupported, "Loop image pool is disabled");
+
+    if (LoopPoolPlaces.insert(place.ToString()).second) {
+        LoopPoolGen++;
+        LoopPoolCv.notify_all();
+    }
+
+    error = poolFd.OpenDirStrict(pool);
+    if (!error)
+        error = pool.ReadDirectory(names);
+    if (error)
+        return error;
+
+    /* Exact size or largest smaller, growing is cheaper than shrinking */
+    for (auto &it: names) {
+        uint64_t image_size;
+        if (!ParseLoopImage(it, image_size) || image_size > size)
+            continue;
+        if (image_size > best_size) {
+            best = it;
+            best_size = image_size;
+        }
+    }
+
+    if (best.empty())
+        return TError(EError::ResourceNotAvailable, "No loop image for size {}", size);
+
+    if (renameat(poolFd.Fd, best.c_str(), dir.Fd, name.c_str()))
+        return TError::System("Cannot take loop image {}", pool / best);
+
+    L_ACT("Take loop image {} size {}", pool / best, best_size);
+
+    LoopPoolGen++;
+    LoopPoolCv.notify_all();
+
+    return OK;
+}
+
+static void FillLoopPool(const TPath &place, const std::map<uint64_t, uint64_t> &target) {
+    TPath pool = place / PORTO_LOOP_POOL;
+    std::map<uint64_t, uint64_t> count;
+    std::vector<std::string> names;
+    TError error;
+    TFile poolFd;
+
+    if (!pool.Exists()) {
+        error = pool.Mkdir(0700);
+        if (error && error.Errno != EEXIST) {
+            L_WRN("Cannot create loop image pool: {}", error);
+            return;
+        }
+    }
+
+    error = poolFd.OpenDirStrict(pool);
+    if (!error)
+        error = pool.ReadDirectory(names);
+    if (error) {
+        L_WRN("Cannot read loop image pool: {}", error);
+        return;
+    }
+
+    for (auto &name: names) {
+        uint64_t size, id;
+
+        /* Leftovers from interrupted fill and unwanted sizes */
+        if (StringStartsWith(name, LOOP_POOL_TMP) || !ParseLoopImage(name, size, &id) ||
+                count[size] >= (target.count(size) ? target.at(size) : 0)) {
+            (void)poolFd.UnlinkAt(name);
+            continue;
+        }
+
+        /* Ids restart with portod, never reuse names of existing images */
+        LoopImageId = std::max(LoopImageId, id + 1);
+
+        count[size]++;
+    }
+
+    for (auto &it: target) {
+        uint64_t size = it.first;
+
+        while (count[size] < it.second) {
+            auto lock = std::unique_lock<std::mutex>(LoopPoolMutex);
+            if (LoopPoolStop)
+                return;
+            lock.unlock();
+
+            std::string name;
+            do
+                name = fmt::format("{}_{}.img", size, LoopImageId++);
+            while (poolFd.ExistsAt(name));
+
+            std::string temp = LOOP_POOL_TMP + name;
+            TPath path = pool / temp;
+            TFile file;
+
+            error = file.OpenAt(poolFd, temp, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+            if (!error)
+                error = TVolumeLoopBackend::MakeImage(file, poolFd, path, size, 0);
+            if (!error)
+                error = poolFd.RenameAt(temp, name);
+            if (error) {
+                L_WRN("Cannot make loop image {}: {}", pool / name, error);
+                (void)poolFd.UnlinkAt(temp);
+                return;
+            }
+
+            count[size]++;
+        }
+    }
+}
+
+static void LoopPoolWorker() {
+    SetProcessName("portod-loop");
+
+    auto lock = std::unique_lock<std::mutex>(LoopPoolMutex);
+    while (!LoopPoolStop) {
+        auto gen = LoopPoolGen;
+        auto places = LoopPoolPlaces;
+        auto target = LoopPoolTarget;
+
+        lock.unlock();
+        for (auto &place: places)
+            FillLoopPool(place, target);
+        lock.lock();
+
+        LoopPoolCv.wait_for(lock, std::chrono::seconds(60), [&]{
+            return LoopPoolStop || LoopPoolGen != gen;
+        });
+    }
+}
+
+void TVolume::StartLoopPool() {
+    TUintMap cfg;
+
+    if (StringToUintMap(config().volumes().loop_image_pool(), cfg) || cfg.empty())
+        return;
+
+    for (auto &it: cfg) {
+        uint64_t size;
+        if (StringToSize(it.first, size) || !size) {
+            L_WRN("Invalid loop image size {}", it.first);
+            continue;
+        }
+        LoopPoolTarget[size] = it.second;
+    }
+
+    if (LoopPoolTarget.empty() || LoopPoolThread.joinable())
+        return;
+
+    LoopPoolStop = false;
+    LoopPoolPlaces.insert(PORTO_PLACE);
+    LoopPoolThread = std::thread(LoopPoolWorker);
+}
+
+void TVolume::StopLoopPool() {
+    if (!LoopPoolThread.joinable())
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(LoopPoolMutex);
+    LoopPoolStop = true;
+    LoopPoolCv.notify_all();
+    lock.unlock();
+
+    LoopPoolThread.join();
+}
+
 /* TVolumeOverlayBackend - project quota + overlayfs */
 
 class TVolumeOverlayBackend : public TVolumeBackend {
@@ -702,11 +1429,11 @@ public:
     }
 
     TError Build() override {
-        TProjectQuota quota(Volume->StoragePath);
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
         TError error;
         std::string lower;
-        int layer_idx = 0;
         TFile upperFd, workFd;
+        TPath stack;
 
         if (Volume->HaveQuota()) {
             quota.SpaceLimit = Volume->SpaceLimit;
@@ -718,41 +1445,9 @@ public:
                   return error;
         }
 
-        for (auto &name: Volume->Layers) {
-            TPath path, temp;
-            TFile pin;
-
-            if (name[0] == '/') {
-                error = pin.OpenDir(name);
-                if (error)
-                    goto err;
-                error = CL->WriteAccess(pin);
-                if (error) {
-                    error = TError(error, "Layer {}", name);
-                    goto err;
-                }
-                path = pin.ProcPath();
-            } else {
-                TStorage layer(EStorageType::Layer, Volume->Place, name);
-                /* Imported layers are available for everybody */
-                (void)layer.Touch();
-                path = layer.Path;
-            }
-
-            std::string layer_id = "L" + std::to_string(Volume->Layers.size() - ++layer_idx);
-            temp = Volume->GetInternal(layer_id);
-            error = temp.Mkdir(700);
-            if (!error)
-                error = temp.BindRemount(path, MS_RDONLY | MS_NODEV | MS_PRIVATE);
-            if (error)
-                goto err;
-
-            pin.Close();
-
-            if (layer_idx > 1)
-                lower += ":";
-            lower += layer_id;
-        }
+        error = GetLowerStack(*Volume, false, stack, lower);
+        if (error)
+            goto err;
 
         error = Volume->StorageFd.MkdirAt("upper", 0755);
         if (!error)
@@ -772,7 +1467,8 @@ public:
         if (error)
             goto err;
 
-        error = Volume->GetInternal("").Chdir();
+        /* Short relative names, mount options are limited by page size */
+        error = stack.Chdir();
         if (error)
             goto err;
 
@@ -788,11 +1484,8 @@ public:
         (void)TPath("/").Chdir();
 
 err:
-        while (layer_idx--) {
-            TPath temp = Volume->GetInternal("L" + std::to_string(layer_idx));
-            (void)temp.UmountAll();
-            (void)temp.Rmdir();
-        }
+        /* Mounted overlay does not need layer bind mounts */
+        PutLowerStack(*Volume);
 
         if (!error)
             return error;
@@ -803,7 +1496,7 @@ err:
     }
 
     TError Destroy() override {
-        TProjectQuota quota(Volume->StoragePath);
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
         TError error = Volume->InternalPath.UmountAll();
 
         if (Volume->HaveQuota() && quota.Exists()) {
@@ -817,7 +1510,7 @@ err:
     }
 
     TError Resize(uint64_t space_limit, uint64_t inode_limit) override {
-        TProjectQuota quota(Volume->StoragePath);
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
 
         quota.SpaceLimit = space_limit;
         quota.InodeLimit = inode_limit;
@@ -834,6 +1527,10 @@ err:
             return TProjectQuota(Volume->StoragePath).StatFS(result);
         return Volume->InternalPath.StatFS(result);
     }
+
+    TPath QuotaPath() override {
+        return Volume->HaveQuota() ? Volume->StoragePath : TPath();
+    }
 };
 
 /* TVolumeSquashBackend - loop + squashfs + overlayfs + quota */
@@ -855,21 +1552,11 @@ public:
     }
 
     TError Build() override {
-        TProjectQuota quota(Volume->StoragePath);
-        TFile lowerFd, upperFd, workFd;
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
+        TFile upperFd, workFd;
         std::string lowerdir;
-        int layer_idx = 0;
         TError error;
-        TPath lower;
-
-        lower = Volume->GetInternal("lower");
-        error = lower.Mkdir(0755);
-        if (error)
-            return error;
-
-        error = lowerFd.OpenRead(Volume->Layers[0]);
-        if (error)
-            return error;
+        TPath stack;
 
         error = Volume->StorageFd.MkdirAt("upper", 0755);
         if (!error)
@@ -889,18 +1576,14 @@ public:
         if (error)
             return error;
 
-        error = SetupLoopDev(lowerFd, Volume->Layers[0], Volume->Device);
+        /* Image is mounted once for all volumes with the same layers */
+        error = GetLowerStack(*Volume, true, stack, lowerdir);
         if (error)
             return error;
 
-        error = lower.Mount("/dev/loop" + std::to_string(Volume->Device),
-                            "squashfs", MS_RDONLY | MS_NODEV | MS_NOSUID, {});
-        if (error)
-            goto err;
-
         /* shortcut for read-only volumes without extra layers */
         if (Volume->IsReadOnly && Volume->Layers.size() == 1) {
-            error = Volume->InternalPath.BindRemount(lower, Volume->GetMountFlags());
+            error = Volume->InternalPath.BindRemount(stack / "L0", Volume->GetMountFlags());
             if (error)
                 goto err;
             return OK;
@@ -916,49 +1599,10 @@ public:
                   goto err;
         }
 
-        error = Volume->GetInternal("").Chdir();
+        error = stack.Chdir();
         if (error)
             goto err;
 
-        lowerdir = lower.ToString();
-
-        for (auto &name: Volume->Layers) {
-            TPath path, temp;
-            TFile pin;
-
-            if (name == Volume->Layers[0])
-                continue;
-
-            if (name[0] == '/') {
-                error = pin.OpenDir(name);
-                if (error)
-                    goto err;
-                error = CL->WriteAccess(pin);
-                if (error) {
-                    error = TError(error, "Layer {}", name);
-                    goto err;
-                }
-                path = pin.ProcPath();
-            } else {
-                TStorage layer(EStorageType::Layer, Volume->Place, name);
-                /* Imported layers are available for everybody */
-                (void)layer.Touch();
-                path = layer.Path;
-            }
-
-            std::string layer_id = "L" + std::to_string(Volume->Layers.size() -
-                                                        ++layer_idx - 1);
-            temp = Volume->GetInternal(layer_id);
-            error = temp.Mkdir(700);
-            if (!error)
-                error = temp.BindRemount(path, MS_RDONLY | MS_NODEV | MS_PRIVATE);
-            if (error)
-                goto err;
-
-            pin.Close();
-            lowerdir += ":" + layer_id;
-        }
-
         error = Volume->InternalPath.Mount("overlay", "overlay",
                                    Volume->GetMountFlags(),
                                    { "lowerdir=" + lowerdir,
@@ -968,37 +1612,31 @@ public:
         if (error && error.Errno == EINVAL && Volume->Layers.size() >= 500)
             error = TError(EError::InvalidValue, "Too many layers, kernel limits is 499 plus 1 for upper");
 
-        while (layer_idx--) {
-            TPath temp = Volume->GetInternal("L" + std::to_string(layer_idx));
-            (void)temp.UmountAll();
-            (void)temp.Rmdir();
-        }
-
 err:
         (void)TPath("/").Chdir();
 
         if (error) {
             if (Volume->HaveQuota())
                 (void)quota.Destroy();
-            if (Volume->Device >= 0) {
-                lower.UmountAll();
-                PutLoopDev(Volume->Device);
-                Volume->Device = -1;
-            }
+            PutLowerStack(*Volume);
         }
 
         return error;
     }
 
     TError Destroy() override {
+        Volume->InternalPath.UmountAll();
+
+        /* Volumes built before shared stacks have own image mount */
         if (Volume->Device >= 0) {
-            Volume->InternalPath.UmountAll();
             Volume->GetInternal("lower").UmountAll();
             PutLoopDev(Volume->Device);
             Volume->Device = -1;
         }
 
-        TProjectQuota quota(Volume->StoragePath);
+        PutLowerStack(*Volume);
+
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
         if (Volume->HaveQuota() && quota.Exists()) {
             L_ACT("Destroying project quota: {}", quota.Path);
             (void)quota.Destroy();
@@ -1008,7 +1646,7 @@ err:
     }
 
     TError Resize(uint64_t space_limit, uint64_t inode_limit) override {
-        TProjectQuota quota(Volume->StoragePath);
+        auto quota = VolumeQuota(Volume, Volume->StoragePath);
 
         quota.SpaceLimit = space_limit;
         quota.InodeLimit = inode_limit;
@@ -1298,13 +1936,8 @@ std::shared_ptr<TVolumeLink> TVolume::ResolveLink(const TPath &path) {
 }
 
 std::shared_ptr<TVolumeLink> TVolume::ResolveOriginLocked(const TPath &path) {
-    if (path.IsAbsolute()) {
-        for (auto p = path.NormalPath(); !p.IsRoot(); p = p.DirNameNormal()) {
-            auto link = ResolveLinkLocked(p);
-            if (link)
-                return link;
-        }
-    }
+    if (path.IsAbsolute())
+        return VolumeLinkTrie.FindOrigin(path.IsNormal() ? path : path.NormalPath());
     return nullptr;
 }
 
@@ -1313,6 +1946,17 @@ std::shared_ptr<TVolumeLink> TVolume::ResolveOrigin(const TPath &path) {
     return ResolveOriginLocked(path);
 }
 
+void TVolume::ListLinksLocked(const TPath &root, std::map<TPath, std::shared_ptr<TVolumeLink>> &links) {
+    std::vector<std::pair<TPath, std::shared_ptr<TVolumeLink>>> found;
+
+    VolumeLinkTrie.List(root.NormalPath(), found);
+    for (auto &it: found) {
+        TPath path = root.InnerPath(it.first);
+        if (path)
+            links[path] = it.second;
+    }
+}
+
 TPath TVolume::ComposePath(const TContainer &ct) const {
     auto volumes_lock = LockVolumes();
 
@@ -1975,7 +2619,7 @@ TError TVolume::MountLink(std::shared_ptr<TVolumeLink> link) {
         error = TVolume::CheckConflicts(host_target);
         if (error)
             return error;
-        VolumeLinks[host_target] = link;
+        AddVolumeLink(host_target, link);
         Statistics->VolumeLinksMounted++;
     }
     link->HostTarget = host_target;
@@ -2043,7 +2687,7 @@ undo:
     link_mount.UmountAll();
     link_mount.Rmdir();
     volumes_lock.lock();
-    if (VolumeLinks.erase(link->HostTarget))
+    if (DelVolumeLink(link->HostTarget))
         Statistics->VolumeLinksMounted--;
     link->HostTarget = "";
     volumes_lock.unlock();
@@ -2062,7 +2706,7 @@ TError TVolume::UmountLink(std::shared_ptr<TVolumeLink> link,
         return TError(EError::InvalidValue, "Wrong volume link");
     if (!link->HostTarget)
         return OK;
-    if (VolumeLinks.erase(link->HostTarget))
+    if (DelVolumeLink(link->HostTarget))
         Statistics->VolumeLinksMounted--;
     TPath host_target = link->HostTarget;
     link->HostTarget = "";
@@ -2096,6 +2740,7 @@ TError TVolume::UmountLink(std::shared_ptr<TVolumeLink> link,
         }
 
         link->HostTarget = "";
+        VolumeLinkTrie.Erase(it->first);
         it = VolumeLinks.erase(it);
         Statistics->VolumeLinksMounted--;
     }
@@ -2105,7 +2750,7 @@ TError TVolume::UmountLink(std::shared_ptr<TVolumeLink> link,
 
 undo:
     volumes_lock.lock();
-    VolumeLinks[host_target] = link;
+    AddVolumeLink(host_target, link);
     Statistics->VolumeLinksMounted++;
     link->HostTarget = host_target;
     volumes_lock.unlock();
@@ -2114,8 +2759,11 @@ undo:
 
 void TVolume::DestroyAll() {
     std::list<std::shared_ptr<TVolume>> plan;
-    for (auto &it : Volumes)
+    for (auto &it : Volumes) {
+        if (it.second->State == EVolumeState::Building)
+            it.second->BuildProgress.Abort = true;
         plan.push_front(it.second);
+    }
     for (auto &vol: plan) {
         TError error = vol->Destroy();
         if (error)
@@ -2139,6 +2787,8 @@ TError TVolume::Destroy() {
         auto &volume = (*it);
 
         if (Path != volume->Path) {
+            if (volume->State == EVolumeState::Building)
+                volume->BuildProgress.Abort = true;
             while (volume->State == EVolumeState::Building)
                 VolumesCv.wait(volumes_lock);
         }
@@ -2241,7 +2891,7 @@ TError TVolume::Destroy() {
         Volumes.erase(volume->Path);
 
         /* Remove common link */
-        if (VolumeLinks.erase(volume->Path))
+        if (DelVolumeLink(volume->Path))
             Statistics->VolumeLinksMounted--;
 
         if (volume->VolumeOwnerContainer) {
@@ -2319,16 +2969,31 @@ TError TVolume::DestroyOne() {
             ret = error;
     }
 
+    /* Rename data into trash, reclaimer will remove it later */
+    bool async = config().volumes().async_destroy();
+
+    if (async && internal.Exists()) {
+        error = TStorage::MoveToTrash(Place, internal);
+        if (error) {
+            L_WRN("Cannot move internal to trash: {}", error);
+            async = false;
+        }
+    }
+
     if (!KeepStorage && !RemoteStorage() && StoragePath.Exists()) {
         if (!UserStorage()) {
-            error = RemoveRecursive(StoragePath);
-            if (error) {
-                L_VERBOSE("Cannot remove storage {}: {}", StoragePath, error);
-                error = StoragePath.RemoveAll();
+            if (async)
+                error = TStorage::MoveToTrash(Place, StoragePath);
+            if (!async || error) {
+                error = RemoveRecursive(StoragePath);
                 if (error) {
-                    L_WRN("Cannot remove storage {}: {}", StoragePath, error);
-                    if (!ret)
-                        ret = error;
+                    L_VERBOSE("Cannot remove storage {}: {}", StoragePath, error);
+                    error = StoragePath.RemoveAll();
+                    if (error) {
+                        L_WRN("Cannot remove storage {}: {}", StoragePath, error);
+                        if (!ret)
+                            ret = error;
+                    }
                 }
             }
         } else {
@@ -2379,9 +3044,124 @@ TError TVolume::StatFS(TStatFS &result) {
         result.Reset();
         return TError(EError::VolumeNotReady, "Volume not ready: " + Path.ToString());
     }
+    uint64_t interval = config().volumes().stat_cache_ms();
+    if (interval && StatCacheTime &&
+            GetCurrentTimeMs() - StatCacheTime < interval * 2) {
+        result = StatCache;
+        return OK;
+    }
     return Backend->StatFS(result);
 }
 
+static std::mutex StatCollectorMutex;
+static std::condition_variable StatCollectorCv;
+static std::thread StatCollectorThread;
+static bool StatCollectorStop;
+
+/*
+ * Refreshes StatCache of all ready volumes. Project quotas and statfs
+ * are read once per filesystem, volumes are matched by project id.
+ */
+void TVolume::CollectStats() {
+    std::vector<std::shared_ptr<TVolume>> volumes;
+    std::map<unsigned, std::map<uint32_t, TProjectUsage>> usage;
+    std::map<unsigned, TStatFS> fsStat;
+    std::set<unsigned> failed;
+    uint64_t started = GetCurrentTimeMs();
+    TError error;
+
+    auto volumes_lock = LockVolumes();
+    for (auto &it: Volumes)
+        if (it.second->State == EVolumeState::Ready)
+            volumes.push_back(it.second);
+    volumes_lock.unlock();
+
+    for (auto &volume: volumes) {
+        TStatFS stat;
+
+        auto lock = volume->LockState();
+        if (volume->State != EVolumeState::Ready)
+            continue;
+
+        TPath path = volume->Backend->QuotaPath();
+        unsigned dev = path ? path.GetDev() : 0;
+
+        if (dev && !usage.count(dev) && !failed.count(dev)) {
+            lock.unlock();
+            error = path.StatFS(fsStat[dev]);
+            if (!error)
+                error = TProjectQuota(path).LoadAll(usage[dev]);
+            if (error) {
+                L_WRN("Cannot collect project quotas for {}: {}", path, error);
+                usage.erase(dev);
+                failed.insert(dev);
+            }
+            lock.lock();
+            if (volume->State != EVolumeState::Ready)
+                continue;
+        }
+
+        if (dev && usage.count(dev)) {
+            TProjectQuota quota(path);
+
+            /* Project id is bound to inode of quota path, lookup once */
+            if (!volume->StatProjectId && !quota.FindProject())
+                volume->StatProjectId = quota.ProjectId;
+            quota.ProjectId = volume->StatProjectId;
+
+            if (quota.ProjectId)
+                error = quota.StatFS(stat, fsStat[dev], usage[dev]);
+            else
+                error = volume->Backend->StatFS(stat);
+        } else
+            error = volume->Backend->StatFS(stat);
+
+        /* Limits changed while collecting, keep cache empty */
+        if (volume->StatCacheReset >= started)
+            continue;
+
+        if (!error) {
+            volume->StatCache = stat;
+            volume->StatCacheTime = GetCurrentTimeMs();
+        } else
+            volume->StatCacheTime = 0;
+    }
+}
+
+static void StatCollectorWorker() {
+    SetProcessName("portod-stat");
+
+    auto lock = std::unique_lock<std::mutex>(StatCollectorMutex);
+    while (!StatCollectorStop) {
+        lock.unlock();
+        TVolume::CollectStats();
+        lock.lock();
+
+        StatCollectorCv.wait_for(lock, std::chrono::milliseconds(config().volumes().stat_cache_ms()),
+                                 [&]{ return StatCollectorStop; });
+    }
+}
+
+void TVolume::StartStatCollector() {
+    if (!config().volumes().stat_cache_ms() || StatCollectorThread.joinable())
+        return;
+
+    StatCollectorStop = false;
+    StatCollectorThread = std::thread(StatCollectorWorker);
+}
+
+void TVolume::StopStatCollector() {
+    if (!StatCollectorThread.joinable())
+        return;
+
+    auto lock = std::unique_lock<std::mutex>(StatCollectorMutex);
+    StatCollectorStop = true;
+    StatCollectorCv.notify_all();
+    lock.unlock();
+
+    StatCollectorThread.join();
+}
+
 TError TVolume::Tune(const std::map<std::string, std::string> &properties) {
     TError error;
 
@@ -2436,6 +3216,10 @@ TError TVolume::Tune(const std::map<std::string, std::string> &properties) {
         SpaceLimit = spaceLimit;
         InodeLimit = inodeLimit;
         volumes_lock.unlock();
+
+        /* limits changed, cached usage and available space are stale */
+        StatCacheTime = 0;
+        StatCacheReset = GetCurrentTimeMs();
     }
 
     if (properties.count(V_SPACE_GUARANTEE) || properties.count(V_INODE_GUARANTEE)) {
@@ -2702,6 +3486,8 @@ void TVolume::Dump(TVolumeLink *link, const TPath &path, rpc::TVolumeDescription
     ret[V_READY] = BoolToString(State == EVolumeState::Ready);
     if (BuildTime.size())
         ret[V_BUILD_TIME] = BuildTime;
+    if (State == EVolumeState::Building)
+        ret[V_BUILD_PROGRESS] = std::to_string(BuildProgress.Entries);
     ret[V_STATE] = StateName(State);
     ret[V_PRIVATE] = Private;
     ret[V_READ_ONLY] = BoolToString(IsReadOnly);
@@ -2821,6 +3607,8 @@ TError TVolume::Save() {
     node.Set(V_READY, BoolToString(State == EVolumeState::Ready));
     node.Set(V_PRIVATE, Private);
     node.Set(V_LOOP_DEV, std::to_string(Device));
+    if (!LowerStack.empty())
+        node.Set(V_RAW_LOWER_STACK, LowerStack);
     node.Set(V_READ_ONLY, BoolToString(IsReadOnly));
     node.Set(V_LAYERS, MergeEscapeStrings(Layers, ';'));
     node.Set(V_SPACE_LIMIT, std::to_string(SpaceLimit));
@@ -3022,12 +3810,12 @@ TError TVolume::Create(const TStringMap &cfg, std::shared_ptr<TVolume> &volume)
     common_link->Target = volume->Path;
     common_link->HostTarget = volume->Path;
     common_link->ReadOnly = volume->IsReadOnly;
-    VolumeLinks[volume->Path] = common_link;
+    AddVolumeLink(volume->Path, common_link);
 
     /* also check if volume depends on itself */
     error = volume->CheckDependencies();
     if (error) {
-        VolumeLinks.erase(volume->Path);
+        DelVolumeLink(volume->Path);
         return error;
     }
 
@@ -3141,6 +3929,8 @@ void TVolume::RestoreAll(void) {
             continue;
         }
 
+        RestoreLowerStack(*volume);
+
         uint64_t id;
         if (!StringToUint64(volume->Id, id)) {
             if (id >= NextId)
@@ -3154,7 +3944,7 @@ void TVolume::RestoreAll(void) {
         common_link->Target = volume->Path;
         common_link->HostTarget = volume->Path;
         common_link->ReadOnly = volume->IsReadOnly;
-        VolumeLinks[volume->Path] = common_link;
+        AddVolumeLink(volume->Path, common_link);
         Statistics->VolumeLinksMounted++;
 
         error = volume->Save();
@@ -3195,6 +3985,11 @@ void TVolume::RestoreAll(void) {
             L_WRN("Volume {} destroy: {}", volume->Path, error);
     }
 
+    std::set<TPath> places = {place};
+    for (auto &it: Volumes)
+        places.insert(it.second->Place);
+    CleanupLowerStacks(places);
+
     TPath volumes = place / PORTO_VOLUMES;
 
     L_SYS("Remove stale volumes...");
@@ -3355,6 +4150,9 @@ TError TVolume::ApplyConfig(const TStringMap &cfg) {
         } else if (prop.first == V_LOOP_DEV) {
             error = StringToInt(prop.second, Device);
 
+        } else if (prop.first == V_RAW_LOWER_STACK) {
+            LowerStack = prop.second;
+
         } else if (prop.first == V_READ_ONLY) {
             error = StringToBool(prop.second, IsReadOnly);
 
@@ -7,12 +7,14 @@
 #include "common.hpp"
 #include "util/path.hpp"
 #include "util/log.hpp"
+#include "util/tree.hpp"
 
 constexpr const char *V_ID = "id";
 constexpr const char *V_PATH = "path";
 constexpr const char *V_BACKEND = "backend";
 constexpr const char *V_READY = "ready";
 constexpr const char *V_BUILD_TIME = "build_time";
+constexpr const char *V_BUILD_PROGRESS = "build_progress";
 constexpr const char *V_STATE = "state";
 constexpr const char *V_PRIVATE = "private";
 
@@ -20,6 +22,7 @@ constexpr const char *V_RAW_ID = "_id";
 constexpr const char *V_RAW_CONTAINERS = "_containers";
 constexpr const char *V_CONTAINERS = "containers";
 constexpr const char *V_LOOP_DEV = "_loop_dev";
+constexpr const char *V_RAW_LOWER_STACK = "_lower_stack";
 constexpr const char *V_AUTO_PATH = "_auto_path";
 constexpr const char *V_TARGET_CONTAINER = "target_container";
 
@@ -73,6 +76,7 @@ public:
     virtual TError StatFS(TStatFS &result) =0;
     virtual TError Resize(uint64_t space_limit, uint64_t inode_limit);
     virtual std::string ClaimPlace();
+    virtual TPath QuotaPath();
 };
 
 class TVolumeLink {
@@ -122,6 +126,7 @@ public:
     void SetState(EVolumeState state);
 
     int Device = -1;
+    std::string LowerStack; /* Id of shared lower layers */
     bool IsReadOnly = false;
 
     bool HasDependentContainer = false;
@@ -135,6 +140,15 @@ public:
     uint64_t InodeLimit = 0;
     uint64_t InodeGuarantee = 0;
 
+    /* files processed by tree walks during build, abort cancels build */
+    TTreeThrottle BuildProgress;
+
+    /* protected with state lock, filled by stat collector */
+    TStatFS StatCache;
+    uint64_t StatCacheTime = 0;
+    uint64_t StatCacheReset = 0; /* drops results collected before */
+    uint32_t StatProjectId = 0;
+
     /* protected with VolumesLock */
     std::shared_ptr<TContainer> VolumeOwnerContainer;
 
@@ -169,6 +183,9 @@ public:
     static std::shared_ptr<TVolumeLink> ResolveOriginLocked(const TPath &path);
     static std::shared_ptr<TVolumeLink> ResolveOrigin(const TPath &path);
 
+    /* links reachable inside root, by inner path */
+    static void ListLinksLocked(const TPath &root, std::map<TPath, std::shared_ptr<TVolumeLink>> &links);
+
     TPath ComposePath(const TContainer &ct) const;
 
     TError Configure(const TPath &target_root, const TStringMap &cfg);
@@ -191,6 +208,13 @@ public:
 
     static void RestoreAll(void);
 
+    static void StartLoopPool();
+    static void StopLoopPool();
+
+    static void CollectStats();
+    static void StartStatCollector();
+    static void StopStatCollector();
+
     TError MountLink(std::shared_ptr<TVolumeLink> link);
 
     TError UmountLink(std::shared_ptr<TVolumeLink> link,
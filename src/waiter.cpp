@@ -34,15 +34,7 @@ void TContainerWaiter::Deactivate() {
     ContainerWaiters.remove(this);
 }
 
-bool TContainerWaiter::ShouldReport(TContainer &ct) {
-
-    /* Sync wait reports only stopped, dead, respawning, hollow meta */
-    if (!Async && ct.State != EContainerState::Stopped &&
-            ct.State != EContainerState::Dead &&
-            ct.State != EContainerState::Respawning &&
-            (ct.State != EContainerState::Meta || ct.RunningChildren))
-        return false;
-
+bool TContainerWaiter::MatchName(TContainer &ct) {
     for (auto &nm: Names)
         if (ct.Name == nm)
             return true;
@@ -54,6 +46,18 @@ bool TContainerWaiter::ShouldReport(TContainer &ct) {
     return false;
 }
 
+bool TContainerWaiter::ShouldReport(TContainer &ct) {
+
+    /* Sync wait reports only stopped, dead, respawning, hollow meta */
+    if (!Async && ct.State != EContainerState::Stopped &&
+            ct.State != EContainerState::Dead &&
+            ct.State != EContainerState::Respawning &&
+            (ct.State != EContainerState::Meta || ct.RunningChildren))
+        return false;
+
+    return MatchName(ct);
+}
+
 void TContainerWaiter::ReportAll(TContainer &ct) {
     ContainerWaitersLock.lock();
     for (auto it = ContainerWaiters.begin(); it != ContainerWaiters.end();) {
@@ -78,6 +82,20 @@ void TContainerWaiter::ReportAll(TContainer &ct) {
     ContainerWaitersLock.unlock();
 }
 
+/* Events other than state changes are reported only to async waiters */
+void TContainerWaiter::ReportEvent(TContainer &ct, const std::string &event) {
+    ContainerWaitersLock.lock();
+    for (auto waiter: ContainerWaiters) {
+        if (!waiter->Async || !waiter->MatchName(ct))
+            continue;
+        auto client = waiter->Client.lock();
+        std::string name;
+        if (client && !client->ComposeName(ct.Name, name))
+            client->MakeReport(name, event, true);
+    }
+    ContainerWaitersLock.unlock();
+}
+
 void TContainerWaiter::Timeout() {
     ContainerWaitersLock.lock();
     auto client = Client.lock();
@@ -31,8 +31,10 @@ public:
     void Activate(std::shared_ptr<TClient> &client);
     void Deactivate();
 
+    bool MatchName(TContainer &ct);
     bool ShouldReport(TContainer &ct);
     void Timeout();
 
     static void ReportAll(TContainer &ct);
+    static void ReportEvent(TContainer &ct, const std::string &event);
 };
@@ -13,6 +13,8 @@
 #include "util/unix.hpp"
 #include "util/cred.hpp"
 #include "util/idmap.hpp"
+#include "util/xxhash.hpp"
+#include "util/tree.hpp"
 #include "test.hpp"
 #include "rpc.hpp"
 
@@ -26,6 +28,7 @@ extern "C" {
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/resource.h>
 #include <grp.h>
 #include <linux/capability.h>
 #include <sys/socket.h>
@@ -2511,6 +2514,183 @@ static void TestFormat(Porto::Connection &) {
     Expect(!!StringToSize("1z", v));
 }
 
+static void TestHash(Porto::Connection &) {
+    std::vector<std::pair<std::string, std::string>> xxh64 = {
+        { "", "ef46db3751d8e999" },
+        { "a", "d24ec4f1a98c6e5b" },
+        { "abc", "44bc2cf5ad770999" },
+    };
+
+    for (auto &v: xxh64) {
+        TXxHash64 hash;
+        hash.Update(v.first.data(), v.first.size());
+        ExpectEq(hash.HexDigest(), v.second);
+    }
+
+    TXxHash64 split;
+    split.Update("a", 1);
+    split.Update("", 0);
+    split.Update("bc", 2);
+    ExpectEq(split.HexDigest(), "44bc2cf5ad770999");
+
+    /* cross 32-byte stripes at odd offsets */
+    std::string data;
+    for (int i = 0; i < 100; i++)
+        data += 'a' + i % 26;
+
+    TXxHash64 whole, parts;
+    whole.Update(data.data(), data.size());
+    parts.Update(data.data(), 1);
+    parts.Update(data.data() + 1, 40);
+    parts.Update(data.data() + 41, 59);
+    ExpectEq(whole.HexDigest(), parts.HexDigest());
+    ExpectEq(whole.Digest(), parts.Digest());
+}
+
+static int TreeDepth(const TFile &dir) {
+    TFile cur, next;
+    int depth = 0;
+
+    ExpectOk(cur.Dup(dir));
+    while (!next.OpenAt(cur, "d", O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC, 0)) {
+        cur.Close();
+        cur.SetFd = next.Fd;
+        next.SetFd = -1;
+        depth++;
+    }
+    Expect(cur.ExistsAt("f"));
+    return depth;
+}
+
+static void TestTree(Porto::Connection &) {
+    TPath base(TMPDIR + "/tree");
+    TFile baseDir, src, dst, dst2, cur;
+    struct rlimit limit, saved;
+    const int depth = 2000;
+    struct stat a, b;
+    TPath target;
+
+    (void)TPath(TMPDIR).MkdirAll(0755);
+    if (base.Exists())
+        ExpectOk(base.RemoveAll());
+    ExpectOk(base.Mkdir(0755));
+    ExpectOk(baseDir.OpenDir(base));
+    ExpectOk(baseDir.MkdirAt("src", 0755));
+    ExpectOk(baseDir.MkdirAt("dst", 0755));
+    ExpectOk(baseDir.MkdirAt("dst2", 0755));
+    ExpectOk(src.OpenAt(baseDir, "src", O_RDONLY | O_DIRECTORY | O_CLOEXEC, 0));
+    ExpectOk(dst.OpenAt(baseDir, "dst", O_RDONLY | O_DIRECTORY | O_CLOEXEC, 0));
+    ExpectOk(dst2.OpenAt(baseDir, "dst2", O_RDONLY | O_DIRECTORY | O_CLOEXEC, 0));
+
+    /* Tree is deeper than descriptor limit */
+    ExpectEq(getrlimit(RLIMIT_NOFILE, &saved), 0);
+    limit = saved;
+    limit.rlim_cur = 256;
+    ExpectEq(setrlimit(RLIMIT_NOFILE, &limit), 0);
+
+    ExpectOk(cur.Dup(src));
+    for (int i = 0; i < depth; i++) {
+        TFile next;
+        ExpectOk(cur.MkdirAt("d", 0755));
+        ExpectOk(next.OpenAt(cur, "d", O_RDONLY | O_DIRECTORY | O_CLOEXEC, 0));
+        if (i % 100 == 0)
+            ExpectOk(next.MkdirAt("e", 0700));
+        cur.Close();
+        cur.SetFd = next.Fd;
+        next.SetFd = -1;
+    }
+    TFile file;
+    ExpectOk(file.OpenAt(cur, "f", O_WRONLY | O_CREAT | O_CLOEXEC, 0644));
+    ExpectOk(file.WriteAll("data"));
+    file.Close();
+    cur.Close();
+
+    /* Hardlinks, symlink out of tree and mountpoint */
+    ExpectOk(file.OpenAt(src, "a", O_WRONLY | O_CREAT | O_CLOEXEC, 0600));
+    ExpectOk(file.WriteAll("link"));
+    file.Close();
+    ExpectEq(linkat(src.Fd, "a", src.Fd, "b", 0), 0);
+    ExpectOk(src.SymlinkAt("l", "/etc"));
+    ExpectOk(src.MkdirAt("mnt", 0755));
+    ExpectOk((base / "src/mnt").Mount("tmpfs", "tmpfs", 0, {}));
+    ExpectOk((base / "src/mnt/inner").Mkfile(0644));
+
+    ExpectOk(CopyTree(src, dst, 1));
+    ExpectOk(CopyTree(src, dst2, 4));
+
+    for (auto copy: { &dst, &dst2 }) {
+        ExpectEq(TreeDepth(*copy), depth);
+
+        ExpectOk(copy->StatAt("a", false, a));
+        ExpectOk(copy->StatAt("b", false, b));
+        ExpectEq(a.st_ino, b.st_ino);
+        ExpectEq(a.st_nlink, 2);
+
+        ExpectOk(copy->ReadlinkAt("l", target));
+        ExpectEq(target.ToString(), "/etc");
+
+        /* Like cp --one-file-system */
+        Expect(copy->ExistsAt("mnt"));
+        Expect(!copy->ExistsAt("mnt/inner"));
+    }
+
+    /* Apply walk: progress, quiet pass, file names in errors, abort */
+    TTreeThrottle throttle;
+    std::atomic<int> calls(0);
+    auto count = [&](int) -> TError {
+        calls++;
+        return OK;
+    };
+
+    /* Regular files and directories, entries include symlink and mountpoint */
+    ExpectOk(ApplyTree(src, count, 4, &throttle));
+    ExpectEq(calls.load(), 3 + 1 + depth + depth / 100);
+    ExpectEq(throttle.Entries.load(), 5 + depth - 1 + depth / 100 + 1);
+
+    uint64_t entries = throttle.Entries;
+    throttle.Quiet = true;
+    ExpectOk(ApplyTree(src, count, 4, &throttle));
+    ExpectEq(throttle.Entries.load(), entries);
+    throttle.Quiet = false;
+
+    ExpectOk(file.OpenAt(src, "c", O_WRONLY | O_CREAT | O_CLOEXEC, 0644));
+    ExpectOk(file.Stat(a));
+    file.Close();
+    TError error = ApplyTree(src, [&](int fd) -> TError {
+        struct stat st;
+        if (!fstat(fd, &st) && st.st_ino == a.st_ino)
+            return TError(EError::Unknown, EPERM, "denied");
+        return OK;
+    }, 4);
+    ExpectEq(error.Errno, EPERM);
+    Expect(StringEndsWith(error.Text, "c: denied"));
+    ExpectOk(src.UnlinkAt("c"));
+
+    throttle.Abort = true;
+    ExpectEq(ApplyTree(src, count, 4, &throttle).Errno, ECANCELED);
+
+    /* Never walks into mountpoint */
+    ExpectEq(ClearTree(src, 4).Errno, EBUSY);
+    Expect((base / "src/mnt/inner").Exists());
+    ExpectOk((base / "src/mnt").Umount(0));
+
+    ExpectOk(ClearTree(src, 1));
+    std::vector<std::string> names;
+    ExpectOk((base / "src").ReadDirectory(names));
+    ExpectEq(names.size(), 0);
+    Expect(TPath("/etc").Exists());
+
+    ExpectOk(RemoveTree(baseDir, "dst", 1));
+    ExpectOk(RemoveTree(baseDir, "dst2", 4));
+    Expect(!(base / "dst").Exists());
+    Expect(!(base / "dst2").Exists());
+
+    ExpectEq(setrlimit(RLIMIT_NOFILE, &saved), 0);
+
+    baseDir.Close();
+    ExpectOk(base.RemoveAll());
+}
+
 static void TestRoot(Porto::Connection &api) {
     string v;
     string root = "/";
@@ -4585,6 +4765,8 @@ int SelfTest(std::vector<std::string> args) {
         { "path", TestPath },
         { "idmap", TestIdmap },
         { "format", TestFormat },
+        { "hash", TestHash },
+        { "tree", TestTree },
         { "root", TestRoot },
         { "data", TestData },
         { "holder", TestHolder },
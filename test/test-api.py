@@ -159,6 +159,16 @@ l = c.ImportLayer(layer_name, tarball_path)
 assert l.name == layer_name
 assert c.FindLayer(layer_name).name == layer_name
 
+if os.access("/usr/bin/zstd", os.X_OK):
+    zstd_tarball_path = "/tmp/" + prefix + "layer.tzst"
+    v.Export(zstd_tarball_path)
+    with open(zstd_tarball_path, 'rb') as f:
+        assert f.read(4) == b"\x28\xb5\x2f\xfd"
+    zl = c.ImportLayer(layer_name + "-zstd", zstd_tarball_path)
+    assert zl.name == layer_name + "-zstd"
+    zl.Remove()
+    os.unlink(zstd_tarball_path)
+
 assert l.GetPrivate() == ""
 l.SetPrivate("123654")
 assert l.GetPrivate() == "123654"
@@ -0,0 +1,74 @@
+#!/usr/bin/python -u
+
+import os
+import time
+import threading
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+NAME = "test-async-log"
+LOG = "/var/log/portod.log"
+
+def LogThreads():
+    pid = GetPortodPid()
+    return [tid for tid in os.listdir("/proc/{}/task".format(pid))
+            if open("/proc/{}/task/{}/comm".format(pid, tid)).read().strip() == "portod-log"]
+
+def Dropped():
+    return int(c.GetProperty("/", "porto_stat[log_lines_dropped]"))
+
+def WaitLog(lines, timeout=10):
+    deadline = time.time() + timeout
+    while True:
+        text = open(LOG).read()
+        missing = [line for line in lines if line not in text]
+        if not missing:
+            return
+        Expect(time.time() < deadline)
+        time.sleep(0.1)
+
+def Run(prefix, count):
+    conn = porto.Connection()
+    for i in range(count):
+        conn.Destroy(conn.Create("{}-{}".format(prefix, i)))
+
+def Check(threads, count):
+    dropped = Dropped()
+    workers = [threading.Thread(target=Run, args=("{}-{}".format(NAME, t), count))
+               for t in range(threads)]
+    for w in workers:
+        w.start()
+    for w in workers:
+        w.join()
+
+    # lines from all threads reach log unless counted as dropped
+    if Dropped() == dropped:
+        WaitLog([":{}-{}-{}\n".format(NAME, t, i)
+                 for t in range(threads) for i in range(count)])
+
+# asynchronous by default
+ExpectEq(len(LogThreads()), 1)
+Dropped()
+Check(8, 50)
+
+# flushed on restart
+c.Destroy(c.Create(NAME))
+ReloadPortod()
+WaitLog([":{}\n".format(NAME)], timeout=0)
+
+# zero ring size keeps synchronous logging
+ConfigurePortod(NAME, 'log { buffer_size: 0 }')
+ExpectEq(LogThreads(), [])
+c.Destroy(c.Create(NAME + "-sync"))
+WaitLog([":{}-sync\n".format(NAME)], timeout=0)
+Check(4, 10)
+
+# tiny ring and rare flushes drop lines instead of blocking
+ConfigurePortod(NAME, 'log { buffer_size: 4096 flush_ms: 1000 }')
+ExpectEq(len(LogThreads()), 1)
+Check(8, 50)
+
+ConfigurePortod(NAME, None)
+ExpectEq(len(LogThreads()), 1)
@@ -0,0 +1,78 @@
+#!/usr/bin/python -u
+
+import os
+import re
+import sys
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+def Cpus(text):
+    cpus = set()
+    for part in text.split(","):
+        if "-" in part:
+            first, last = part.split("-")
+            cpus.update(range(int(first), int(last) + 1))
+        elif part:
+            cpus.add(int(part))
+    return cpus
+
+def Layout(ct):
+    layout = []
+    for entry in ct.GetProperty("cpu_set_layout").split(";"):
+        m = re.match(r"node (\d+) cache (\S+): (\S+)$", entry.strip())
+        Expect(m is not None)
+        layout.append((int(m.group(1)), Cpus(m.group(2)), Cpus(m.group(3))))
+    return layout
+
+def Node(cpu):
+    for name in os.listdir("/sys/devices/system/cpu/cpu{}".format(cpu)):
+        if name.startswith("node"):
+            return int(name[4:])
+    return 0
+
+def Siblings(cpu):
+    return Cpus(open("/sys/devices/system/cpu/cpu{}/topology/thread_siblings_list".format(cpu)).read().strip())
+
+# root layout covers all cpus, each in own node and cache domain
+root = c.Find("/")
+online = Cpus(root.GetProperty("cpu_set_affinity"))
+seen = set()
+for node, cache, cpus in Layout(root):
+    Expect(cpus <= cache)
+    Expect(not cpus & seen)
+    seen |= cpus
+    for cpu in cpus:
+        ExpectEq(Node(cpu), node)
+ExpectEq(seen, online)
+
+ExpectEq(Catch(root.SetProperty, "cpu_set_layout", ""), porto.exceptions.InvalidValue)
+
+if len(online) < 2:
+    print("SKIP cpu_set reservations")
+    sys.exit()
+
+# reserved thread is shown in its node and cache domain
+a = c.Run("test-cpu-layout", command="sleep 1000", cpu_set="threads 1")
+affinity = Cpus(a.GetProperty("cpu_set_affinity"))
+ExpectEq(len(affinity), 1)
+layout = Layout(a)
+ExpectEq(len(layout), 1)
+node, cache, cpus = layout[0]
+ExpectEq(cpus, affinity)
+ExpectEq(node, Node(min(affinity)))
+a.Destroy()
+
+# core is reserved whole, one thread is used
+a = c.Run("test-cpu-layout", command="sleep 1000", cpu_set="cores 1")
+affinity = Cpus(a.GetProperty("cpu_set_affinity"))
+ExpectEq(len(affinity), 1)
+ExpectEq(len(Layout(a)), 1)
+core = Siblings(min(affinity))
+
+if len(online) > len(core):
+    b = c.Run("test-cpu-layout-b", command="sleep 1000", cpu_set="threads 1")
+    Expect(not Cpus(b.GetProperty("cpu_set_affinity")) & core)
+    b.Destroy()
+a.Destroy()
@@ -0,0 +1,52 @@
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+cmd = "sleep 1000"
+
+def Total(name):
+    return (c.GetProperty(name, "cpu_guarantee_total"),
+            c.GetProperty(name, "cpu_limit_total"))
+
+a = c.Create("a")
+b1 = c.Create("a/b1")
+b2 = c.Create("a/b2")
+c1 = c.Create("a/b2/c1")
+
+for ct, guarantee, limit in [(b1, "0.5c", "1c"), (c1, "0.5c", "1c"), (b2, "0.25c", "1.5c")]:
+    ct.SetProperty("cpu_guarantee", guarantee)
+    ct.SetProperty("cpu_limit", limit)
+
+b1.SetProperty("command", cmd)
+c1.SetProperty("command", cmd)
+
+ExpectEq(Total("a"), ("", ""))
+
+b1.Start()
+ExpectEq(Total("a"), ("0.5c", "1c"))
+
+# meta child contributes its guarantee or sum of children, limit is capped
+c1.Start()
+ExpectEq(Total("a/b2"), ("0.5c", "1c"))
+ExpectEq(Total("a"), ("1c", "2c"))
+
+c.SetProperty("a/b2/c1", "cpu_guarantee", "0.75c")
+c.SetProperty("a/b2/c1", "cpu_limit", "0.8c")
+ExpectEq(Total("a/b2"), ("0.75c", "0.8c"))
+ExpectEq(Total("a"), ("1.25c", "1.8c"))
+
+# paused containers have no limit, stopped have nothing
+c1.Pause()
+ExpectEq(Total("a/b2")[1], "")
+ExpectEq(Total("a")[1], "1c")
+c1.Resume()
+ExpectEq(Total("a"), ("1.25c", "1.8c"))
+
+c1.Stop()
+ExpectEq(Total("a")[1], "1c")
+
+b1.Stop()
+ExpectEq(Total("a")[1], "")
+
+a.Destroy()
@@ -0,0 +1,72 @@
+#!/usr/bin/python -u
+
+import os
+import porto
+import tarfile
+from test_common import *
+
+c = porto.Connection()
+
+store = "/place/porto_blobs"
+prefix = "test-layer-dedup-"
+tarball = "/tmp/" + prefix + "layer.tar"
+export = "/tmp/" + prefix + "export.tar"
+
+def BlobCount():
+    if not os.path.exists(store):
+        return 0
+    return sum(len(os.listdir(os.path.join(store, d))) for d in os.listdir(store))
+
+def LayerFile(name, path):
+    return "/place/porto_layers/{}/{}".format(name, path)
+
+ConfigurePortod('test-layer-dedup', 'volumes { layer_dedup: true }')
+
+for path in [tarball, export]:
+    if os.path.exists(path):
+        os.unlink(path)
+
+v = c.CreateVolume()
+with open(v.path + "/shared", "w") as f:
+    f.write("shared content\n" * 1000)
+v.Export(tarball)
+v.Unlink()
+
+base = BlobCount()
+
+a = c.ImportLayer(prefix + "a", tarball)
+b = c.ImportLayer(prefix + "b", tarball)
+
+st_a = os.stat(LayerFile(a.name, "shared"))
+st_b = os.stat(LayerFile(b.name, "shared"))
+ExpectEq(st_a.st_ino, st_b.st_ino)
+ExpectEq(st_a.st_nlink, 3)
+ExpectEq(BlobCount(), base + 1)
+
+# store key is private to place, it must not leak into archives
+a.Export(export)
+with tarfile.open(export) as t:
+    for member in t.getmembers():
+        for key in member.pax_headers:
+            Expect("user.porto.blob" not in key)
+os.unlink(export)
+
+a.Remove()
+ExpectEq(os.stat(LayerFile(b.name, "shared")).st_nlink, 2)
+ExpectEq(BlobCount(), base + 1)
+
+b.Remove()
+ExpectEq(BlobCount(), base)
+
+# unreferenced entries are removed at start
+if not os.path.exists(store + "/00"):
+    os.mkdir(store + "/00")
+stray = store + "/00/" + "0" * 32 + "-0-0-644-0"
+open(stray, "w").close()
+ReloadPortod()
+c.ListLayers()
+Expect(not os.path.exists(stray))
+ExpectEq(BlobCount(), base)
+
+os.unlink(tarball)
+ConfigurePortod('test-layer-dedup', None)
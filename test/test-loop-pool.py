@@ -0,0 +1,70 @@
+#!/usr/bin/python -u
+
+import os
+import time
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+pool = "/place/porto_loop_pool"
+
+def Images():
+    if not os.path.exists(pool):
+        return {}
+    return {name: os.stat(os.path.join(pool, name)).st_ino
+            for name in os.listdir(pool) if not name.startswith("_tmp_")}
+
+def WaitImages(count, timeout=120):
+    deadline = time.time() + timeout
+    while len(Images()) != count:
+        Expect(time.time() < deadline)
+        time.sleep(0.5)
+    return Images()
+
+def LoopBlockSize(path):
+    name = os.path.basename(ParseMountinfo()[path]['source'])
+    return int(open("/sys/block/{}/queue/logical_block_size".format(name)).read())
+
+ConfigurePortod('test-loop-pool', 'volumes { loop_image_pool: "64M: 2" }')
+
+# pool is filled once loop volume is created in place
+v = c.CreateVolume(backend="loop", space_limit="64M")
+v.Unlink()
+images = WaitImages(2)
+for name in images:
+    ExpectEq(name.split("_")[0], str(64 << 20))
+
+# volume takes image, pool is refilled with new name
+v = c.CreateVolume(backend="loop", space_limit="64M")
+refilled = WaitImages(2)
+ExpectEq(len(set(images) & set(refilled)), 1)
+v.Unlink()
+
+# after restart ids continue, existing images are not replaced
+ReloadPortod()
+v = c.CreateVolume(backend="loop", space_limit="64M")
+after = WaitImages(2)
+kept = set(refilled) & set(after)
+ExpectEq(len(kept), 1)
+for name in kept:
+    ExpectEq(after[name], refilled[name])
+v.Unlink()
+
+# block size is applied whatever ioctl configures device
+ConfigurePortod('test-loop-pool', 'volumes { loop_block_size: 4096 }')
+v = c.CreateVolume(backend="loop", space_limit="64M")
+ExpectEq(LoopBlockSize(v.path), 4096)
+v.Unlink()
+
+# invalid block size is an error, not a silent fallback
+ConfigurePortod('test-loop-pool', 'volumes { loop_block_size: 1000 }')
+ExpectEq(Catch(c.CreateVolume, backend="loop", space_limit="64M"), porto.exceptions.InvalidValue)
+
+# and it does not disable LOOP_CONFIGURE for valid configuration
+ConfigurePortod('test-loop-pool', 'volumes { loop_block_size: 512 }')
+v = c.CreateVolume(backend="loop", space_limit="64M")
+ExpectEq(LoopBlockSize(v.path), 512)
+v.Unlink()
+
+ConfigurePortod('test-loop-pool', None)
@@ -0,0 +1,104 @@
+#!/usr/bin/python -u
+
+import os
+import shutil
+import subprocess
+import threading
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+lower = "/place/porto_lower"
+prefix = "test-lower-stack-"
+tarball = "/tmp/" + prefix + "layer.tar"
+image_src = "/tmp/" + prefix + "image"
+image = "/tmp/" + prefix + "image.squash"
+
+def Stacks():
+    if not os.path.exists(lower):
+        return set()
+    return set(os.listdir(lower))
+
+def MakeImage(content):
+    if os.path.exists(image_src):
+        shutil.rmtree(image_src)
+    os.mkdir(image_src)
+    with open(image_src + "/file", "w") as f:
+        f.write(content)
+    # rewrite image in place, inode is kept
+    subprocess.check_call(["mksquashfs", image_src, image, "-noappend", "-quiet"])
+
+for path in [tarball, image]:
+    if os.path.exists(path):
+        os.unlink(path)
+
+v = c.CreateVolume()
+with open(v.path + "/file", "w") as f:
+    f.write("layer\n")
+v.Export(tarball)
+v.Unlink()
+
+layer = c.ImportLayer(prefix + "layer", tarball)
+
+base = Stacks()
+
+# volumes with the same layers share one stack
+a = c.CreateVolume(backend="overlay", layers=[layer.name])
+b = c.CreateVolume(backend="overlay", layers=[layer.name])
+stacks = Stacks() - base
+ExpectEq(len(stacks), 1)
+ExpectEq(open(b.path + "/file").read(), "layer\n")
+
+# stack outlives first user and survives restart
+a.Unlink()
+ExpectEq(Stacks() - base, stacks)
+ReloadPortod()
+ExpectEq(Stacks() - base, stacks)
+b.Unlink()
+ExpectEq(Stacks(), base)
+
+# concurrent builds of one stack wait for each other
+volumes = []
+errors = []
+
+def Create():
+    try:
+        conn = porto.Connection()
+        volumes.append(conn.CreateVolume(backend="overlay", layers=[layer.name]))
+    except Exception as e:
+        errors.append(e)
+
+threads = [threading.Thread(target=Create) for i in range(8)]
+for t in threads:
+    t.start()
+for t in threads:
+    t.join()
+
+ExpectEq(errors, [])
+ExpectEq(len(volumes), 8)
+ExpectEq(len(Stacks() - base), 1)
+for v in volumes:
+    ExpectEq(open(v.path + "/file").read(), "layer\n")
+    c.UnlinkVolume(v.path)
+ExpectEq(Stacks(), base)
+
+# squash image rewritten in place is not served from old stack
+if any(os.access(os.path.join(d, "mksquashfs"), os.X_OK) for d in os.environ["PATH"].split(":")):
+    MakeImage("old\n")
+    old = c.CreateVolume(backend="squash", layers=[image])
+    ExpectEq(open(old.path + "/file").read(), "old\n")
+
+    MakeImage("new\n")
+    new = c.CreateVolume(backend="squash", layers=[image])
+    ExpectEq(open(new.path + "/file").read(), "new\n")
+    ExpectEq(len(Stacks() - base), 2)
+
+    old.Unlink()
+    new.Unlink()
+    ExpectEq(Stacks(), base)
+    os.unlink(image)
+    shutil.rmtree(image_src)
+
+layer.Remove()
+os.unlink(tarball)
@@ -75,3 +75,15 @@ d["/"] = "233832448"
 verify(d)
 
 c.Destroy("a")
+
+# sum of children limits over 64 bits means unlimited
+huge = str(1 << 63)
+c.Create("o")
+for i in range(3):
+    ct = c.Create("o/c{}".format(i))
+    ct.SetProperty("memory_limit", huge)
+    ct.SetProperty("command", cmd)
+    ct.Start()
+    ExpectProp(ct, "memory_limit_total", huge)
+ExpectProp(c.Find("o"), "memory_limit_total", "")
+c.Destroy("o")
@@ -0,0 +1,67 @@
+#!/usr/bin/python -u
+
+import re
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+def Policy(pid):
+    return open("/proc/{}/numa_maps".format(pid)).readline().split()[1]
+
+node = int(re.split("[-,]", open("/sys/devices/system/node/has_memory").read().strip())[0])
+root_mems = open("/sys/fs/cgroup/cpuset/cpuset.mems").read().strip()
+
+a = c.Create("test-numa")
+
+# property round-trips
+ExpectProp(a, "memory_nodes", "")
+ExpectProp(a, "numa_policy", "default")
+
+a.SetProperty("memory_nodes", "node {}".format(node))
+ExpectProp(a, "memory_nodes", str(node))
+a.SetProperty("memory_nodes", "")
+ExpectProp(a, "memory_nodes", "")
+ExpectEq(Catch(a.SetProperty, "memory_nodes", "x"), porto.exceptions.InvalidValue)
+
+for policy in ["bind", "preferred", "interleave", "default"]:
+    a.SetProperty("numa_policy", policy)
+    ExpectProp(a, "numa_policy", policy)
+ExpectEq(Catch(a.SetProperty, "numa_policy", "local"), porto.exceptions.InvalidValue)
+
+a.Destroy()
+
+def Check():
+    # without memory_nodes cpuset.mems is inherited as is
+    a = c.Run("test-numa", command="sleep 1000")
+    pid = a.GetProperty("root_pid")
+    ExpectEq(ProcStatus(pid, "Mems_allowed_list"), root_mems)
+    ExpectEq(Policy(pid), "default")
+    a.Destroy()
+
+    for policy, mems, text in [
+            ("default", str(node), "default"),
+            ("bind", str(node), "bind:{}".format(node)),
+            ("preferred", root_mems, "prefer:{}".format(node)),
+            ("interleave", root_mems, "interleave:{}".format(node))]:
+        a = c.Run("test-numa", command="sleep 1000",
+                  memory_nodes=str(node), numa_policy=policy)
+        pid = a.GetProperty("root_pid")
+        ExpectEq(ProcStatus(pid, "Mems_allowed_list"), mems)
+        ExpectEq(Policy(pid), text)
+
+        usage = a.GetProperty("numa_usage")
+        Expect(str(node) + ":" in usage)
+        int(a.GetProperty("numa_usage[{}]".format(node)))
+        ExpectEq(Catch(a.GetProperty, "numa_usage[x]"), porto.exceptions.InvalidValue)
+
+        # child without memory_nodes stays in parent nodes
+        b = c.Run("test-numa/b", command="sleep 1000")
+        ExpectEq(ProcStatus(b.GetProperty("root_pid"), "Mems_allowed_list"), mems)
+        a.Destroy()
+
+Check()
+
+ConfigurePortod('test-numa', 'container { task_spawner: true }')
+Check()
+ConfigurePortod('test-numa', None)
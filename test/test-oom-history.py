@@ -0,0 +1,62 @@
+#!/usr/bin/python -u
+
+import porto
+from test_common import *
+
+c = porto.Connection(timeout=30)
+
+NAME = "test-oom-history"
+LIMIT = 64 << 20
+OOM = "dd if=/dev/zero of=/dev/null bs=256M count=1"
+
+def History(ct):
+    value = ct.GetProperty("oom_history")
+    return [rec.strip() for rec in value.split(";") if rec.strip()]
+
+def Record(rec):
+    return dict(word.split("=", 1) for word in rec.split() if "=" in word)
+
+a = c.Create(NAME)
+a.SetProperty("memory_limit", str(LIMIT))
+ExpectEq(History(a), [])
+ExpectEq(Catch(a.SetProperty, "oom_history", ""), porto.exceptions.InvalidValue)
+
+# fatal oom kills container and leaves one record
+a.SetProperty("command", OOM)
+a.Start()
+a.Wait()
+ExpectProp(a, "state", "dead")
+ExpectProp(a, "oom_killed", "true")
+
+history = History(a)
+ExpectEq(len(history), 1)
+rec = Record(history[0])
+ExpectEq(int(rec["limit"]), LIMIT)
+ExpectLe(int(rec["usage"]), LIMIT)
+if rec["pid"] != "0":
+    ExpectEq(rec["comm"], "dd")
+
+ExpectPropGe(a, "memory_events[oom]", 1)
+events = a.GetProperty("memory_events")
+Expect("oom:" in events)
+ExpectEq(Catch(a.GetProperty, "memory_events[x]"), porto.exceptions.InvalidValue)
+
+a.Destroy()
+
+# history is bounded by oom_history_size
+ConfigurePortod(NAME, 'container { oom_history_size: 2 }')
+
+a = c.Create(NAME)
+a.SetProperty("memory_limit", str(LIMIT))
+a.SetProperty("oom_is_fatal", "false")
+a.SetProperty("command", "bash -c 'for i in 1 2 3; do {}; sleep 1; done'".format(OOM))
+a.Start()
+a.Wait()
+ExpectProp(a, "state", "dead")
+
+ExpectEq(len(History(a)), 2)
+ExpectPropGe(a, "memory_events[oom]", 3)
+
+a.Destroy()
+
+ConfigurePortod(NAME, None)
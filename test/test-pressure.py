@@ -0,0 +1,67 @@
+#!/usr/bin/python -u
+
+import sys
+import time
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+if "cpu_pressure" not in c.Plist():
+    print("SKIP cpu_pressure")
+    sys.exit()
+
+def ExpectPressure(value):
+    for line, kind in zip(value.split(";"), ["some", "full"]):
+        words = line.split()
+        ExpectEq(words[0], kind)
+        ExpectEq([w.split("=")[0] for w in words[1:]], ["avg10", "avg60", "avg300", "total"])
+
+# root shows system-wide values
+for resource in ["cpu", "memory", "io"]:
+    ExpectPressure(c.GetProperty("/", resource + "_pressure"))
+Expect(c.GetProperty("/", "memory_pressure[full]").startswith("avg10="))
+
+a = c.Create("test-pressure")
+
+# trigger round-trip, values are shown in microseconds
+ExpectProp(a, "pressure_trigger", "")
+a.SetProperty("pressure_trigger", "cpu some 50ms 1s; memory full 100ms 2s")
+ExpectProp(a, "pressure_trigger", "cpu some 50000us 1000000us; memory full 100000us 2000000us")
+a.SetProperty("pressure_trigger", a.GetProperty("pressure_trigger"))
+ExpectProp(a, "pressure_trigger", "cpu some 50000us 1000000us; memory full 100000us 2000000us")
+
+for value in ["disk some 50ms 1s", "cpu any 50ms 1s", "cpu some 2s 1s",
+              "cpu some 0 1s", "cpu some 50ms", "cpu some x 1s"]:
+    ExpectEq(Catch(a.SetProperty, "pressure_trigger", value), porto.exceptions.InvalidValue)
+
+a.SetProperty("pressure_trigger", "")
+ExpectProp(a, "pressure_trigger", "")
+
+# stall on one cpu is reported to async wait
+events = []
+def wait_event(name, state, when):
+    if state.endswith("_pressure"):
+        events.append((name, state))
+
+c.AsyncWait(["test-pressure"], wait_event)
+
+a.SetProperty("command", "bash -c 'while :; do :; done & while :; do :; done'")
+a.SetProperty("cpu_set", "0")
+a.SetProperty("pressure_trigger", "cpu some 50ms 500ms")
+a.Start()
+
+ExpectPressure(a.GetProperty("cpu_pressure"))
+
+deadline = time.time() + 30
+while not events:
+    Expect(time.time() < deadline)
+    time.sleep(0.5)
+    # async events are delivered along with responses
+    c.GetProperty("test-pressure", "state")
+
+ExpectEq(events[0], ("test-pressure", "cpu_pressure"))
+
+# trigger changes apply to running container
+a.SetProperty("pressure_trigger", "")
+a.Destroy()
@@ -0,0 +1,68 @@
+#!/usr/bin/python -u
+
+import os
+import time
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+NAME = "test-reclaim"
+
+def ReclaimThreads():
+    pid = GetPortodPid()
+    return [tid for tid in os.listdir("/proc/{}/task".format(pid))
+            if open("/proc/{}/task/{}/comm".format(pid, tid)).read().strip() == "portod-reclaim"]
+
+ExpectEq(ReclaimThreads(), [])
+Expect("proactive_reclaim" not in c.Plist())
+
+v = c.CreateVolume()
+
+# working set is sampled on demand without reclaimer
+a = c.Run(NAME, command="bash -c 'dd if=/dev/zero of=data bs=1M count=64 && sleep 1000'",
+          cwd=v.path)
+deadline = time.time() + 30
+while os.path.getsize(v.path + "/data") < (64 << 20):
+    Expect(time.time() < deadline)
+    time.sleep(0.1)
+ExpectLe(1, int(a.GetProperty("working_set")))
+a.Destroy()
+
+ConfigurePortod(NAME, 'container { memory_reclaim_ms: 100 }')
+ExpectEq(len(ReclaimThreads()), 1)
+
+a = c.Create(NAME)
+ExpectProp(a, "proactive_reclaim", "0")
+a.SetProperty("proactive_reclaim", "50%")
+ExpectProp(a, "proactive_reclaim", "50")
+a.SetProperty("proactive_reclaim", "100")
+ExpectProp(a, "proactive_reclaim", "100")
+for value in ["101", "-1", "x"]:
+    ExpectEq(Catch(a.SetProperty, "proactive_reclaim", value), porto.exceptions.InvalidValue)
+ExpectEq(Catch(a.SetProperty, "working_set", "1"), porto.exceptions.InvalidValue)
+
+# cold page cache above working set is reclaimed
+a.SetProperty("command", "bash -c 'dd if=/dev/zero of=data bs=1M count=64 && sleep 1000'")
+a.SetProperty("cwd", v.path)
+a.Start()
+
+deadline = time.time() + 30
+while os.path.getsize(v.path + "/data") < (64 << 20):
+    Expect(time.time() < deadline)
+    time.sleep(0.1)
+
+ws = int(a.GetProperty("working_set"))
+ExpectLe(1, ws)
+
+if os.path.exists("/sys/fs/cgroup/memory/memory.reclaim"):
+    deadline = time.time() + 30
+    while int(a.GetProperty("memory_usage")) > ws + (32 << 20):
+        Expect(time.time() < deadline)
+        time.sleep(0.5)
+
+a.Destroy()
+v.Unlink()
+
+ConfigurePortod(NAME, None)
+ExpectEq(ReclaimThreads(), [])
@@ -0,0 +1,74 @@
+#!/usr/bin/python -u
+
+import os
+import re
+import stat
+import subprocess
+import porto
+from test_common import *
+
+NAME = "test-request-journal"
+JOURNAL = "/tmp/" + NAME
+SIZE = 64 << 10
+
+def Replay(*paths):
+    out = subprocess.check_output([portoctl, "replay", "-s", "0"] + list(paths))
+    m = re.search(r"requests (\d+) clients (\d+) skipped (\d+) failed (\d+) differ (\d+)", out.decode())
+    Expect(m is not None)
+    return dict(zip(["requests", "clients", "skipped", "failed", "differ"],
+                    [int(x) for x in m.groups()]))
+
+def Mode(path):
+    return stat.S_IMODE(os.stat(path).st_mode)
+
+for path in [JOURNAL, JOURNAL + ".old", JOURNAL + ".bad"]:
+    if os.path.exists(path):
+        os.unlink(path)
+
+ConfigurePortod(NAME, 'daemon {{ request_journal: "{}" request_journal_size: {} }}'.format(JOURNAL, SIZE))
+
+c = porto.Connection()
+c.AsyncWait([NAME], lambda name, state, when: None)
+
+a = c.Create(NAME)
+a.SetProperty("command", "true")
+a.Start()
+a.Wait()
+ExpectEq(Catch(c.Create, NAME), porto.exceptions.ContainerAlreadyExists)
+a.Destroy()
+c.disconnect()
+
+# journal could hold secrets from environment
+ExpectEq(Mode(JOURNAL), 0o600)
+Expect(os.path.getsize(JOURNAL) > 0)
+
+# replay against the same state gives the same results
+res = Replay(JOURNAL)
+ExpectLe(6, res["requests"])
+ExpectLe(1, res["skipped"])
+ExpectLe(1, res["failed"])
+ExpectEq(res["differ"], 0)
+
+# rotated into .old when grows over limit
+c = porto.Connection()
+while not os.path.exists(JOURNAL + ".old"):
+    c.GetProperty("/", "state")
+ExpectEq(Mode(JOURNAL + ".old"), 0o600)
+ExpectLe(os.path.getsize(JOURNAL), SIZE + 4096)
+Replay(JOURNAL + ".old", JOURNAL)
+
+# truncated journal is rejected
+with open(JOURNAL + ".bad", "wb") as f:
+    f.write(open(JOURNAL, "rb").read()[:-1])
+Expect(subprocess.call([portoctl, "replay", "-s", "0", JOURNAL + ".bad"]) != 0)
+
+ConfigurePortod(NAME, None)
+
+# without config nothing is written
+size = os.path.getsize(JOURNAL)
+c = porto.Connection()
+c.GetProperty("/", "state")
+ExpectEq(os.path.getsize(JOURNAL), size)
+
+for path in [JOURNAL, JOURNAL + ".old", JOURNAL + ".bad"]:
+    os.unlink(path)
@@ -0,0 +1,85 @@
+#!/usr/bin/python -u
+
+import os
+import time
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+def SpawnerPids():
+    pids = []
+    for pid in os.listdir("/proc"):
+        if not pid.isdigit():
+            continue
+        try:
+            with open("/proc/{}/comm".format(pid)) as f:
+                if f.read().strip() == "portod-spawner":
+                    pids.append(int(pid))
+        except IOError:
+            pass
+    return pids
+
+def TestStart():
+    a = c.Run("test-spawner", command="echo out; echo err >&2")
+    a.Wait()
+    ExpectProp(a, "exit_code", "0")
+    ExpectEq(a.GetProperty("stdout"), "out\n")
+    ExpectEq(a.GetProperty("stderr"), "err\n")
+    a.Destroy()
+
+    a = c.Run("test-spawner", command="cat", stdin_path="/proc/self/cgroup")
+    a.Wait()
+    ExpectProp(a, "exit_code", "0")
+    a.Destroy()
+
+    a = c.Run("test-spawner", command="sysctl -n kernel.msgmax", isolate=True,
+              sysctl="kernel.msgmax: 12345")
+    a.Wait()
+    ExpectEq(a.GetProperty("stdout"), "12345\n")
+    a.Destroy()
+
+    a = c.Create("test-spawner")
+    a.SetProperty("command", "true")
+    a.SetProperty("isolate", False)
+    a.SetProperty("sysctl", "kernel.msgmax: 12345")
+    ExpectEq(Catch(a.Start), porto.exceptions.PermissionError)
+    a.SetProperty("sysctl", "vm.swappiness: 0")
+    ExpectEq(Catch(a.Start), porto.exceptions.PermissionError)
+    a.Destroy()
+
+    a = c.Run("test-spawner", command="sleep 1000", isolate=True)
+    b = c.Run("test-spawner/b", command="pwd", cwd="/tmp")
+    b.Wait()
+    ExpectEq(b.GetProperty("stdout"), "/tmp\n")
+    a.Destroy()
+
+ConfigurePortod('test-spawner', None)
+ExpectEq(SpawnerPids(), [])
+TestStart()
+
+ConfigurePortod('test-spawner', 'container { task_spawner: true }')
+ExpectEq(len(SpawnerPids()), 1)
+TestStart()
+
+# helpers are forked by spawner too
+v = c.CreateVolume(backend="native", space_limit="1M")
+with open(v.path + "/file", "w") as f:
+    f.write("data")
+tarball = "/tmp/test-spawner.tgz"
+if os.path.exists(tarball):
+    os.unlink(tarball)
+v.Export(tarball)
+v.Unlink()
+l = c.ImportLayer("test-spawner", tarball)
+l.Remove()
+os.unlink(tarball)
+
+# tasks are forked from portod when spawner is gone
+for pid in SpawnerPids():
+    os.kill(pid, 9)
+time.sleep(1)
+TestStart()
+
+ConfigurePortod('test-spawner', None)
+ExpectEq(SpawnerPids(), [])
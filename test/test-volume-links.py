@@ -0,0 +1,67 @@
+#!/usr/bin/python -u
+
+import os
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+NAME = "test-volume-links"
+
+def Paths(container=None):
+    return set(v.path for v in c.ListVolumes(container=container))
+
+base = "/tmp/" + NAME
+sibling = base + "-sibling"
+for path in [base, sibling]:
+    if not os.path.exists(path):
+        os.mkdir(path)
+
+# path sharing string prefix with container root is not inside it
+root = c.CreateVolume(base)
+other = c.CreateVolume(sibling)
+os.mkdir(root.path + "/a")
+os.mkdir(root.path + "/c")
+
+ct = c.Create(NAME)
+ct.SetProperty("root", root.path)
+ct.Start()
+ExpectEq(Paths(NAME), set(["/"]))
+
+a = c.CreateVolume()
+os.mkdir(a.path + "/b")
+b = c.CreateVolume()
+d = c.CreateVolume()
+
+a.Link(NAME, target="/a")
+b.Link(NAME, target="/a/b")
+d.Link(NAME, target="/c")
+
+# nested links are listed relative to container root
+ExpectEq(Paths(NAME), set(["/", "/a", "/a/b", "/c"]))
+Expect(set([base, sibling, a.path, base + "/a", base + "/a/b", base + "/c"]) <= Paths())
+
+# lookup by path finds exact link only
+ExpectEq(Catch(c.FindVolume, base + "/a/b"), None)
+ExpectEq(Catch(c.FindVolume, base + "/a/b/x"), porto.exceptions.VolumeNotFound)
+ExpectEq(Catch(c.FindVolume, base + "/b"), porto.exceptions.VolumeNotFound)
+
+# unlinking nested link keeps outer one
+c.UnlinkVolume(b.path, NAME, target="/a/b")
+ExpectEq(Paths(NAME), set(["/", "/a", "/c"]))
+
+# link could be added again at the same place
+b.Link(NAME, target="/a/b")
+ExpectEq(Paths(NAME), set(["/", "/a", "/a/b", "/c"]))
+
+for v in [b, a, d]:
+    v.Unlink(NAME)
+ExpectEq(Paths(NAME), set(["/"]))
+
+ct.Destroy()
+for v in [a, b, d, root, other]:
+    v.Unlink()
+ExpectEq(Paths() & set([base, sibling]), set())
+
+os.rmdir(base)
+os.rmdir(sibling)
@@ -0,0 +1,82 @@
+#!/usr/bin/python -u
+
+import os
+import time
+import fcntl
+import struct
+import threading
+import porto
+from test_common import *
+
+c = porto.Connection(timeout=600)
+
+def Populate(path, dirs, files):
+    for d in range(dirs):
+        sub = os.path.join(path, *["d{}".format(i) for i in range(d % 10 + 1)]) + "_{}".format(d)
+        os.makedirs(sub)
+        for f in range(files):
+            open(os.path.join(sub, str(f)), "w").close()
+
+def ProjectId(path):
+    fd = os.open(path, os.O_RDONLY | os.O_NOFOLLOW)
+    try:
+        # struct fsxattr from FS_IOC_FSGETXATTR
+        arr = bytearray(28)
+        fcntl.ioctl(fd, 0x801c581f, arr)
+        return struct.unpack("IIII12x", bytes(arr))[3]
+    finally:
+        os.close(fd)
+
+ConfigurePortod('test-volume-quota-tree', 'volumes { tree_threads: 4 }')
+
+# quota on pre-populated tree moves everything into project
+base = c.CreateVolume(backend="plain")
+tree = base.path + "/tree"
+os.mkdir(tree)
+Populate(tree, 100, 100)
+with open(os.path.join(tree, "d0_0", "data"), "wb") as f:
+    f.write(b"x" * (4 << 20))
+
+v = c.CreateVolume(tree, backend="quota", space_limit="1G")
+projid = ProjectId(tree)
+Expect(projid != 0)
+ExpectEq(ProjectId(os.path.join(tree, "d0_0", "data")), projid)
+ExpectEq(ProjectId(os.path.join(tree, "d0", "d1", "d2", "d3", "d4", "d5", "d6", "d7", "d8", "d9_99", "99")), projid)
+ExpectLe(4 << 20, int(v.GetProperty("space_used")))
+ExpectLe(100 * 100, int(v.GetProperty("inode_used")))
+v.Unlink()
+ExpectEq(ProjectId(os.path.join(tree, "d0_0", "data")), 0)
+
+# destroying parent aborts build of dependent quota volume
+Populate(os.path.join(tree, "more"), 1000, 200)
+result = []
+
+def Build():
+    try:
+        conn = porto.Connection(timeout=600)
+        conn.CreateVolume(tree, backend="quota", space_limit="1G")
+        result.append(None)
+    except porto.exceptions.PortoException as e:
+        result.append(e)
+
+thread = threading.Thread(target=Build)
+thread.start()
+
+progress = 0
+deadline = time.time() + 60
+while not progress and thread.is_alive():
+    Expect(time.time() < deadline)
+    try:
+        progress = int(c.FindVolume(tree).GetProperty("build_progress"))
+    except (porto.exceptions.VolumeNotFound, porto.exceptions.InvalidProperty, KeyError, ValueError):
+        time.sleep(0.01)
+
+base.Unlink()
+thread.join()
+
+ExpectEq(len(result), 1)
+if progress:
+    Expect(result[0] is not None)
+ExpectEq(Catch(c.FindVolume, tree), porto.exceptions.VolumeNotFound)
+
+ConfigurePortod('test-volume-quota-tree', None)
@@ -0,0 +1,44 @@
+#!/usr/bin/python -u
+
+import os
+import time
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+def StatThreads():
+    pid = GetPortodPid()
+    return [tid for tid in os.listdir("/proc/{}/task".format(pid))
+            if open("/proc/{}/task/{}/comm".format(pid, tid)).read().strip() == "portod-stat"]
+
+def WaitProp(v, prop, check, timeout=10):
+    deadline = time.time() + timeout
+    while not check(int(v.GetProperty(prop))):
+        Expect(time.time() < deadline)
+        time.sleep(0.1)
+
+ExpectEq(StatThreads(), [])
+
+# collector follows config on reload
+ConfigurePortod('test-volume-stat', 'volumes { stat_cache_ms: 500 }')
+ExpectEq(len(StatThreads()), 1)
+
+v = c.CreateVolume(space_limit="64M")
+used = int(v.GetProperty("space_used"))
+
+with open(v.path + "/data", "wb") as f:
+    f.write(b"x" * (8 << 20))
+    os.fsync(f.fileno())
+
+# cached usage is refreshed by collector
+WaitProp(v, "space_used", lambda x: x >= used + (8 << 20))
+
+# resize drops cache at once
+v.SetProperty("space_limit", "128M")
+ExpectLe(64 << 20, int(v.GetProperty("space_available")))
+
+v.Unlink()
+
+ConfigurePortod('test-volume-stat', None)
+ExpectEq(StatThreads(), [])
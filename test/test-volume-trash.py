@@ -0,0 +1,56 @@
+#!/usr/bin/python -u
+
+import os
+import time
+import porto
+from test_common import *
+
+c = porto.Connection()
+
+trash = "/place/porto_trash"
+
+def Stat(name):
+    return int(c.GetProperty("/", "porto_stat[{}]".format(name)))
+
+def WaitTrash(value, timeout=60):
+    deadline = time.time() + timeout
+    while Stat("volume_trash") != value:
+        Expect(time.time() < deadline)
+        time.sleep(0.1)
+
+ConfigurePortod('test-volume-trash', 'volumes { async_destroy: true trash_rate: 200 }')
+
+WaitTrash(0)
+reclaimed = Stat("volume_trash_reclaimed")
+
+v = c.CreateVolume(backend="native")
+path = v.path
+for i in range(400):
+    open("{}/{}".format(path, i), "w").close()
+v.Unlink()
+
+# data is moved into trash and reclaimed at limited rate in background
+Expect(not os.path.exists(path))
+ExpectEq(Stat("volume_trash"), 1)
+ExpectEq(len(os.listdir(trash)), 1)
+
+WaitTrash(0)
+ExpectEq(os.listdir(trash), [])
+ExpectEq(Stat("volume_trash_reclaimed"), reclaimed + 1)
+ExpectLe(400, Stat("volume_trash_entries"))
+
+# rate is taken from config at each trash entry
+ConfigurePortod('test-volume-trash', 'volumes { async_destroy: true trash_rate: 1 }')
+v = c.CreateVolume(backend="native")
+for i in range(100):
+    open("{}/{}".format(v.path, i), "w").close()
+v.Unlink()
+time.sleep(2)
+ExpectEq(Stat("volume_trash"), 1)
+
+# leftovers are counted and reclaimed after restart
+ConfigurePortod('test-volume-trash', 'volumes { async_destroy: true }')
+WaitTrash(0)
+ExpectEq(os.listdir(trash), [])
+
+ConfigurePortod('test-volume-trash', None)
@@ -151,6 +151,17 @@ def ReloadPortod():
     except OSError:
         pass
 
+def ConfigurePortod(name, text):
+    path = "/etc/portod.conf.d/{}.conf".format(name)
+    if text:
+        if not os.path.exists("/etc/portod.conf.d"):
+            os.mkdir("/etc/portod.conf.d")
+        with open(path, "w") as f:
+            f.write(text)
+    elif os.path.exists(path):
+        os.unlink(path)
+    ReloadPortod()
+
 def ProcStatus(pid, key):
     for line in open("/proc/{}/status".format(pid)).readlines():
         k, v = line.split(None, 1)